@@ -0,0 +1,149 @@
+#include <benchmark/benchmark.h>
+#include <pedrolib/buffer/array_buffer.h>
+#include <pedrolib/buffer/record_reader.h>
+#include <pedrolib/buffer/ring_buffer.h>
+#include <pedrolib/buffer/search.h>
+#include <sys/mman.h>
+#include <string>
+
+using pedrolib::ArrayBuffer;
+using pedrolib::File;
+using pedrolib::RecordReader;
+using pedrolib::RingBuffer;
+using pedrolib::SearchIsa;
+
+namespace {
+
+// Appends and retrieves range(0) bytes at a time through one buffer.
+void BM_AppendRetrieve(benchmark::State& state) {
+  const auto n = static_cast<size_t>(state.range(0));
+  std::string in(n, 'x');
+  std::string out(n, '\0');
+  ArrayBuffer buffer;
+  for (auto _ : state) {
+    buffer.Append(in.data(), n);
+    benchmark::DoNotOptimize(buffer.Retrieve(out.data(), n));
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * n));
+}
+
+// Fills a buffer with 64 appends of range(0) bytes, then drains it.
+void BM_AppendBurst(benchmark::State& state) {
+  const auto n = static_cast<size_t>(state.range(0));
+  std::string in(n, 'x');
+  std::string out(64 * n, '\0');
+  ArrayBuffer buffer;
+  for (auto _ : state) {
+    for (int i = 0; i < 64; ++i) {
+      buffer.Append(in.data(), n);
+    }
+    benchmark::DoNotOptimize(buffer.Retrieve(out.data(), out.size()));
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * 64 * n));
+}
+
+// Moves range(0) bytes from one buffer into another.
+void BM_BufferToBuffer(benchmark::State& state) {
+  const auto n = static_cast<size_t>(state.range(0));
+  std::string in(n, 'x');
+  ArrayBuffer source;
+  ArrayBuffer target;
+  for (auto _ : state) {
+    source.Append(in.data(), n);
+    source.Retrieve(&target);
+    target.Reset();
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * n));
+}
+
+// Streams range(0)-byte chunks through a 64 KiB buffer that always holds a
+// 32 KiB backlog, as a connection buffer does under steady load. The
+// ArrayBuffer compacts the backlog each time it reaches the end.
+template <typename Buffer>
+void BM_Streaming(benchmark::State& state) {
+  const auto n = static_cast<size_t>(state.range(0));
+  std::string in(n, 'x');
+  std::string out(n, '\0');
+  std::string backlog(32 << 10, 'y');
+  Buffer buffer(64 << 10);
+  buffer.Append(backlog.data(), backlog.size());
+  for (auto _ : state) {
+    buffer.Append(in.data(), n);
+    benchmark::DoNotOptimize(buffer.Retrieve(out.data(), n));
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * n));
+}
+
+constexpr size_t kScanBytes = 1 << 20;
+
+// Scans 1 MiB without a match with the kernel set range(0) (0 = scalar,
+// 1 = SSE2, 2 = AVX2).
+void BM_FindByte(benchmark::State& state) {
+  if (!pedrolib::SetSearchIsa(static_cast<SearchIsa>(state.range(0)))) {
+    state.SkipWithError("unsupported");
+    return;
+  }
+  std::string data(kScanBytes, 'x');
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(
+        pedrolib::FindByte(data.data(), data.data() + data.size(), '\n'));
+  }
+  state.SetBytesProcessed(
+      static_cast<int64_t>(state.iterations() * kScanBytes));
+}
+
+void BM_FindPair(benchmark::State& state) {
+  if (!pedrolib::SetSearchIsa(static_cast<SearchIsa>(state.range(0)))) {
+    state.SkipWithError("unsupported");
+    return;
+  }
+  // Lone '\r's keep the first-byte matches frequent.
+  std::string data(kScanBytes, 'x');
+  for (size_t i = 0; i < data.size(); i += 64) {
+    data[i] = '\r';
+  }
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(pedrolib::FindPair(
+        data.data(), data.data() + data.size(), '\r', '\n'));
+  }
+  state.SetBytesProcessed(
+      static_cast<int64_t>(state.iterations() * kScanBytes));
+}
+
+// Splits 16 MiB of range(0)-byte lines held in a memfd.
+void BM_RecordReader(benchmark::State& state) {
+  const auto n = static_cast<size_t>(state.range(0));
+  std::string line(n - 1, 'x');
+  line.push_back('\n');
+  File file(::memfd_create("bench", 0));
+  size_t total = 0;
+  while (total < (16 << 20)) {
+    file.Write(line.data(), line.size());
+    total += line.size();
+  }
+  pedrolib::SetSearchIsa(SearchIsa::kAvx2);
+  for (auto _ : state) {
+    file.Seek(0, File::Whence::kSeekSet);
+    RecordReader reader(&file);
+    size_t records = 0;
+    while (reader.Next()) {
+      records++;
+    }
+    benchmark::DoNotOptimize(records);
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * total));
+}
+
+}  // namespace
+
+BENCHMARK(BM_AppendRetrieve)->RangeMultiplier(4)->Range(16, 64 << 10);
+BENCHMARK(BM_AppendBurst)->RangeMultiplier(4)->Range(16, 4 << 10);
+BENCHMARK(BM_BufferToBuffer)->RangeMultiplier(4)->Range(16, 64 << 10);
+BENCHMARK_TEMPLATE(BM_Streaming, ArrayBuffer)->Arg(64)->Arg(1024)->Arg(8192);
+BENCHMARK_TEMPLATE(BM_Streaming, RingBuffer)->Arg(64)->Arg(1024)->Arg(8192);
+
+BENCHMARK(BM_FindByte)->DenseRange(0, 2)->ArgName("isa");
+BENCHMARK(BM_FindPair)->DenseRange(0, 2)->ArgName("isa");
+BENCHMARK(BM_RecordReader)->Arg(64)->Arg(1024)->ArgName("line");
+
+BENCHMARK_MAIN();
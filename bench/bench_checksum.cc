@@ -0,0 +1,68 @@
+#include <benchmark/benchmark.h>
+#include <pedrolib/checksum/crc32c.h>
+#include <pedrolib/checksum/xxhash.h>
+#include <pedrolib/executor/thread_pool_executor.h>
+#include <string>
+
+using pedrolib::ThreadPoolExecutor;
+
+namespace {
+
+void BM_Crc32c(benchmark::State& state) {
+  std::string data(static_cast<size_t>(state.range(0)), 'x');
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(pedrolib::Crc32c(data.data(), data.size()));
+  }
+  state.SetBytesProcessed(
+      static_cast<int64_t>(state.iterations() * data.size()));
+}
+
+// Chunks hashed on a pool and merged with Crc32cCombine.
+void BM_Crc32cParallel(benchmark::State& state) {
+  std::string data(static_cast<size_t>(state.range(0)), 'x');
+  ThreadPoolExecutor executor;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(
+        pedrolib::Crc32c(&executor, data.data(), data.size()));
+  }
+  state.SetBytesProcessed(
+      static_cast<int64_t>(state.iterations() * data.size()));
+  executor.Close();
+  executor.Join();
+}
+
+void BM_Crc32cCombine(benchmark::State& state) {
+  uint32_t crc = 1;
+  for (auto _ : state) {
+    crc = pedrolib::Crc32cCombine(crc, 0x12345678, 1 << 20);
+    benchmark::DoNotOptimize(crc);
+  }
+}
+
+void BM_Xxh64(benchmark::State& state) {
+  std::string data(static_cast<size_t>(state.range(0)), 'x');
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(pedrolib::Xxh64(data.data(), data.size()));
+  }
+  state.SetBytesProcessed(
+      static_cast<int64_t>(state.iterations() * data.size()));
+}
+
+void BM_Xxh3(benchmark::State& state) {
+  std::string data(static_cast<size_t>(state.range(0)), 'x');
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(pedrolib::Xxh3(data.data(), data.size()));
+  }
+  state.SetBytesProcessed(
+      static_cast<int64_t>(state.iterations() * data.size()));
+}
+
+}  // namespace
+
+BENCHMARK(BM_Crc32c)->Arg(16)->Arg(256)->Arg(4 << 10)->Arg(1 << 20);
+BENCHMARK(BM_Crc32cParallel)->Arg(16 << 20)->UseRealTime();
+BENCHMARK(BM_Crc32cCombine);
+BENCHMARK(BM_Xxh64)->Arg(16)->Arg(256)->Arg(4 << 10)->Arg(1 << 20);
+BENCHMARK(BM_Xxh3)->Arg(16)->Arg(256)->Arg(4 << 10)->Arg(1 << 20);
+
+BENCHMARK_MAIN();
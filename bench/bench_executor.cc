@@ -0,0 +1,137 @@
+#include <benchmark/benchmark.h>
+#include <pedrolib/concurrent/latch.h>
+#include <pedrolib/executor/thread_pool_executor.h>
+#include <numeric>
+#include <vector>
+
+using pedrolib::Duration;
+using pedrolib::Latch;
+using pedrolib::ThreadPoolExecutor;
+
+namespace {
+
+// Schedules range(1) tasks on a pool of range(0) workers and waits for all
+// of them: dispatch throughput.
+void BM_ScheduleThroughput(benchmark::State& state) {
+  ThreadPoolExecutor executor(static_cast<size_t>(state.range(0)));
+  const auto tasks = static_cast<uint32_t>(state.range(1));
+  for (auto _ : state) {
+    Latch latch(tasks);
+    for (uint32_t i = 0; i < tasks; ++i) {
+      executor.Schedule([&] { latch.CountDown(); });
+    }
+    latch.Await();
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * tasks));
+}
+
+// Fans out range(0) tasks to a 4-worker pool and waits for them, one
+// Schedule call per task.
+void BM_FanOutLoop(benchmark::State& state) {
+  ThreadPoolExecutor executor(4);
+  const auto tasks = static_cast<uint32_t>(state.range(0));
+  for (auto _ : state) {
+    Latch latch(tasks);
+    for (uint32_t i = 0; i < tasks; ++i) {
+      executor.Schedule([&] { latch.CountDown(); });
+    }
+    latch.Await();
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * tasks));
+}
+
+// The same fan-out through a single ScheduleBatch call.
+void BM_FanOutBatch(benchmark::State& state) {
+  ThreadPoolExecutor executor(4);
+  const auto tasks = static_cast<uint32_t>(state.range(0));
+  std::vector<pedrolib::Callback> callbacks(tasks);
+  for (auto _ : state) {
+    Latch latch(tasks);
+    for (auto& callback : callbacks) {
+      callback = [&] { latch.CountDown(); };
+    }
+    executor.ScheduleBatch(callbacks.data(), callbacks.size());
+    latch.Await();
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * tasks));
+}
+
+// One task at a time: the time from Schedule until the task has run.
+void BM_ScheduleLatency(benchmark::State& state) {
+  ThreadPoolExecutor executor(static_cast<size_t>(state.range(0)));
+  for (auto _ : state) {
+    std::atomic_bool done{false};
+    executor.Schedule([&] { done.store(true, std::memory_order_release); });
+    while (!done.load(std::memory_order_acquire)) {
+      std::this_thread::yield();
+    }
+  }
+}
+
+void BM_TimerArmCancel(benchmark::State& state) {
+  ThreadPoolExecutor executor(2);
+  for (auto _ : state) {
+    uint64_t id = executor.ScheduleAfter(Duration::Seconds(3600), [] {});
+    executor.ScheduleCancel(id);
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+}
+
+// Arms range(0) timers, then cancels them all.
+void BM_TimerArmThenCancel(benchmark::State& state) {
+  ThreadPoolExecutor executor(2);
+  std::vector<uint64_t> ids(static_cast<size_t>(state.range(0)));
+  for (auto _ : state) {
+    for (auto& id : ids) {
+      id = executor.ScheduleAfter(Duration::Seconds(3600), [] {});
+    }
+    for (auto id : ids) {
+      executor.ScheduleCancel(id);
+    }
+  }
+  state.SetItemsProcessed(
+      static_cast<int64_t>(state.iterations() * ids.size()));
+}
+
+// Sums range(1) integers on a pool of range(0) workers.
+void BM_ForEach(benchmark::State& state) {
+  ThreadPoolExecutor executor(static_cast<size_t>(state.range(0)));
+  std::vector<uint64_t> values(static_cast<size_t>(state.range(1)));
+  std::iota(values.begin(), values.end(), 0);
+  for (auto _ : state) {
+    std::atomic<uint64_t> sum{0};
+    pedrolib::for_each(&executor, values.begin(), values.end(),
+                       [&](uint64_t v) {
+                         sum.fetch_add(v, std::memory_order_relaxed);
+                       });
+    benchmark::DoNotOptimize(sum.load());
+  }
+  state.SetItemsProcessed(
+      static_cast<int64_t>(state.iterations() * values.size()));
+}
+
+}  // namespace
+
+BENCHMARK(BM_ScheduleThroughput)
+    ->ArgsProduct({{1, 2, 4, 8}, {1 << 12}})
+    ->ArgNames({"threads", "tasks"})
+    ->UseRealTime();
+BENCHMARK(BM_FanOutLoop)
+    ->Arg(1000)
+    ->Arg(100000)
+    ->ArgName("tasks")
+    ->UseRealTime();
+BENCHMARK(BM_FanOutBatch)
+    ->Arg(1000)
+    ->Arg(100000)
+    ->ArgName("tasks")
+    ->UseRealTime();
+BENCHMARK(BM_ScheduleLatency)->Arg(1)->Arg(4)->ArgName("threads");
+BENCHMARK(BM_TimerArmCancel);
+BENCHMARK(BM_TimerArmThenCancel)->Arg(1 << 10)->Arg(1 << 16)->ArgName("timers");
+BENCHMARK(BM_ForEach)
+    ->ArgsProduct({{1, 2, 4, 8}, {1 << 10, 1 << 20}})
+    ->ArgNames({"threads", "items"})
+    ->UseRealTime();
+
+BENCHMARK_MAIN();
@@ -0,0 +1,144 @@
+#include <benchmark/benchmark.h>
+#include <pedrolib/executor/thread_pool_executor.h>
+#include <pedrolib/file/buffered_file.h>
+#include <pedrolib/file/file.h>
+#include <pedrolib/file/parallel_scan.h>
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <string>
+#include <unistd.h>
+
+using pedrolib::BufferedFileReader;
+using pedrolib::BufferedFileWriter;
+using pedrolib::File;
+using pedrolib::ThreadPoolExecutor;
+
+namespace {
+
+constexpr uint64_t kFileBytes = 64 << 20;
+
+// A scratch file that is unlinked right away and removed on close.
+File TempFile() {
+  char name[] = "/tmp/pedrolib-bench-XXXXXX";
+  int fd = mkstemp(name);
+  unlink(name);
+  File file(fd);
+  file.Reserve(kFileBytes);
+  return file;
+}
+
+// Writes range(0)-byte blocks at sequential offsets, wrapping at 64 MiB.
+void BM_Pwrite(benchmark::State& state) {
+  const auto n = static_cast<size_t>(state.range(0));
+  File file = TempFile();
+  std::string block(n, 'x');
+  uint64_t offset = 0;
+  for (auto _ : state) {
+    if (file.Pwrite(offset, block.data(), n) != static_cast<ssize_t>(n)) {
+      state.SkipWithError("pwrite failed");
+      break;
+    }
+    offset = (offset + n) % kFileBytes;
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * n));
+}
+
+// Reads range(0)-byte blocks back from the page cache.
+void BM_Pread(benchmark::State& state) {
+  const auto n = static_cast<size_t>(state.range(0));
+  File file = TempFile();
+  std::string block(n, 'x');
+  for (uint64_t offset = 0; offset < kFileBytes; offset += n) {
+    file.Pwrite(offset, block.data(), n);
+  }
+
+  uint64_t offset = 0;
+  for (auto _ : state) {
+    if (file.Pread(offset, block.data(), n) != static_cast<ssize_t>(n)) {
+      state.SkipWithError("pread failed");
+      break;
+    }
+    offset = (offset + n) % kFileBytes;
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * n));
+}
+
+// Scans the file in 4 KiB Read calls through a BufferedFileReader, with
+// readahead on a pool when range(0) is 1 and inline otherwise.
+void BM_BufferedScan(benchmark::State& state) {
+  File file = TempFile();
+  std::string block(1 << 20, 'x');
+  for (uint64_t offset = 0; offset < kFileBytes; offset += block.size()) {
+    file.Pwrite(offset, block.data(), block.size());
+  }
+
+  ThreadPoolExecutor executor(2);
+  for (auto _ : state) {
+    BufferedFileReader reader(&file, state.range(0) ? &executor : nullptr);
+    while (reader.Read(block.data(), 4096) > 0) {
+    }
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations() *
+                                               kFileBytes));
+  executor.Close();
+  executor.Join();
+}
+
+// Writes the file in 4 KiB chunks through a BufferedFileWriter.
+void BM_BufferedWrite(benchmark::State& state) {
+  File file = TempFile();
+  std::string block(4096, 'x');
+  ThreadPoolExecutor executor(2);
+  for (auto _ : state) {
+    BufferedFileWriter writer(&file, state.range(0) ? &executor : nullptr);
+    for (uint64_t n = 0; n < kFileBytes; n += block.size()) {
+      writer.Write(block);
+    }
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations() *
+                                               kFileBytes));
+  executor.Close();
+  executor.Join();
+}
+
+// Counts the lines of a 64 MiB file with ParallelScan on a pool, reading
+// chunks with Pread when range(0) is 0 and through a mapping otherwise.
+void BM_ParallelScan(benchmark::State& state) {
+  File file = TempFile();
+  std::string block(1 << 20, 'x');
+  for (size_t i = 99; i < block.size(); i += 100) {
+    block[i] = '\n';
+  }
+  for (uint64_t offset = 0; offset < kFileBytes; offset += block.size()) {
+    file.Pwrite(offset, block.data(), block.size());
+  }
+
+  pedrolib::ScanOptions options;
+  options.delimiter = '\n';
+  options.map = state.range(0) != 0;
+  ThreadPoolExecutor executor;
+  for (auto _ : state) {
+    std::atomic<size_t> lines{0};
+    pedrolib::ParallelScan(file, &executor, options,
+                           [&](const pedrolib::ScanChunk& chunk) {
+                             lines += std::count(chunk.data.begin(),
+                                                 chunk.data.end(), '\n');
+                           });
+    benchmark::DoNotOptimize(lines.load());
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations() *
+                                               kFileBytes));
+  executor.Close();
+  executor.Join();
+}
+
+}  // namespace
+
+BENCHMARK(BM_Pwrite)->RangeMultiplier(4)->Range(4 << 10, 1 << 20);
+BENCHMARK(BM_Pread)->RangeMultiplier(4)->Range(4 << 10, 1 << 20);
+BENCHMARK(BM_BufferedScan)->Arg(0)->Arg(1)->ArgName("async")->UseRealTime();
+BENCHMARK(BM_BufferedWrite)->Arg(0)->Arg(1)->ArgName("async")->UseRealTime();
+BENCHMARK(BM_ParallelScan)->Arg(0)->Arg(1)->ArgName("map")->UseRealTime();
+
+BENCHMARK_MAIN();
@@ -0,0 +1,54 @@
+#include <benchmark/benchmark.h>
+#include <pedrolib/collection/simple_concurrent_hashmap.h>
+#include <random>
+
+using pedrolib::SimpleConcurrentHashMap;
+
+namespace {
+
+constexpr uint64_t kKeys = 1 << 16;
+
+SimpleConcurrentHashMap<uint64_t, uint64_t>& Map() {
+  static auto* map = [] {
+    auto* m = new SimpleConcurrentHashMap<uint64_t, uint64_t>(64);
+    for (uint64_t i = 0; i < kKeys; i += 2) {
+      m->insert(i, i);
+    }
+    return m;
+  }();
+  return *map;
+}
+
+// range(0) percent of the operations are writes (an insert or an erase of
+// a random key); the rest are lookups.
+void BM_Mixed(benchmark::State& state) {
+  auto& map = Map();
+  const auto write_percent = static_cast<uint32_t>(state.range(0));
+  std::mt19937_64 rng(state.thread_index());
+  uint64_t value;
+  for (auto _ : state) {
+    uint64_t r = rng();
+    uint64_t key = r % kKeys;
+    if ((r >> 32) % 100 < write_percent) {
+      if (r & (1ULL << 63)) {
+        map.insert(key, key);
+      } else {
+        map.erase(key, value);
+      }
+    } else {
+      benchmark::DoNotOptimize(map.at(key, value));
+    }
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+}
+
+}  // namespace
+
+BENCHMARK(BM_Mixed)
+    ->Arg(10)
+    ->Arg(50)
+    ->ArgName("write_percent")
+    ->ThreadRange(1, 16)
+    ->UseRealTime();
+
+BENCHMARK_MAIN();
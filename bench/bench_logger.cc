@@ -0,0 +1,61 @@
+#include <benchmark/benchmark.h>
+#include <pedrolib/logger/logger.h>
+#include <memory>
+
+using pedrolib::AsyncLogSink;
+using pedrolib::BinaryLogSink;
+using pedrolib::File;
+using pedrolib::Logger;
+
+namespace {
+
+File DevNull() {
+  return File::Open("/dev/null", {.mode = File::OpenMode::kWrite});
+}
+
+template <typename Sink>
+Logger* MakeLogger(const char* name) {
+  auto* logger = new Logger(name);
+  logger->SetLevel(Logger::Level::kInfo);
+  logger->SetSink(std::make_shared<Sink>(DevNull()));
+  return logger;
+}
+
+// Every thread logs into the same logger; the sink writes to /dev/null.
+template <typename Sink>
+void BM_Info(benchmark::State& state, Logger* logger) {
+  uint64_t i = 0;
+  for (auto _ : state) {
+    logger->Info("request {} from {} took {}us", i++, "10.0.0.1:4242", 117);
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+}
+
+void BM_AsyncInfo(benchmark::State& state) {
+  static Logger* logger = MakeLogger<AsyncLogSink>("bench-async");
+  BM_Info<AsyncLogSink>(state, logger);
+}
+
+void BM_BinaryInfo(benchmark::State& state) {
+  static Logger* logger = MakeLogger<BinaryLogSink>("bench-binary");
+  BM_Info<BinaryLogSink>(state, logger);
+}
+
+// A statement below the logger's level: the cost of a disabled log.
+void BM_Disabled(benchmark::State& state) {
+  static Logger* logger = MakeLogger<AsyncLogSink>("bench-disabled");
+  logger->SetLevel(Logger::Level::kWarn);
+  uint64_t i = 0;
+  for (auto _ : state) {
+    logger->Info("request {} from {} took {}us", i++, "10.0.0.1:4242", 117);
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+}
+
+}  // namespace
+
+BENCHMARK(BM_AsyncInfo)->ThreadRange(1, 4)->UseRealTime();
+BENCHMARK(BM_BinaryInfo)->ThreadRange(1, 4)->UseRealTime();
+BENCHMARK(BM_Disabled);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,164 @@
+#include <benchmark/benchmark.h>
+#include <pedrolib/clock.h>
+#include <pedrolib/collection/mpmc_queue.h>
+#include <pedrolib/collection/spsc_queue.h>
+#include <pedrolib/concurrent/backoff.h>
+#include <pedrolib/metric/histogram.h>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+using pedrolib::Backoff;
+using pedrolib::BoundedMPMCQueue;
+using pedrolib::Histogram;
+using pedrolib::MonotonicClock;
+using pedrolib::SPSCQueue;
+
+namespace {
+
+constexpr size_t kCapacity = 1024;
+constexpr uint64_t kItems = 1 << 18;
+
+// Baseline: what the executor used before, a std::queue behind a mutex.
+template <typename T>
+class MutexQueue {
+  std::mutex mu_;
+  std::queue<T> queue_;
+
+ public:
+  explicit MutexQueue(size_t) {}
+
+  bool try_push(T value) {
+    std::lock_guard guard(mu_);
+    if (queue_.size() == kCapacity) {
+      return false;
+    }
+    queue_.push(value);
+    return true;
+  }
+
+  bool try_pop(T& value) {
+    std::lock_guard guard(mu_);
+    if (queue_.empty()) {
+      return false;
+    }
+    value = queue_.front();
+    queue_.pop();
+    return true;
+  }
+
+  template <typename It>
+  size_t try_push_n(It first, size_t n) {
+    size_t k = 0;
+    while (k < n && try_push(*first++)) {
+      ++k;
+    }
+    return k;
+  }
+
+  template <typename It>
+  size_t try_pop_n(It out, size_t n) {
+    size_t k = 0;
+    while (k < n && try_pop(*out++)) {
+      ++k;
+    }
+    return k;
+  }
+};
+
+// Moves kItems timestamps from range(0) producers to range(1) consumers in
+// batches of range(2), and reports throughput plus push-to-pop latency.
+template <typename Queue>
+void BM_Pipeline(benchmark::State& state) {
+  const int producers = static_cast<int>(state.range(0));
+  const int consumers = static_cast<int>(state.range(1));
+  const size_t batch = static_cast<size_t>(state.range(2));
+  Histogram latency;
+
+  for (auto _ : state) {
+    Queue queue(kCapacity);
+    std::atomic<uint64_t> consumed{0};
+    std::vector<std::thread> threads;
+
+    auto start = MonotonicClock::Nanoseconds();
+    for (int i = 0; i < producers; ++i) {
+      uint64_t n = kItems / producers + (static_cast<uint64_t>(i) < kItems % producers ? 1 : 0);
+      threads.emplace_back([&queue, n, batch] {
+        std::vector<int64_t> items(batch);
+        Backoff backoff;
+        for (uint64_t sent = 0; sent < n;) {
+          size_t want = std::min<uint64_t>(batch, n - sent);
+          for (size_t j = 0; j < want; ++j) {
+            items[j] = MonotonicClock::Nanoseconds();
+          }
+          for (size_t j = 0; j < want;) {
+            size_t k = queue.try_push_n(items.begin() + j, want - j);
+            if (k == 0) {
+              backoff.Pause();
+              continue;
+            }
+            backoff.Reset();
+            j += k;
+          }
+          sent += want;
+        }
+      });
+    }
+    for (int i = 0; i < consumers; ++i) {
+      threads.emplace_back([&queue, &consumed, &latency, batch] {
+        std::vector<int64_t> items(batch);
+        Backoff backoff;
+        while (consumed.load(std::memory_order_relaxed) < kItems) {
+          size_t k = queue.try_pop_n(items.begin(), batch);
+          if (k == 0) {
+            backoff.Pause();
+            continue;
+          }
+          backoff.Reset();
+          int64_t now = MonotonicClock::Nanoseconds();
+          for (size_t j = 0; j < k; ++j) {
+            latency.Record(now - items[j]);
+          }
+          consumed.fetch_add(k, std::memory_order_relaxed);
+        }
+      });
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+    state.SetIterationTime(
+        static_cast<double>(MonotonicClock::Nanoseconds() - start) / 1e9);
+  }
+
+  auto snapshot = latency.Snapshot();
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * kItems));
+  state.counters["p50_ns"] = static_cast<double>(snapshot.Percentile(50));
+  state.counters["p99_ns"] = static_cast<double>(snapshot.Percentile(99));
+}
+
+void Topologies(benchmark::internal::Benchmark* b) {
+  for (int64_t batch : {1, 32}) {
+    b->Args({1, 1, batch});
+    b->Args({1, 4, batch});
+    b->Args({4, 1, batch});
+    b->Args({4, 4, batch});
+  }
+  b->ArgNames({"producers", "consumers", "batch"});
+  b->UseManualTime()->Unit(benchmark::kMillisecond);
+}
+
+void SingleProducerSingleConsumer(benchmark::internal::Benchmark* b) {
+  b->Args({1, 1, 1})->Args({1, 1, 32});
+  b->ArgNames({"producers", "consumers", "batch"});
+  b->UseManualTime()->Unit(benchmark::kMillisecond);
+}
+
+}  // namespace
+
+BENCHMARK_TEMPLATE(BM_Pipeline, MutexQueue<int64_t>)->Apply(Topologies);
+BENCHMARK_TEMPLATE(BM_Pipeline, BoundedMPMCQueue<int64_t>)->Apply(Topologies);
+BENCHMARK_TEMPLATE(BM_Pipeline, SPSCQueue<int64_t>)
+    ->Apply(SingleProducerSingleConsumer);
+
+BENCHMARK_MAIN();
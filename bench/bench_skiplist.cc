@@ -0,0 +1,117 @@
+#include <benchmark/benchmark.h>
+#include <pedrolib/collection/concurrent_skiplist.h>
+#include <map>
+#include <mutex>
+#include <random>
+
+using pedrolib::ConcurrentSkipListMap;
+
+namespace {
+
+constexpr uint64_t kKeys = 1 << 20;
+
+// The baseline: one std::map behind a mutex.
+class LockedMap {
+  std::mutex mu_;
+  std::map<uint64_t, uint64_t> map_;
+
+ public:
+  void Insert(uint64_t key, uint64_t value) {
+    std::lock_guard<std::mutex> lock(mu_);
+    map_.emplace(key, value);
+  }
+
+  bool Contains(uint64_t key) {
+    std::lock_guard<std::mutex> lock(mu_);
+    return map_.count(key) != 0;
+  }
+
+  uint64_t Scan(uint64_t key, int n) {
+    std::lock_guard<std::mutex> lock(mu_);
+    uint64_t sum = 0;
+    for (auto it = map_.lower_bound(key); it != map_.end() && n-- > 0; ++it) {
+      sum += it->second;
+    }
+    return sum;
+  }
+};
+
+class SkipListMap {
+  ConcurrentSkipListMap<uint64_t, uint64_t> map_;
+
+ public:
+  void Insert(uint64_t key, uint64_t value) { map_.insert(key, value); }
+
+  bool Contains(uint64_t key) { return map_.contains(key); }
+
+  uint64_t Scan(uint64_t key, int n) {
+    uint64_t sum = 0;
+    for (auto it = map_.lower_bound(key); it != map_.end() && n-- > 0; ++it) {
+      sum += it->second;
+    }
+    return sum;
+  }
+};
+
+// Half the key space, shared by all threads of all runs.
+template <typename Map>
+Map& Prefilled() {
+  static auto* map = [] {
+    auto* m = new Map();
+    std::mt19937_64 rng(1);
+    for (uint64_t i = 0; i < kKeys / 2; ++i) {
+      m->Insert(rng() % kKeys, i);
+    }
+    return m;
+  }();
+  return *map;
+}
+
+// range(0) percent of the operations insert a random key; the rest look
+// one up.
+template <typename Map>
+void BM_Mixed(benchmark::State& state) {
+  auto& map = Prefilled<Map>();
+  const auto write_percent = static_cast<uint64_t>(state.range(0));
+  std::mt19937_64 rng(state.thread_index() + 2);
+  for (auto _ : state) {
+    uint64_t r = rng();
+    uint64_t key = r % kKeys;
+    if ((r >> 32) % 100 < write_percent) {
+      map.Insert(key, r);
+    } else {
+      benchmark::DoNotOptimize(map.Contains(key));
+    }
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+}
+
+// Sums the 16 entries from a random starting key.
+template <typename Map>
+void BM_Scan(benchmark::State& state) {
+  auto& map = Prefilled<Map>();
+  std::mt19937_64 rng(state.thread_index() + 2);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(map.Scan(rng() % kKeys, 16));
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+}
+
+}  // namespace
+
+BENCHMARK_TEMPLATE(BM_Mixed, LockedMap)
+    ->Arg(10)
+    ->Arg(50)
+    ->ArgName("write_percent")
+    ->ThreadRange(1, 8)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(BM_Mixed, SkipListMap)
+    ->Arg(10)
+    ->Arg(50)
+    ->ArgName("write_percent")
+    ->ThreadRange(1, 8)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(BM_Scan, LockedMap)->ThreadRange(1, 8)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_Scan, SkipListMap)->ThreadRange(1, 8)->UseRealTime();
+
+BENCHMARK_MAIN();
@@ -0,0 +1,84 @@
+#include <benchmark/benchmark.h>
+#include <pedrolib/net/socket.h>
+#include <string>
+#include <vector>
+
+using pedrolib::Socket;
+using pedrolib::SocketAddress;
+
+namespace {
+
+constexpr size_t kMessageBytes = 64;
+
+struct Loopback {
+  Socket receiver = Socket::CreateListener(SocketAddress::Loopback(),
+                                           Socket::Type::kDatagram);
+  Socket sender = Socket::CreateListener(SocketAddress::Loopback(),
+                                         Socket::Type::kDatagram);
+  SocketAddress to = *receiver.LocalAddress();
+};
+
+// Sends range(0) datagrams over loopback UDP and receives them back, one
+// sendto and one recvfrom per message.
+void BM_UdpSingle(benchmark::State& state) {
+  const auto n = static_cast<size_t>(state.range(0));
+  Loopback loopback;
+  std::string message(kMessageBytes, 'x');
+  char buf[kMessageBytes];
+  for (auto _ : state) {
+    for (size_t i = 0; i < n; ++i) {
+      loopback.sender.SendTo(message.data(), message.size(), loopback.to);
+    }
+    for (size_t i = 0; i < n; ++i) {
+      if (loopback.receiver.ReceiveFrom(buf, sizeof(buf), nullptr) < 0) {
+        state.SkipWithError("recvfrom failed");
+        return;
+      }
+    }
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * n));
+}
+
+// The same traffic with one sendmmsg and one recvmmsg per range(0)
+// messages.
+void BM_UdpBatch(benchmark::State& state) {
+  const auto n = static_cast<size_t>(state.range(0));
+  Loopback loopback;
+  std::string message(kMessageBytes, 'x');
+  std::vector<std::string> buffers(n, std::string(kMessageBytes, '\0'));
+  std::vector<Socket::Datagram> outgoing(n);
+  std::vector<Socket::Datagram> incoming(n);
+  for (size_t i = 0; i < n; ++i) {
+    outgoing[i] = {message.data(), message.size(), &loopback.to};
+  }
+  for (auto _ : state) {
+    for (size_t sent = 0; sent < n;) {
+      int w = loopback.sender.SendBatch(outgoing.data() + sent, n - sent);
+      if (w <= 0) {
+        state.SkipWithError("sendmmsg failed");
+        return;
+      }
+      sent += w;
+    }
+    for (size_t received = 0; received < n;) {
+      for (size_t i = received; i < n; ++i) {
+        incoming[i] = {buffers[i].data(), kMessageBytes, nullptr};
+      }
+      int r = loopback.receiver.ReceiveBatch(incoming.data() + received,
+                                             n - received);
+      if (r <= 0) {
+        state.SkipWithError("recvmmsg failed");
+        return;
+      }
+      received += r;
+    }
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * n));
+}
+
+}  // namespace
+
+BENCHMARK(BM_UdpSingle)->Arg(8)->Arg(32)->Arg(128)->ArgName("messages");
+BENCHMARK(BM_UdpBatch)->Arg(8)->Arg(32)->Arg(128)->ArgName("messages");
+
+BENCHMARK_MAIN();
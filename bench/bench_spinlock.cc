@@ -0,0 +1,85 @@
+#include <benchmark/benchmark.h>
+#include <pedrolib/concurrent/mcs_spinlock.h>
+#include <pedrolib/concurrent/rw_spinlock.h>
+#include <pedrolib/concurrent/spinlock.h>
+#include <pedrolib/concurrent/ticket_spinlock.h>
+#include <mutex>
+#include <shared_mutex>
+
+using pedrolib::MCSSpinLock;
+using pedrolib::RWSpinLock;
+using pedrolib::SpinLock;
+using pedrolib::TicketSpinLock;
+
+namespace {
+
+// A few cache lines of shared state, so the critical section is not empty.
+struct alignas(64) Shared {
+  uint64_t values[16]{};
+
+  void Update() noexcept {
+    for (auto& value : values) {
+      ++value;
+    }
+  }
+
+  uint64_t Read() const noexcept {
+    uint64_t sum = 0;
+    for (auto value : values) {
+      sum += value;
+    }
+    return sum;
+  }
+};
+
+template <typename Lock>
+void BM_Lock(benchmark::State& state) {
+  static Lock lock;
+  static Shared shared;
+  for (auto _ : state) {
+    std::lock_guard<Lock> guard(lock);
+    shared.Update();
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+void BM_MCSSpinLock(benchmark::State& state) {
+  static MCSSpinLock lock;
+  static Shared shared;
+  for (auto _ : state) {
+    MCSSpinLock::Guard guard(lock);
+    shared.Update();
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+// One write in every 16 operations.
+template <typename Lock>
+void BM_ReadMostly(benchmark::State& state) {
+  static Lock lock;
+  static Shared shared;
+  uint64_t n = 0;
+  for (auto _ : state) {
+    if ((++n & 15) == 0) {
+      std::unique_lock<Lock> guard(lock);
+      shared.Update();
+    } else {
+      std::shared_lock<Lock> guard(lock);
+      benchmark::DoNotOptimize(shared.Read());
+    }
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+}  // namespace
+
+BENCHMARK_TEMPLATE(BM_Lock, std::mutex)->ThreadRange(2, 64)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_Lock, SpinLock)->ThreadRange(2, 64)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_Lock, TicketSpinLock)->ThreadRange(2, 64)->UseRealTime();
+BENCHMARK(BM_MCSSpinLock)->ThreadRange(2, 64)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_ReadMostly, std::shared_mutex)
+    ->ThreadRange(2, 64)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(BM_ReadMostly, RWSpinLock)->ThreadRange(2, 64)->UseRealTime();
+
+BENCHMARK_MAIN();
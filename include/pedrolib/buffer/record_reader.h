@@ -0,0 +1,64 @@
+#ifndef PEDROLIB_BUFFER_RECORD_READER_H
+#define PEDROLIB_BUFFER_RECORD_READER_H
+
+#include <optional>
+#include <string>
+#include <string_view>
+#include "pedrolib/buffer/array_buffer.h"
+#include "pedrolib/file/file.h"
+
+namespace pedrolib {
+
+// Splits the bytes of a File into delimiter-terminated records. Records
+// are views into the reader's buffer, valid until the next call to Next.
+// The search resumes where the previous one stopped, so a record that
+// spans many reads is scanned once.
+class RecordReader {
+ public:
+  struct Options {
+    // Up to 2 bytes take the vector search; longer delimiters are matched
+    // on their first two bytes and verified.
+    std::string delimiter{"\n"};
+    // With a "\n" delimiter, also drops a '\r' before it.
+    bool strip_cr{true};
+    // Longer records fail with EMSGSIZE once and are then skipped; the next
+    // call resumes after their delimiter.
+    size_t max_record{1 << 20};
+    // Free space ensured before each read.
+    size_t read_size{64 << 10};
+  };
+
+ private:
+  File* file_;
+  Options options_;
+  ArrayBuffer buffer_;
+  // Bytes after ReadIndex() already known not to start a delimiter.
+  size_t scanned_{};
+  // Set while discarding the rest of an oversized record.
+  bool skipping_{false};
+  bool eof_{false};
+  Error error_;
+
+  const char* find(const char* begin, const char* end) const noexcept;
+
+ public:
+  explicit RecordReader(File* file) : RecordReader(file, Options{}) {}
+
+  RecordReader(File* file, Options options);
+
+  // The next record without its delimiter. At end of file the trailing
+  // bytes, if any, form the last record. Returns nullopt at the end, on a
+  // read error, or when a non-blocking file has no more data for now
+  // (GetError is EAGAIN; call again once it is readable).
+  std::optional<std::string_view> Next();
+
+  [[nodiscard]] bool Eof() const noexcept {
+    return eof_ && buffer_.ReadableBytes() == 0;
+  }
+
+  [[nodiscard]] Error GetError() const noexcept { return error_; }
+};
+
+}  // namespace pedrolib
+
+#endif  // PEDROLIB_BUFFER_RECORD_READER_H
@@ -0,0 +1,94 @@
+#ifndef PEDROLIB_BUFFER_RING_BUFFER_H
+#define PEDROLIB_BUFFER_RING_BUFFER_H
+
+#include <algorithm>
+#include <utility>
+#include "pedrolib/buffer/buffer.h"
+#include "pedrolib/file/file.h"
+#include "pedrolib/noncopyable.h"
+
+namespace pedrolib {
+
+// A byte queue with the ArrayBuffer API that never compacts. The storage is
+// one memfd mapped twice back to back, so the readable and writable spans
+// are always contiguous, even across the wrap point, and retrieving bytes
+// only moves an index. Capacity is rounded up to whole pages.
+class RingBuffer final : noncopyable {
+  static const size_t kInitialSize = 64 * 1024;
+
+  char* base_{};
+  size_t capacity_{};
+  size_t read_index_{};
+  size_t readable_{};
+
+  void remap(size_t capacity);
+
+ public:
+  explicit RingBuffer(size_t capacity);
+  RingBuffer() : RingBuffer(kInitialSize) {}
+
+  RingBuffer(RingBuffer&& other) noexcept
+      : base_(std::exchange(other.base_, nullptr)),
+        capacity_(std::exchange(other.capacity_, 0)),
+        read_index_(std::exchange(other.read_index_, 0)),
+        readable_(std::exchange(other.readable_, 0)) {}
+
+  RingBuffer& operator=(RingBuffer&& other) noexcept {
+    std::swap(base_, other.base_);
+    std::swap(capacity_, other.capacity_);
+    std::swap(read_index_, other.read_index_);
+    std::swap(readable_, other.readable_);
+    return *this;
+  }
+
+  ~RingBuffer();
+
+  [[nodiscard]] size_t Capacity() const noexcept { return capacity_; }
+
+  [[nodiscard]] size_t ReadableBytes() const noexcept { return readable_; }
+
+  [[nodiscard]] size_t WritableBytes() const noexcept {
+    return capacity_ - readable_;
+  }
+
+  void Append(size_t n) { readable_ = std::min(readable_ + n, capacity_); }
+
+  void Retrieve(size_t n) {
+    n = std::min(n, readable_);
+    readable_ -= n;
+    read_index_ += n;
+    if (read_index_ >= capacity_) {
+      read_index_ -= capacity_;
+    }
+    if (readable_ == 0) {
+      read_index_ = 0;
+    }
+  }
+
+  void Reset() { read_index_ = readable_ = 0; }
+
+  void Append(const char* data, size_t n);
+
+  size_t Retrieve(char* data, size_t n);
+
+  // Grows the buffer, copying once, when fewer than n bytes are writable.
+  void EnsureWritable(size_t n, bool fixed = true);
+
+  // Reads into the writable span, growing first when it is empty.
+  ssize_t Append(File* source);
+
+  // Writes all readable bytes with one call.
+  ssize_t Retrieve(File* target);
+
+  void Append(RingBuffer* buffer);
+
+  void Retrieve(RingBuffer* buffer);
+
+  const char* ReadIndex() { return base_ + read_index_; }
+
+  char* WriteIndex() { return base_ + read_index_ + readable_; }
+};
+
+}  // namespace pedrolib
+
+#endif  // PEDROLIB_BUFFER_RING_BUFFER_H
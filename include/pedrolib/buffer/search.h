@@ -0,0 +1,34 @@
+#ifndef PEDROLIB_BUFFER_SEARCH_H
+#define PEDROLIB_BUFFER_SEARCH_H
+
+#include <string_view>
+
+namespace pedrolib {
+
+// Delimiter search over [begin, end). Every function returns the first
+// match or end. The kernels are picked once at startup from what the CPU
+// supports: AVX2, then SSE2, then a scalar loop.
+
+const char* FindByte(const char* begin, const char* end, char c) noexcept;
+
+// The first byte that is in set; sets of up to 16 bytes take the vector
+// path.
+const char* FindAnyOf(const char* begin, const char* end,
+                      std::string_view set) noexcept;
+
+// The first position of the two-byte sequence first, second, such as
+// "\r\n".
+const char* FindPair(const char* begin, const char* end, char first,
+                     char second) noexcept;
+
+enum class SearchIsa { kScalar, kSse2, kAvx2 };
+
+[[nodiscard]] SearchIsa GetSearchIsa() noexcept;
+
+// Forces a kernel set, for tests and benchmarks. Returns false when the
+// CPU does not support it.
+bool SetSearchIsa(SearchIsa isa) noexcept;
+
+}  // namespace pedrolib
+
+#endif  // PEDROLIB_BUFFER_SEARCH_H
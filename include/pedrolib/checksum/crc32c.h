@@ -0,0 +1,78 @@
+#ifndef PEDROLIB_CHECKSUM_CRC32C_H
+#define PEDROLIB_CHECKSUM_CRC32C_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include "pedrolib/buffer/array_buffer.h"
+
+namespace pedrolib {
+
+struct Executor;
+
+// CRC-32C (Castagnoli), as used by iSCSI, ext4 and most storage formats.
+// Like zlib's crc32, crc is the checksum of the preceding bytes, 0 for
+// none, so Crc32c(b, m, Crc32c(a, n)) is the checksum of a followed by b.
+// Uses the SSE4.2 crc32 instruction, three streams at a time merged with
+// PCLMUL, when the CPU has them, and slicing-by-8 tables otherwise.
+uint32_t Crc32c(const void* data, size_t n, uint32_t crc = 0) noexcept;
+
+// Continues crc over the concatenation of n buffers, as passed to Writev.
+uint32_t Crc32c(const std::string_view* buf, size_t n,
+                uint32_t crc = 0) noexcept;
+
+// The checksum of A followed by B, given crc_a, crc_b and B's length.
+// Costs O(log n), so blocks can be checksummed independently and merged.
+uint32_t Crc32cCombine(uint32_t crc_a, uint32_t crc_b, size_t n) noexcept;
+
+// Checksums [data, data + n) in chunks on executor and merges the results.
+uint32_t Crc32c(Executor* executor, const void* data, size_t n);
+
+// True when the hardware path is in use.
+bool Crc32cAccelerated() noexcept;
+
+class Crc32cHasher {
+  uint32_t crc_{};
+  uint64_t length_{};
+
+ public:
+  void Update(const void* data, size_t n) noexcept {
+    crc_ = Crc32c(data, n, crc_);
+    length_ += n;
+  }
+
+  void Update(std::string_view data) noexcept {
+    Update(data.data(), data.size());
+  }
+
+  void Update(const std::string_view* buf, size_t n) noexcept {
+    for (size_t i = 0; i < n; ++i) {
+      Update(buf[i]);
+    }
+  }
+
+  // Covers the readable bytes without consuming them.
+  void Update(ArrayBuffer* buffer) noexcept {
+    Update(buffer->ReadIndex(), buffer->ReadableBytes());
+  }
+
+  // Appends the checksum of bytes hashed elsewhere, such as a chunk
+  // hashed on another thread.
+  void Combine(uint32_t crc, size_t n) noexcept {
+    crc_ = Crc32cCombine(crc_, crc, n);
+    length_ += n;
+  }
+
+  [[nodiscard]] uint32_t Value() const noexcept { return crc_; }
+
+  [[nodiscard]] uint64_t Length() const noexcept { return length_; }
+
+  void Reset() noexcept {
+    crc_ = 0;
+    length_ = 0;
+  }
+};
+
+}  // namespace pedrolib
+
+#endif  // PEDROLIB_CHECKSUM_CRC32C_H
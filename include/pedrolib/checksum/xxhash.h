@@ -0,0 +1,57 @@
+#ifndef PEDROLIB_CHECKSUM_XXHASH_H
+#define PEDROLIB_CHECKSUM_XXHASH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include "pedrolib/buffer/array_buffer.h"
+
+namespace pedrolib {
+
+// xxHash, bit-compatible with the reference implementation. These are
+// fast non-cryptographic hashes for integrity checks within a system;
+// use Crc32c for formats that must stay stable and combinable.
+
+uint64_t Xxh64(const void* data, size_t n, uint64_t seed = 0) noexcept;
+
+// XXH3_64bits, with AVX2 for inputs over 240 bytes when the CPU has it.
+uint64_t Xxh3(const void* data, size_t n, uint64_t seed = 0) noexcept;
+
+// Streaming Xxh64: the same value as Xxh64 over all updates.
+class Xxh64Hasher {
+  uint64_t v_[4]{};
+  uint8_t buffer_[32]{};
+  uint32_t buffered_{};
+  uint64_t length_{};
+  uint64_t seed_{};
+
+ public:
+  explicit Xxh64Hasher(uint64_t seed = 0) { Reset(seed); }
+
+  void Reset(uint64_t seed = 0) noexcept;
+
+  void Update(const void* data, size_t n) noexcept;
+
+  void Update(std::string_view data) noexcept {
+    Update(data.data(), data.size());
+  }
+
+  void Update(const std::string_view* buf, size_t n) noexcept {
+    for (size_t i = 0; i < n; ++i) {
+      Update(buf[i]);
+    }
+  }
+
+  // Covers the readable bytes without consuming them.
+  void Update(ArrayBuffer* buffer) noexcept {
+    Update(buffer->ReadIndex(), buffer->ReadableBytes());
+  }
+
+  [[nodiscard]] uint64_t Value() const noexcept;
+
+  [[nodiscard]] uint64_t Length() const noexcept { return length_; }
+};
+
+}  // namespace pedrolib
+
+#endif  // PEDROLIB_CHECKSUM_XXHASH_H
@@ -0,0 +1,43 @@
+#ifndef PEDROLIB_CLOCK_H
+#define PEDROLIB_CLOCK_H
+
+#include "pedrolib/timestamp.h"
+
+namespace pedrolib {
+
+// A nanosecond clock that is not affected by wall-clock adjustments. Its epoch
+// is unspecified, so its values are only meaningful relative to each other.
+class MonotonicClock {
+ public:
+  enum class Source {
+    kClockGettime,
+    kTsc,
+  };
+
+  static int64_t Nanoseconds() noexcept;
+
+  static Timestamp Now() noexcept { return Timestamp{Nanoseconds() / 1000}; }
+
+  // Switches the clock to the given source. Selecting kTsc calibrates rdtsc
+  // against CLOCK_MONOTONIC and fails when the CPU has no invariant TSC.
+  static bool SetSource(Source source);
+
+  static Source GetSource() noexcept;
+};
+
+// A clock that reads cached timestamps refreshed by a background thread every
+// millisecond, for callers that can tolerate that error.
+class CoarseClock {
+ public:
+  constexpr inline static int64_t kResolutionUsecs = 1000;
+
+  // Wall-clock time, comparable with Timestamp::Now().
+  static Timestamp Now() noexcept;
+
+  // Monotonic time, comparable with MonotonicClock::Now().
+  static Timestamp Monotonic() noexcept;
+};
+
+}  // namespace pedrolib
+
+#endif  // PEDROLIB_CLOCK_H
@@ -0,0 +1,155 @@
+#ifndef PEDROLIB_COLLECTION_BLOCKING_QUEUE_H
+#define PEDROLIB_COLLECTION_BLOCKING_QUEUE_H
+
+#include <pedrolib/clock.h>
+#include <pedrolib/concurrent/backoff.h>
+#include <pedrolib/concurrent/futex.h>
+#include <pedrolib/duration.h>
+#include <pedrolib/noncopyable.h>
+#include <pedrolib/nonmovable.h>
+#include <atomic>
+#include <cstdint>
+#include <iterator>
+#include <utility>
+
+namespace pedrolib {
+
+// Adds blocking push and pop on top of BoundedMPMCQueue or SPSCQueue.
+// Threads spin briefly and then sleep on a futex; the other side only pays
+// for a wake-up syscall when somebody is actually asleep.
+template <typename Queue>
+class BlockingQueue : noncopyable, nonmovable {
+ public:
+  using value_type = typename Queue::value_type;
+
+ private:
+  struct alignas(64) Event {
+    std::atomic<uint32_t> seq{0};
+    std::atomic<uint32_t> waiters{0};
+
+    void Notify(int n) noexcept {
+      // Pairs with the fence in Wait: either the waiter sees our change to
+      // the queue or we see the waiter.
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      if (waiters.load(std::memory_order_relaxed) != 0) {
+        seq.fetch_add(1, std::memory_order_relaxed);
+        FutexWake(&seq, n);
+      }
+    }
+
+    // Waits until op() succeeds or the deadline (if any) passes.
+    template <typename Op>
+    bool Wait(Op&& op, const Timestamp* deadline) {
+      if (SpinUntil(op)) {
+        return true;
+      }
+
+      bool done = false;
+      waiters.fetch_add(1, std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      for (;;) {
+        uint32_t s = seq.load(std::memory_order_acquire);
+        if ((done = op())) {
+          break;
+        }
+        if (deadline == nullptr) {
+          FutexWait(&seq, s);
+          continue;
+        }
+        Duration left = *deadline - MonotonicClock::Now();
+        if (left <= Duration::Zero()) {
+          break;
+        }
+        FutexWait(&seq, s, left);
+      }
+      waiters.fetch_sub(1, std::memory_order_relaxed);
+      return done;
+    }
+  };
+
+  Queue queue_;
+  Event not_empty_;
+  Event not_full_;
+
+ public:
+  template <typename... Args>
+  explicit BlockingQueue(Args&&... args)
+      : queue_(std::forward<Args>(args)...) {}
+
+  Queue& queue() noexcept { return queue_; }
+
+  [[nodiscard]] size_t capacity() const noexcept { return queue_.capacity(); }
+
+  [[nodiscard]] size_t size_approx() const noexcept {
+    return queue_.size_approx();
+  }
+
+  template <typename U>
+  bool try_push(U&& value) {
+    if (!queue_.try_push(std::forward<U>(value))) {
+      return false;
+    }
+    not_empty_.Notify(1);
+    return true;
+  }
+
+  bool try_pop(value_type& value) {
+    if (!queue_.try_pop(value)) {
+      return false;
+    }
+    not_full_.Notify(1);
+    return true;
+  }
+
+  template <typename U>
+  void push(U&& value) {
+    not_full_.Wait([&] { return queue_.try_push(std::forward<U>(value)); },
+                   nullptr);
+    not_empty_.Notify(1);
+  }
+
+  void pop(value_type& value) {
+    not_empty_.Wait([&] { return queue_.try_pop(value); }, nullptr);
+    not_full_.Notify(1);
+  }
+
+  // Returns false if nothing could be popped before the timeout.
+  bool pop(value_type& value, const Duration& timeout) {
+    Timestamp deadline = MonotonicClock::Now() + timeout;
+    if (!not_empty_.Wait([&] { return queue_.try_pop(value); }, &deadline)) {
+      return false;
+    }
+    not_full_.Notify(1);
+    return true;
+  }
+
+  // Pushes all n values, blocking whenever the queue is full.
+  template <typename ForwardIt>
+  void push_n(ForwardIt first, size_t n) {
+    while (n != 0) {
+      size_t k = 0;
+      not_full_.Wait(
+          [&] { return (k = queue_.try_push_n(first, n)) != 0; }, nullptr);
+      std::advance(first, k);
+      n -= k;
+      not_empty_.Notify(static_cast<int>(k));
+    }
+  }
+
+  // Blocks until at least one value is available and pops up to n of them.
+  template <typename OutputIt>
+  size_t pop_n(OutputIt out, size_t n) {
+    if (n == 0) {
+      return 0;
+    }
+    size_t k = 0;
+    not_empty_.Wait([&] { return (k = queue_.try_pop_n(out, n)) != 0; },
+                    nullptr);
+    not_full_.Notify(static_cast<int>(k));
+    return k;
+  }
+};
+
+}  // namespace pedrolib
+
+#endif  // PEDROLIB_COLLECTION_BLOCKING_QUEUE_H
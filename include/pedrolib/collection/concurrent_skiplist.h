@@ -0,0 +1,351 @@
+#ifndef PEDROLIB_COLLECTION_CONCURRENT_SKIPLIST_H
+#define PEDROLIB_COLLECTION_CONCURRENT_SKIPLIST_H
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include "pedrolib/memory/arena.h"
+#include "pedrolib/noncopyable.h"
+#include "pedrolib/nonmovable.h"
+
+namespace pedrolib {
+
+namespace detail {
+
+struct SkipListIdentity {
+  template <typename T>
+  const T& operator()(const T& value) const noexcept {
+    return value;
+  }
+};
+
+struct SkipListFirst {
+  template <typename T>
+  const auto& operator()(const T& value) const noexcept {
+    return value.first;
+  }
+};
+
+// A lock-free, insert-only skiplist in the style of LevelDB's memtable.
+// Nodes live in an arena and are never unlinked, so readers need no
+// reclamation scheme: iterators stay valid and move forward safely while
+// other threads insert. An insert links its node bottom-up with one CAS
+// per level, re-searching only the level whose CAS lost. Elements cannot
+// be changed or erased once inserted.
+template <typename Key, typename Value, typename KeyOf, typename Compare>
+class SkipList : noncopyable, nonmovable {
+  static constexpr int kMaxHeight = 16;
+  // Each level holds a quarter of the nodes of the one below.
+  static constexpr uint32_t kBranching = 4;
+
+  struct Node {
+    alignas(Value) unsigned char storage[sizeof(Value)];
+    // height entries; only the first is declared.
+    std::atomic<Node*> next[1];
+
+    Value& value() noexcept { return *reinterpret_cast<Value*>(storage); }
+
+    Node* Next(int level) noexcept {
+      return next[level].load(std::memory_order_acquire);
+    }
+  };
+
+ public:
+  class iterator {
+    Node* node_{};
+
+    friend class SkipList;
+
+    explicit iterator(Node* node) : node_(node) {}
+
+   public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = Value;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const Value*;
+    using reference = const Value&;
+
+    iterator() = default;
+
+    reference operator*() const noexcept { return node_->value(); }
+
+    pointer operator->() const noexcept { return &node_->value(); }
+
+    iterator& operator++() noexcept {
+      node_ = node_->Next(0);
+      return *this;
+    }
+
+    iterator operator++(int) noexcept {
+      iterator it = *this;
+      ++*this;
+      return it;
+    }
+
+    bool operator==(const iterator& other) const noexcept {
+      return node_ == other.node_;
+    }
+
+    bool operator!=(const iterator& other) const noexcept {
+      return node_ != other.node_;
+    }
+  };
+
+  using const_iterator = iterator;
+
+ private:
+  Compare compare_;
+  Arena arena_;
+  Node* head_;
+  std::atomic<int> height_{1};
+  std::atomic<size_t> size_{0};
+
+  Node* allocate(int height) {
+    size_t size = sizeof(Node) + (height - 1) * sizeof(std::atomic<Node*>);
+    auto node = static_cast<Node*>(arena_.Allocate(size, alignof(Node)));
+    for (int i = 0; i < height; ++i) {
+      new (&node->next[i]) std::atomic<Node*>(nullptr);
+    }
+    return node;
+  }
+
+  static int randomHeight() noexcept {
+    thread_local uint64_t state =
+        reinterpret_cast<uintptr_t>(&state) * 0x9e3779b97f4a7c15 | 1;
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    int height = 1;
+    for (uint64_t r = state; height < kMaxHeight && r % kBranching == 0;
+         r /= kBranching) {
+      height++;
+    }
+    return height;
+  }
+
+  const Key& key(Node* node) const noexcept {
+    return KeyOf()(node->value());
+  }
+
+  // True if node is before key; the null end node is after everything.
+  bool before(Node* node, const Key& k) const {
+    return node != nullptr && compare_(key(node), k);
+  }
+
+  // Advances from x along level to the last node before k. bound is known
+  // not to be before k, usually the successor found one level up, which
+  // saves comparing (and loading) it again.
+  Node* seek(Node* x, int level, const Key& k, Node** succ,
+             Node* bound = nullptr) const {
+    Node* next = x->Next(level);
+    while (next != bound && before(next, k)) {
+      x = next;
+      next = x->Next(level);
+    }
+    *succ = next;
+    return x;
+  }
+
+  Node* lowerBound(const Key& k) const {
+    Node* x = head_;
+    Node* next = nullptr;
+    for (int level = height_.load(std::memory_order_relaxed) - 1; level >= 0;
+         --level) {
+      x = seek(x, level, k, &next, next);
+    }
+    return next;
+  }
+
+  bool equal(Node* node, const Key& k) const {
+    return node != nullptr && !compare_(k, key(node));
+  }
+
+  // Fills prev and succ with the neighbours of k below the current height,
+  // which it returns.
+  int search(const Key& k, Node** prev, Node** succ) const {
+    int height = height_.load(std::memory_order_relaxed);
+    Node* x = head_;
+    Node* bound = nullptr;
+    for (int level = height - 1; level >= 0; --level) {
+      x = seek(x, level, k, &succ[level], bound);
+      prev[level] = x;
+      bound = succ[level];
+    }
+    return height;
+  }
+
+  // Links node bottom-up, starting from the neighbours found by search.
+  std::pair<iterator, bool> link(Node* node, int height, int searched,
+                                 Node** prev, Node** succ) {
+    const Key& k = key(node);
+    int max_height = searched;
+    while (height > max_height &&
+           !height_.compare_exchange_weak(max_height, height,
+                                          std::memory_order_relaxed)) {
+    }
+    // Levels above the search may have gained nodes since, from inserts
+    // that raised the height first.
+    for (int level = searched; level < height; ++level) {
+      prev[level] = seek(head_, level, k, &succ[level]);
+    }
+
+    for (int level = 0; level < height; ++level) {
+      while (true) {
+        if (level == 0 && equal(succ[0], k)) {
+          // The node stays in the arena unused.
+          node->value().~Value();
+          return {iterator(succ[0]), false};
+        }
+        node->next[level].store(succ[level], std::memory_order_relaxed);
+        if (prev[level]->next[level].compare_exchange_strong(
+                succ[level], node, std::memory_order_release,
+                std::memory_order_acquire)) {
+          break;
+        }
+        // Another insert won this link; search on from prev.
+        prev[level] = seek(prev[level], level, k, &succ[level]);
+      }
+    }
+    size_.fetch_add(1, std::memory_order_relaxed);
+    return {iterator(node), true};
+  }
+
+ protected:
+  // Constructs the element only when k is absent at the time of the search.
+  template <typename... Args>
+  std::pair<iterator, bool> tryEmplace(const Key& k, Args&&... args) {
+    Node* prev[kMaxHeight];
+    Node* succ[kMaxHeight];
+    int searched = search(k, prev, succ);
+    if (equal(succ[0], k)) {
+      return {iterator(succ[0]), false};
+    }
+    int height = randomHeight();
+    Node* node = allocate(height);
+    new (node->storage) Value(std::forward<Args>(args)...);
+    return link(node, height, searched, prev, succ);
+  }
+
+ public:
+  using key_type = Key;
+  using value_type = Value;
+  using size_type = size_t;
+
+  explicit SkipList(Compare compare = Compare(), size_t arena_block = 64 << 10)
+      : compare_(std::move(compare)), arena_(arena_block),
+        head_(allocate(kMaxHeight)) {}
+
+  ~SkipList() {
+    if constexpr (!std::is_trivially_destructible_v<Value>) {
+      for (Node* x = head_->Next(0); x != nullptr; x = x->Next(0)) {
+        x->value().~Value();
+      }
+    }
+  }
+
+  // Constructs the element, then links it unless an equal key is present.
+  template <typename... Args>
+  std::pair<iterator, bool> emplace(Args&&... args) {
+    int height = randomHeight();
+    Node* node = allocate(height);
+    new (node->storage) Value(std::forward<Args>(args)...);
+    Node* prev[kMaxHeight];
+    Node* succ[kMaxHeight];
+    int searched = search(key(node), prev, succ);
+    return link(node, height, searched, prev, succ);
+  }
+
+  std::pair<iterator, bool> insert(const Value& value) {
+    return tryEmplace(KeyOf()(value), value);
+  }
+
+  std::pair<iterator, bool> insert(Value&& value) {
+    return tryEmplace(KeyOf()(value), std::move(value));
+  }
+
+  // The first element not before k.
+  [[nodiscard]] iterator lower_bound(const Key& k) const {
+    return iterator(lowerBound(k));
+  }
+
+  // The first element after k.
+  [[nodiscard]] iterator upper_bound(const Key& k) const {
+    Node* x = lowerBound(k);
+    return iterator(equal(x, k) ? x->Next(0) : x);
+  }
+
+  [[nodiscard]] iterator find(const Key& k) const {
+    Node* x = lowerBound(k);
+    return iterator(equal(x, k) ? x : nullptr);
+  }
+
+  [[nodiscard]] bool contains(const Key& k) const {
+    return equal(lowerBound(k), k);
+  }
+
+  [[nodiscard]] iterator begin() const noexcept {
+    return iterator(head_->Next(0));
+  }
+
+  [[nodiscard]] iterator end() const noexcept { return iterator(); }
+
+  // Exact when no insert is in progress.
+  [[nodiscard]] size_t size() const noexcept {
+    return size_.load(std::memory_order_relaxed);
+  }
+
+  [[nodiscard]] bool empty() const noexcept { return begin() == end(); }
+
+  [[nodiscard]] size_t memory_usage() const noexcept {
+    return arena_.MemoryUsage();
+  }
+
+  // True if every level is sorted. Walks the whole list; meant for tests.
+  [[nodiscard]] bool well_formed() const {
+    for (int level = 0; level < kMaxHeight; ++level) {
+      for (Node* x = head_->Next(level); x != nullptr; x = x->Next(level)) {
+        Node* next = x->Next(level);
+        if (next != nullptr && !compare_(key(x), key(next))) {
+          return false;
+        }
+      }
+    }
+    return true;
+  }
+};
+
+}  // namespace detail
+
+// An ordered map for concurrent inserts and lookups with range scans; see
+// detail::SkipList. Values are immutable once inserted; store atomics or
+// pointers for values that change.
+template <typename K, typename V, typename Compare = std::less<K>>
+class ConcurrentSkipListMap
+    : public detail::SkipList<K, std::pair<const K, V>, detail::SkipListFirst,
+                              Compare> {
+  using Base = detail::SkipList<K, std::pair<const K, V>,
+                                detail::SkipListFirst, Compare>;
+
+ public:
+  using mapped_type = V;
+  using Base::Base;
+  using Base::insert;
+
+  template <typename Value>
+  std::pair<typename Base::iterator, bool> insert(const K& key,
+                                                  Value&& value) {
+    return this->tryEmplace(key, key, std::forward<Value>(value));
+  }
+};
+
+template <typename K, typename Compare = std::less<K>>
+using ConcurrentSkipListSet =
+    detail::SkipList<K, K, detail::SkipListIdentity, Compare>;
+
+}  // namespace pedrolib
+
+#endif  // PEDROLIB_COLLECTION_CONCURRENT_SKIPLIST_H
@@ -0,0 +1,163 @@
+#ifndef PEDROLIB_COLLECTION_MPMC_QUEUE_H
+#define PEDROLIB_COLLECTION_MPMC_QUEUE_H
+
+#include <pedrolib/noncopyable.h>
+#include <pedrolib/nonmovable.h>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <utility>
+
+namespace pedrolib {
+
+// A bounded lock-free multi-producer multi-consumer ring (Dmitry Vyukov's
+// design). Every cell carries a sequence number telling whether it is ready
+// for the producer or the consumer of its lap, so producers and consumers
+// only contend on their own index.
+template <typename T>
+class BoundedMPMCQueue : noncopyable, nonmovable {
+  struct alignas(64) Cell {
+    std::atomic<size_t> seq;
+    alignas(T) unsigned char storage[sizeof(T)];
+
+    T* value() noexcept { return std::launder(reinterpret_cast<T*>(storage)); }
+  };
+
+  size_t mask_;
+  std::unique_ptr<Cell[]> cells_;
+  alignas(64) std::atomic<size_t> tail_{0};
+  alignas(64) std::atomic<size_t> head_{0};
+
+  static size_t RoundUpPowerOfTwo(size_t n) noexcept {
+    size_t r = 2;
+    while (r < n) {
+      r <<= 1;
+    }
+    return r;
+  }
+
+  // Claims up to n consecutive cells whose sequence equals pos + i + offset.
+  // Returns the first claimed position and the number of cells claimed.
+  std::pair<size_t, size_t> Claim(std::atomic<size_t>& index, size_t offset,
+                                  size_t n) noexcept {
+    size_t pos = index.load(std::memory_order_relaxed);
+    if (n == 0) {
+      return {pos, 0};
+    }
+    for (;;) {
+      size_t k = 0;
+      intptr_t diff = 0;
+      for (; k < n; ++k) {
+        Cell& cell = cells_[(pos + k) & mask_];
+        size_t seq = cell.seq.load(std::memory_order_acquire);
+        diff = static_cast<intptr_t>(seq - (pos + k + offset));
+        if (diff != 0) {
+          break;
+        }
+      }
+
+      if (k == 0) {
+        if (diff < 0) {
+          return {pos, 0};
+        }
+        // Another thread already took this cell; pos is stale.
+        pos = index.load(std::memory_order_relaxed);
+        continue;
+      }
+      if (index.compare_exchange_weak(pos, pos + k, std::memory_order_relaxed,
+                                      std::memory_order_relaxed)) {
+        return {pos, k};
+      }
+    }
+  }
+
+ public:
+  using value_type = T;
+
+  // The capacity is rounded up to a power of two.
+  explicit BoundedMPMCQueue(size_t capacity)
+      : mask_(RoundUpPowerOfTwo(capacity) - 1),
+        cells_(new Cell[mask_ + 1]) {
+    for (size_t i = 0; i <= mask_; ++i) {
+      cells_[i].seq.store(i, std::memory_order_relaxed);
+    }
+  }
+
+  ~BoundedMPMCQueue() {
+    size_t head = head_.load(std::memory_order_relaxed);
+    size_t tail = tail_.load(std::memory_order_relaxed);
+    for (; head != tail; ++head) {
+      std::destroy_at(cells_[head & mask_].value());
+    }
+  }
+
+  [[nodiscard]] size_t capacity() const noexcept { return mask_ + 1; }
+
+  // Only a hint while other threads are pushing or popping.
+  [[nodiscard]] size_t size_approx() const noexcept {
+    size_t tail = tail_.load(std::memory_order_relaxed);
+    size_t head = head_.load(std::memory_order_relaxed);
+    return static_cast<intptr_t>(tail - head) > 0 ? tail - head : 0;
+  }
+
+  template <typename... Args>
+  bool try_emplace(Args&&... args) {
+    auto [pos, n] = Claim(tail_, 0, 1);
+    if (n == 0) {
+      return false;
+    }
+    Cell& cell = cells_[pos & mask_];
+    new (cell.storage) T(std::forward<Args>(args)...);
+    cell.seq.store(pos + 1, std::memory_order_release);
+    return true;
+  }
+
+  template <typename U>
+  bool try_push(U&& value) {
+    return try_emplace(std::forward<U>(value));
+  }
+
+  bool try_pop(T& value) {
+    auto [pos, n] = Claim(head_, 1, 1);
+    if (n == 0) {
+      return false;
+    }
+    Cell& cell = cells_[pos & mask_];
+    value = std::move(*cell.value());
+    std::destroy_at(cell.value());
+    cell.seq.store(pos + mask_ + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Moves up to n values from first into the queue with a single claim of
+  // consecutive cells. Returns the number pushed.
+  template <typename InputIt>
+  size_t try_push_n(InputIt first, size_t n) {
+    auto [pos, k] = Claim(tail_, 0, n);
+    for (size_t i = 0; i < k; ++i, ++first) {
+      Cell& cell = cells_[(pos + i) & mask_];
+      new (cell.storage) T(std::move(*first));
+      cell.seq.store(pos + i + 1, std::memory_order_release);
+    }
+    return k;
+  }
+
+  // Pops up to n values into out. Returns the number popped.
+  template <typename OutputIt>
+  size_t try_pop_n(OutputIt out, size_t n) {
+    auto [pos, k] = Claim(head_, 1, n);
+    for (size_t i = 0; i < k; ++i, ++out) {
+      Cell& cell = cells_[(pos + i) & mask_];
+      *out = std::move(*cell.value());
+      std::destroy_at(cell.value());
+      cell.seq.store(pos + i + mask_ + 1, std::memory_order_release);
+    }
+    return k;
+  }
+};
+
+}  // namespace pedrolib
+
+#endif  // PEDROLIB_COLLECTION_MPMC_QUEUE_H
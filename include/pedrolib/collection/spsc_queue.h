@@ -0,0 +1,143 @@
+#ifndef PEDROLIB_COLLECTION_SPSC_QUEUE_H
+#define PEDROLIB_COLLECTION_SPSC_QUEUE_H
+
+#include <pedrolib/noncopyable.h>
+#include <pedrolib/nonmovable.h>
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <utility>
+
+namespace pedrolib {
+
+// A bounded wait-free single-producer single-consumer ring. Each side keeps
+// a cached copy of the other side's index and only rereads it when the ring
+// looks full (or empty), so the shared indices are touched rarely.
+template <typename T>
+class SPSCQueue : noncopyable, nonmovable {
+  struct Slot {
+    alignas(T) unsigned char storage[sizeof(T)];
+
+    T* value() noexcept { return std::launder(reinterpret_cast<T*>(storage)); }
+  };
+
+  size_t mask_;
+  std::unique_ptr<Slot[]> slots_;
+
+  alignas(64) std::atomic<size_t> tail_{0};
+  size_t head_cache_{0};
+
+  alignas(64) std::atomic<size_t> head_{0};
+  size_t tail_cache_{0};
+
+  static size_t RoundUpPowerOfTwo(size_t n) noexcept {
+    size_t r = 2;
+    while (r < n) {
+      r <<= 1;
+    }
+    return r;
+  }
+
+  // Free slots seen by the producer at tail.
+  size_t Writable(size_t tail, size_t n) noexcept {
+    size_t free = capacity() - (tail - head_cache_);
+    if (free < n) {
+      head_cache_ = head_.load(std::memory_order_acquire);
+      free = capacity() - (tail - head_cache_);
+    }
+    return std::min(free, n);
+  }
+
+  // Ready slots seen by the consumer at head.
+  size_t Readable(size_t head, size_t n) noexcept {
+    size_t ready = tail_cache_ - head;
+    if (ready < n) {
+      tail_cache_ = tail_.load(std::memory_order_acquire);
+      ready = tail_cache_ - head;
+    }
+    return std::min(ready, n);
+  }
+
+ public:
+  using value_type = T;
+
+  // The capacity is rounded up to a power of two.
+  explicit SPSCQueue(size_t capacity)
+      : mask_(RoundUpPowerOfTwo(capacity) - 1), slots_(new Slot[mask_ + 1]) {}
+
+  ~SPSCQueue() {
+    size_t head = head_.load(std::memory_order_relaxed);
+    size_t tail = tail_.load(std::memory_order_relaxed);
+    for (; head != tail; ++head) {
+      std::destroy_at(slots_[head & mask_].value());
+    }
+  }
+
+  [[nodiscard]] size_t capacity() const noexcept { return mask_ + 1; }
+
+  [[nodiscard]] size_t size_approx() const noexcept {
+    return tail_.load(std::memory_order_relaxed) -
+           head_.load(std::memory_order_relaxed);
+  }
+
+  template <typename... Args>
+  bool try_emplace(Args&&... args) {
+    size_t tail = tail_.load(std::memory_order_relaxed);
+    if (Writable(tail, 1) == 0) {
+      return false;
+    }
+    new (slots_[tail & mask_].storage) T(std::forward<Args>(args)...);
+    tail_.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  template <typename U>
+  bool try_push(U&& value) {
+    return try_emplace(std::forward<U>(value));
+  }
+
+  bool try_pop(T& value) {
+    size_t head = head_.load(std::memory_order_relaxed);
+    if (Readable(head, 1) == 0) {
+      return false;
+    }
+    T* slot = slots_[head & mask_].value();
+    value = std::move(*slot);
+    std::destroy_at(slot);
+    head_.store(head + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Moves up to n values from first into the queue and publishes them with a
+  // single store. Returns the number pushed.
+  template <typename InputIt>
+  size_t try_push_n(InputIt first, size_t n) {
+    size_t tail = tail_.load(std::memory_order_relaxed);
+    size_t k = Writable(tail, n);
+    for (size_t i = 0; i < k; ++i, ++first) {
+      new (slots_[(tail + i) & mask_].storage) T(std::move(*first));
+    }
+    tail_.store(tail + k, std::memory_order_release);
+    return k;
+  }
+
+  // Pops up to n values into out. Returns the number popped.
+  template <typename OutputIt>
+  size_t try_pop_n(OutputIt out, size_t n) {
+    size_t head = head_.load(std::memory_order_relaxed);
+    size_t k = Readable(head, n);
+    for (size_t i = 0; i < k; ++i, ++out) {
+      T* slot = slots_[(head + i) & mask_].value();
+      *out = std::move(*slot);
+      std::destroy_at(slot);
+    }
+    head_.store(head + k, std::memory_order_release);
+    return k;
+  }
+};
+
+}  // namespace pedrolib
+
+#endif  // PEDROLIB_COLLECTION_SPSC_QUEUE_H
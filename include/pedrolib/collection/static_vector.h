@@ -24,6 +24,9 @@ class StaticVector : pedrolib::nonmovable, pedrolib::noncopyable {
     data_ = decltype(data_)(static_cast<T*>(ptr), Deleter{});
   }
 
+  // Destroys the elements, last first, before their storage is freed.
+  ~StaticVector() { clear(); }
+
   template <typename... Args>
   T& emplace_back(Args&&... args) {
     return *new (&data()[size_++]) T(std::forward<Args>(args)...);
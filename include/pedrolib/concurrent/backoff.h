@@ -0,0 +1,53 @@
+#ifndef PEDROLIB_CONCURRENT_BACKOFF_H
+#define PEDROLIB_CONCURRENT_BACKOFF_H
+
+#include <cstdint>
+#include <thread>
+
+namespace pedrolib {
+
+inline void CpuRelax() noexcept {
+#if defined(__x86_64__) || defined(__i386__)
+  __builtin_ia32_pause();
+#elif defined(__aarch64__)
+  asm volatile("yield" ::: "memory");
+#endif
+}
+
+// Spins for a bounded number of iterations until pred() holds.
+template <typename Predicate>
+bool SpinUntil(Predicate&& pred, int spins = 128) {
+  for (int i = 0; i < spins; ++i) {
+    if (pred()) {
+      return true;
+    }
+    CpuRelax();
+  }
+  return pred();
+}
+
+// Exponential backoff for spin loops; yields the CPU once the spin count
+// saturates so oversubscribed spinners let the lock holder run.
+class Backoff {
+  constexpr static uint32_t kMaxSpins = 1024;
+
+  uint32_t spins_{1};
+
+ public:
+  void Pause() noexcept {
+    if (spins_ > kMaxSpins) {
+      std::this_thread::yield();
+      return;
+    }
+    for (uint32_t i = 0; i < spins_; ++i) {
+      CpuRelax();
+    }
+    spins_ <<= 1;
+  }
+
+  void Reset() noexcept { spins_ = 1; }
+};
+
+}  // namespace pedrolib
+
+#endif  // PEDROLIB_CONCURRENT_BACKOFF_H
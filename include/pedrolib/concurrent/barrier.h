@@ -0,0 +1,72 @@
+#ifndef PEDROLIB_CONCURRENT_BARRIER_H
+#define PEDROLIB_CONCURRENT_BARRIER_H
+
+#include <atomic>
+#include <functional>
+#include "pedrolib/concurrent/backoff.h"
+#include "pedrolib/concurrent/futex.h"
+#include "pedrolib/noncopyable.h"
+#include "pedrolib/nonmovable.h"
+
+namespace pedrolib {
+
+// A reusable barrier for a fixed number of parties. The last thread to arrive
+// in each phase runs the completion function before the others are released.
+class Barrier : noncopyable, nonmovable {
+  // The phase advances in steps of two; bit 0 is set once a party may be
+  // blocked on the current phase. Advancing and checking for sleepers is a
+  // single exchange, so the completing thread never touches the barrier
+  // after a released party could return and destroy it.
+  static constexpr uint32_t kWaiting = 1;
+  static constexpr uint32_t kPhase = 2;
+
+  const uint32_t parties_;
+  std::function<void()> completion_;
+  std::atomic<uint32_t> remaining_;
+  std::atomic<uint32_t> generation_{0};
+
+ public:
+  explicit Barrier(uint32_t parties, std::function<void()> completion = {})
+      : parties_(parties),
+        completion_(std::move(completion)),
+        remaining_(parties) {}
+
+  [[nodiscard]] uint32_t Parties() const noexcept { return parties_; }
+
+  // Returns true in the thread that completed the phase.
+  bool ArriveAndWait() {
+    uint32_t generation =
+        generation_.load(std::memory_order_acquire) & ~kWaiting;
+    if (remaining_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+      if (completion_) {
+        completion_();
+      }
+      remaining_.store(parties_, std::memory_order_relaxed);
+      if (generation_.exchange(generation + kPhase,
+                               std::memory_order_acq_rel) &
+          kWaiting) {
+        FutexWakeAll(&generation_);
+      }
+      return true;
+    }
+
+    auto passed = [&] {
+      return (generation_.load(std::memory_order_acquire) & ~kWaiting) !=
+             generation;
+    };
+    if (SpinUntil(passed)) {
+      return false;
+    }
+
+    while (!passed() &&
+           (generation_.fetch_or(kWaiting, std::memory_order_acq_rel) &
+            ~kWaiting) == generation) {
+      FutexWait(&generation_, generation | kWaiting);
+    }
+    return false;
+  }
+};
+
+}  // namespace pedrolib
+
+#endif  // PEDROLIB_CONCURRENT_BARRIER_H
@@ -0,0 +1,25 @@
+#ifndef PEDROLIB_CONCURRENT_FUTEX_H
+#define PEDROLIB_CONCURRENT_FUTEX_H
+
+#include <atomic>
+#include <cstdint>
+#include "pedrolib/duration.h"
+
+namespace pedrolib {
+
+// Sleeps while *word == expected. May return spuriously.
+void FutexWait(std::atomic<uint32_t>* word, uint32_t expected) noexcept;
+
+// Like FutexWait but gives up after timeout; returns false on timeout.
+bool FutexWait(std::atomic<uint32_t>* word, uint32_t expected,
+               const Duration& timeout) noexcept;
+
+void FutexWake(std::atomic<uint32_t>* word, int n) noexcept;
+
+inline void FutexWakeAll(std::atomic<uint32_t>* word) noexcept {
+  FutexWake(word, INT32_MAX);
+}
+
+}  // namespace pedrolib
+
+#endif  // PEDROLIB_CONCURRENT_FUTEX_H
@@ -1,62 +1,80 @@
 #ifndef PEDRODB_CONCURRENT_LATCH_H
 #define PEDRODB_CONCURRENT_LATCH_H
 #include <atomic>
-#include <condition_variable>
-#include <mutex>
+#include "pedrolib/clock.h"
+#include "pedrolib/concurrent/backoff.h"
+#include "pedrolib/concurrent/futex.h"
 #include "pedrolib/duration.h"
-#include "pedrolib/logger/logger.h"
+#include "pedrolib/noncopyable.h"
+#include "pedrolib/nonmovable.h"
 
 namespace pedrolib {
 
-class Latch {
+class Latch : noncopyable, nonmovable {
+  // Bit 0 is set on release, bit 1 once someone may be blocked. Waking
+  // depends only on the exchange that releases, so the last CountDown never
+  // touches the latch after a waiter could return and destroy it.
+  static constexpr uint32_t kReleased = 1;
+  static constexpr uint32_t kWaiting = 2;
+
   std::atomic_size_t count_;
-  std::mutex mu_;
-  std::condition_variable zero_;
+  std::atomic<uint32_t> state_;
+
+  bool released() const noexcept {
+    return state_.load(std::memory_order_acquire) & kReleased;
+  }
+
+  // Announces a waiter; false if already released.
+  bool prepare() noexcept {
+    return !(state_.fetch_or(kWaiting, std::memory_order_acq_rel) &
+             kReleased);
+  }
 
  public:
-  explicit Latch(size_t count) : count_(count) {}
+  explicit Latch(size_t count)
+      : count_(count), state_(count == 0 ? kReleased : 0) {}
 
   [[nodiscard]] size_t Count() const noexcept {
     return count_.load(std::memory_order_acquire);
   }
 
   void Await() {
-    std::unique_lock<std::mutex> lock(mu_);
-    while (count_.load(std::memory_order_relaxed)) {
-      zero_.wait(lock);
+    if (SpinUntil([this] { return released(); })) {
+      return;
+    }
+
+    while (prepare()) {
+      FutexWait(&state_, kWaiting);
     }
   }
 
   bool Await(const Duration& d) {
-    std::unique_lock<std::mutex> lock(mu_);
-    auto st = std::chrono::steady_clock::now();
-    auto et = st + std::chrono::microseconds(d.Microseconds());
-    while (count_.load(std::memory_order_relaxed)) {
-      auto now = std::chrono::steady_clock::now();
-      if (now <= et) {
+    if (SpinUntil([this] { return released(); })) {
+      return true;
+    }
+
+    Timestamp deadline = MonotonicClock::Now() + d;
+    while (prepare()) {
+      Duration left = deadline - MonotonicClock::Now();
+      if (left <= Duration::Zero()) {
         break;
       }
-      zero_.wait_until(lock, et);
+      FutexWait(&state_, kWaiting, left);
     }
-    return count_.load(std::memory_order_relaxed) == 0;
+    return released();
   }
 
   void CountDown() {
-    size_t x;
-    for (;;) {
-      size_t n = count_.load(std::memory_order::memory_order_acquire);
-      if (n == 0) {
-        x = n;
-        break;
-      }
-      x = n - 1;
-      if (count_.compare_exchange_strong(n, x, std::memory_order_release)) {
-        break;
-      }
+    size_t n = count_.load(std::memory_order_acquire);
+    while (n != 0 && !count_.compare_exchange_weak(
+                         n, n - 1, std::memory_order_acq_rel)) {
+    }
+    if (n != 1) {
+      return;
     }
-    if (x == 0) {
-      std::unique_lock<std::mutex> lock(mu_);
-      zero_.notify_all();
+
+    if (state_.exchange(kReleased, std::memory_order_acq_rel) & kWaiting) {
+      FutexWakeAll(&state_);
     }
   }
 };
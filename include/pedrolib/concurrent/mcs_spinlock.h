@@ -0,0 +1,79 @@
+#ifndef PEDROLIB_CONCURRENT_MCS_SPINLOCK_H
+#define PEDROLIB_CONCURRENT_MCS_SPINLOCK_H
+
+#include <atomic>
+#include "pedrolib/concurrent/backoff.h"
+#include "pedrolib/noncopyable.h"
+#include "pedrolib/nonmovable.h"
+
+namespace pedrolib {
+
+// A queue lock where every waiter spins on its own node, so a release only
+// touches the cache line of the next waiter. The node must stay alive and
+// untouched between lock and unlock; Guard keeps it on the stack. Prefer
+// SpinLock when threads may outnumber cores.
+class MCSSpinLock : noncopyable, nonmovable {
+ public:
+  struct alignas(64) Node {
+    std::atomic<Node*> next{nullptr};
+    std::atomic_bool locked{false};
+  };
+
+  class Guard : noncopyable, nonmovable {
+    MCSSpinLock* lock_;
+    Node node_;
+
+   public:
+    explicit Guard(MCSSpinLock& lock) : lock_(&lock) { lock_->lock(&node_); }
+    ~Guard() { lock_->unlock(&node_); }
+  };
+
+ private:
+  std::atomic<Node*> tail_{nullptr};
+
+ public:
+  void lock(Node* node) noexcept {
+    node->next.store(nullptr, std::memory_order_relaxed);
+    node->locked.store(true, std::memory_order_relaxed);
+
+    Node* prev = tail_.exchange(node, std::memory_order_acq_rel);
+    if (prev == nullptr) {
+      return;
+    }
+
+    prev->next.store(node, std::memory_order_release);
+    Backoff backoff;
+    while (node->locked.load(std::memory_order_acquire)) {
+      backoff.Pause();
+    }
+  }
+
+  bool try_lock(Node* node) noexcept {
+    node->next.store(nullptr, std::memory_order_relaxed);
+    Node* expected = nullptr;
+    return tail_.compare_exchange_strong(expected, node,
+                                         std::memory_order_acq_rel,
+                                         std::memory_order_relaxed);
+  }
+
+  void unlock(Node* node) noexcept {
+    Node* next = node->next.load(std::memory_order_acquire);
+    if (next == nullptr) {
+      Node* expected = node;
+      if (tail_.compare_exchange_strong(expected, nullptr,
+                                        std::memory_order_release,
+                                        std::memory_order_relaxed)) {
+        return;
+      }
+      // A successor swapped itself in but has not linked to us yet.
+      while ((next = node->next.load(std::memory_order_acquire)) == nullptr) {
+        CpuRelax();
+      }
+    }
+    next->locked.store(false, std::memory_order_release);
+  }
+};
+
+}  // namespace pedrolib
+
+#endif  // PEDROLIB_CONCURRENT_MCS_SPINLOCK_H
@@ -0,0 +1,80 @@
+#ifndef PEDROLIB_CONCURRENT_RW_SPINLOCK_H
+#define PEDROLIB_CONCURRENT_RW_SPINLOCK_H
+
+#include <atomic>
+#include <cstdint>
+#include "pedrolib/concurrent/backoff.h"
+#include "pedrolib/noncopyable.h"
+#include "pedrolib/nonmovable.h"
+
+namespace pedrolib {
+
+// A writer-preferring reader-writer spin lock, usable with std::unique_lock
+// and std::shared_lock. A waiting writer blocks new readers so it cannot be
+// starved.
+class RWSpinLock : noncopyable, nonmovable {
+  constexpr static uint32_t kWriter = 1;
+  constexpr static uint32_t kPending = 2;
+  constexpr static uint32_t kReader = 4;
+
+  std::atomic<uint32_t> state_{0};
+
+ public:
+  void lock() noexcept {
+    Backoff backoff;
+    for (;;) {
+      uint32_t s = state_.load(std::memory_order_relaxed);
+      if ((s & ~kPending) == 0) {
+        if (state_.compare_exchange_weak(s, kWriter,
+                                         std::memory_order_acquire,
+                                         std::memory_order_relaxed)) {
+          return;
+        }
+        continue;
+      }
+      if (!(s & kPending)) {
+        state_.fetch_or(kPending, std::memory_order_relaxed);
+      }
+      backoff.Pause();
+    }
+  }
+
+  bool try_lock() noexcept {
+    uint32_t s = state_.load(std::memory_order_relaxed);
+    return (s & ~kPending) == 0 &&
+           state_.compare_exchange_strong(s, kWriter,
+                                          std::memory_order_acquire,
+                                          std::memory_order_relaxed);
+  }
+
+  void unlock() noexcept {
+    state_.fetch_and(~kWriter, std::memory_order_release);
+  }
+
+  void lock_shared() noexcept {
+    Backoff backoff;
+    while (!try_lock_shared()) {
+      backoff.Pause();
+    }
+  }
+
+  bool try_lock_shared() noexcept {
+    uint32_t s = state_.load(std::memory_order_relaxed);
+    while (!(s & (kWriter | kPending))) {
+      if (state_.compare_exchange_weak(s, s + kReader,
+                                       std::memory_order_acquire,
+                                       std::memory_order_relaxed)) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  void unlock_shared() noexcept {
+    state_.fetch_sub(kReader, std::memory_order_release);
+  }
+};
+
+}  // namespace pedrolib
+
+#endif  // PEDROLIB_CONCURRENT_RW_SPINLOCK_H
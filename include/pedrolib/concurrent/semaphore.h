@@ -0,0 +1,95 @@
+#ifndef PEDROLIB_CONCURRENT_SEMAPHORE_H
+#define PEDROLIB_CONCURRENT_SEMAPHORE_H
+
+#include <atomic>
+#include "pedrolib/clock.h"
+#include "pedrolib/concurrent/backoff.h"
+#include "pedrolib/concurrent/futex.h"
+#include "pedrolib/duration.h"
+#include "pedrolib/noncopyable.h"
+#include "pedrolib/nonmovable.h"
+
+namespace pedrolib {
+
+class Semaphore : noncopyable, nonmovable {
+  // Permits are kept above bit 0, which is set once an acquirer may be
+  // blocked. Release adds permits and clears the bit in one exchange, so it
+  // never touches the semaphore after a woken acquirer could destroy it.
+  static constexpr uint32_t kWaiting = 1;
+  static constexpr uint32_t kPermit = 2;
+
+  std::atomic<uint32_t> count_;
+
+  // Announces a blocked acquirer; returns the word to sleep on, or 0 if
+  // permits became available meanwhile.
+  uint32_t prepare() noexcept {
+    uint32_t v = count_.fetch_or(kWaiting, std::memory_order_acq_rel);
+    return v >= kPermit ? 0 : (v | kWaiting);
+  }
+
+ public:
+  explicit Semaphore(uint32_t count) : count_(count * kPermit) {}
+
+  [[nodiscard]] uint32_t Available() const noexcept {
+    return count_.load(std::memory_order_relaxed) / kPermit;
+  }
+
+  bool TryAcquire() noexcept {
+    uint32_t v = count_.load(std::memory_order_relaxed);
+    while (v >= kPermit) {
+      if (count_.compare_exchange_weak(v, v - kPermit,
+                                       std::memory_order_acquire,
+                                       std::memory_order_relaxed)) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  void Acquire() {
+    if (SpinUntil([this] { return TryAcquire(); })) {
+      return;
+    }
+
+    while (!TryAcquire()) {
+      if (uint32_t v = prepare()) {
+        FutexWait(&count_, v);
+      }
+    }
+  }
+
+  bool TryAcquire(const Duration& d) {
+    if (SpinUntil([this] { return TryAcquire(); })) {
+      return true;
+    }
+
+    Timestamp deadline = MonotonicClock::Now() + d;
+    while (!TryAcquire()) {
+      Duration left = deadline - MonotonicClock::Now();
+      if (left <= Duration::Zero()) {
+        return false;
+      }
+      if (uint32_t v = prepare()) {
+        FutexWait(&count_, v, left);
+      }
+    }
+    return true;
+  }
+
+  // Clearing the waiting bit wakes every sleeper; those that lose the race
+  // for the new permits announce themselves again before sleeping.
+  void Release(uint32_t n = 1) {
+    uint32_t v = count_.load(std::memory_order_relaxed);
+    while (!count_.compare_exchange_weak(v, (v + n * kPermit) & ~kWaiting,
+                                         std::memory_order_acq_rel,
+                                         std::memory_order_relaxed)) {
+    }
+    if (v & kWaiting) {
+      FutexWakeAll(&count_);
+    }
+  }
+};
+
+}  // namespace pedrolib
+
+#endif  // PEDROLIB_CONCURRENT_SEMAPHORE_H
@@ -1,24 +1,33 @@
 #ifndef PEDROLIB_CONCURRENT_SPINLOCK_H
 #define PEDROLIB_CONCURRENT_SPINLOCK_H
 
-#include <pthread.h>
 #include <atomic>
-#include <thread>
+#include "pedrolib/concurrent/backoff.h"
+#include "pedrolib/noncopyable.h"
+#include "pedrolib/nonmovable.h"
 
 namespace pedrolib {
-class SpinLock {
-  pthread_spinlock_t actual_{};
 
- public:
-  SpinLock() { pthread_spin_init(&actual_, PTHREAD_PROCESS_PRIVATE); }
-
-  ~SpinLock() { pthread_spin_destroy(&actual_); }
+// Test-and-test-and-set lock with exponential backoff.
+class SpinLock : noncopyable, nonmovable {
+  std::atomic_bool locked_{false};
 
-  void lock() noexcept { pthread_spin_lock(&actual_); }
+ public:
+  void lock() noexcept {
+    Backoff backoff;
+    while (locked_.exchange(true, std::memory_order_acquire)) {
+      while (locked_.load(std::memory_order_relaxed)) {
+        backoff.Pause();
+      }
+    }
+  }
 
-  bool try_lock() noexcept { return pthread_spin_trylock(&actual_); }
+  bool try_lock() noexcept {
+    return !locked_.load(std::memory_order_relaxed) &&
+           !locked_.exchange(true, std::memory_order_acquire);
+  }
 
-  void unlock() noexcept { pthread_spin_unlock(&actual_); }
+  void unlock() noexcept { locked_.store(false, std::memory_order_release); }
 };
 }  // namespace pedrolib
 #endif  // PEDROLIB_CONCURRENT_SPINLOCK_H
@@ -0,0 +1,53 @@
+#ifndef PEDROLIB_CONCURRENT_TICKET_SPINLOCK_H
+#define PEDROLIB_CONCURRENT_TICKET_SPINLOCK_H
+
+#include <atomic>
+#include <cstdint>
+#include "pedrolib/concurrent/backoff.h"
+#include "pedrolib/noncopyable.h"
+#include "pedrolib/nonmovable.h"
+
+namespace pedrolib {
+
+// A FIFO spin lock: threads take a ticket and wait until it is served.
+// Like any queue lock it degrades badly when threads outnumber cores, since
+// a preempted waiter stalls everyone queued behind it.
+class TicketSpinLock : noncopyable, nonmovable {
+  alignas(64) std::atomic<uint32_t> next_{0};
+  alignas(64) std::atomic<uint32_t> serving_{0};
+
+ public:
+  void lock() noexcept {
+    uint32_t ticket = next_.fetch_add(1, std::memory_order_relaxed);
+    Backoff backoff;
+    for (;;) {
+      uint32_t serving = serving_.load(std::memory_order_acquire);
+      if (serving == ticket) {
+        return;
+      }
+      // Waiters further back in the queue poll less often.
+      for (uint32_t i = ticket - serving; i > 1; --i) {
+        CpuRelax();
+      }
+      backoff.Pause();
+    }
+  }
+
+  bool try_lock() noexcept {
+    // Acquire pairs with unlock, which releases through serving_ only.
+    uint32_t serving = serving_.load(std::memory_order_acquire);
+    uint32_t ticket = serving;
+    return next_.compare_exchange_strong(ticket, serving + 1,
+                                         std::memory_order_acquire,
+                                         std::memory_order_relaxed);
+  }
+
+  void unlock() noexcept {
+    uint32_t serving = serving_.load(std::memory_order_relaxed);
+    serving_.store(serving + 1, std::memory_order_release);
+  }
+};
+
+}  // namespace pedrolib
+
+#endif  // PEDROLIB_CONCURRENT_TICKET_SPINLOCK_H
@@ -0,0 +1,199 @@
+#ifndef PEDROLIB_EVENT_EVENT_LOOP_H
+#define PEDROLIB_EVENT_EVENT_LOOP_H
+
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "pedrolib/collection/static_vector.h"
+#include "pedrolib/executor/executor.h"
+#include "pedrolib/file/file.h"
+
+namespace pedrolib {
+
+// Readiness bits passed to Register and reported to handlers.
+enum EventMask : uint32_t {
+  kReadable = 1 << 0,
+  kWritable = 1 << 1,
+  // Reported only: the peer closed its end or the descriptor failed.
+  kHangup = 1 << 2,
+  kFailed = 1 << 3,
+};
+
+enum class Trigger { kLevel, kEdge };
+
+using EventHandler = std::function<void(uint32_t events)>;
+
+namespace detail {
+
+struct Channel {
+  int fd{File::kInvalid};
+  EventHandler handler;
+  // Set by Unregister on any thread and checked before each dispatch.
+  std::atomic_bool removed{false};
+};
+
+struct LoopTimer {
+  Duration interval;
+  Callback callback;
+};
+
+struct LoopTimerEntry {
+  Timestamp expired;
+  uint64_t id{};
+
+  bool operator<(const LoopTimerEntry& other) const noexcept {
+    return expired > other.expired;
+  }
+};
+
+// Lives on the loop thread's stack. A loop destroyed by one of its own
+// callbacks sets destroyed and hands over its channels, since the running
+// handler may belong to one of them; the thread returns as soon as the
+// callback does and frees them on the way out.
+struct LoopExit {
+  bool destroyed{false};
+  std::vector<Channel*> channels;
+
+  ~LoopExit() {
+    for (Channel* channel : channels) {
+      delete channel;
+    }
+  }
+};
+
+}  // namespace detail
+
+// A reactor on one thread: waits on epoll for registered descriptors and
+// runs their handlers, tasks and timers on that thread. Scheduling from
+// another thread wakes the loop through an eventfd; timers share a single
+// timerfd armed for the earliest deadline.
+class EventLoop : public Executor {
+  int epoll_fd_{File::kInvalid};
+  int wakeup_fd_{File::kInvalid};
+  int timer_fd_{File::kInvalid};
+
+  std::atomic_bool closed_{false};
+  // Set while a wakeup is pending so producers write the eventfd once.
+  std::atomic_bool notified_{false};
+
+  std::mutex mu_;
+  std::vector<Callback> tasks_;
+  std::unordered_map<int, detail::Channel*> channels_;
+  // Unregistered channels, freed by the loop after its current batch or by
+  // the destructor once the loop has stopped.
+  std::vector<detail::Channel*> removed_;
+
+  // Owned by the loop thread.
+  std::vector<detail::LoopTimerEntry> timers_;
+  std::unordered_map<uint64_t, detail::LoopTimer> timer_callbacks_;
+  Timestamp armed_;
+
+  std::atomic<uint64_t> timer_ids_{1};
+  std::thread thread_;
+  detail::LoopExit* exit_{};
+
+  void wakeup() noexcept;
+
+  void run_tasks();
+
+  void run_timers();
+
+  void arm();
+
+  void add_timer(uint64_t id, Timestamp expired);
+
+  uint64_t schedule(Duration delay, Duration interval, Callback cb);
+
+  void loop();
+
+ public:
+  EventLoop();
+
+  // May run on the loop thread, from a handler, task or timer: the thread
+  // is then detached and stops once that callback returns.
+  ~EventLoop() override;
+
+  // True on the loop thread, where handlers, tasks and timers run.
+  [[nodiscard]] bool InLoop() const noexcept {
+    return std::this_thread::get_id() == thread_.get_id();
+  }
+
+  // Watches file for the events in mask; handler runs on the loop thread.
+  // The file must stay open until it is unregistered.
+  Error Register(const File& file, uint32_t mask, Trigger trigger,
+                 EventHandler handler);
+
+  Error Modify(const File& file, uint32_t mask, Trigger trigger);
+
+  // No handler call starts after Unregister returns. Called from another
+  // thread, it does not wait for a call that has already started, which may
+  // still be running when it returns.
+  Error Unregister(const File& file);
+
+  size_t Size() const noexcept override { return 1; }
+
+  using Executor::Schedule;
+
+  void Schedule(Callback cb) override;
+
+  using Executor::ScheduleBatch;
+
+  void ScheduleBatch(Callback* cbs, size_t n, Priority priority) override;
+
+  uint64_t ScheduleAfter(Duration delay, Callback cb) override;
+
+  uint64_t ScheduleEvery(Duration delay, Duration interval,
+                         Callback cb) override;
+
+  void ScheduleCancel(uint64_t id) override;
+
+  // Stops the loop after it has run the tasks already scheduled.
+  void Close() override;
+
+  // Does nothing on the loop thread, which cannot wait for itself.
+  void Join() override;
+};
+
+// One loop per core. Descriptors are spread over the loops round-robin and
+// stay on their loop until unregistered.
+class EventLoopGroup : noncopyable, nonmovable {
+  StaticVector<EventLoop> loops_;
+  std::atomic<size_t> next_{0};
+
+  std::mutex mu_;
+  std::unordered_map<int, EventLoop*> assigned_;
+
+ public:
+  explicit EventLoopGroup(size_t n = std::thread::hardware_concurrency());
+
+  ~EventLoopGroup();
+
+  [[nodiscard]] size_t Size() const noexcept { return loops_.size(); }
+
+  EventLoop& operator[](size_t index) noexcept { return loops_[index]; }
+
+  // The next loop in round-robin order.
+  EventLoop& Next() noexcept {
+    return loops_[next_.fetch_add(1, std::memory_order_relaxed) %
+                  loops_.size()];
+  }
+
+  // Registers file on the next loop; the handler always runs there.
+  Error Register(const File& file, uint32_t mask, Trigger trigger,
+                 EventHandler handler, EventLoop** loop = nullptr);
+
+  Error Modify(const File& file, uint32_t mask, Trigger trigger);
+
+  Error Unregister(const File& file);
+
+  void Close();
+
+  void Join();
+};
+
+}  // namespace pedrolib
+
+#endif  // PEDROLIB_EVENT_EVENT_LOOP_H
@@ -7,16 +7,36 @@
 #include "pedrolib/nonmovable.h"
 #include "pedrolib/timestamp.h"
 
+#include <algorithm>
 #include <functional>
+#include <vector>
 
 namespace pedrolib {
 
 using Callback = std::function<void()>;
 
+// Lanes an executor may keep separately so latency-sensitive work is not
+// queued behind background work.
+enum class Priority : uint8_t { kHigh, kNormal, kLow };
+
+constexpr size_t kPriorities = 3;
+
 struct Executor : noncopyable, nonmovable {
   Executor() = default;
   virtual ~Executor() = default;
   virtual void Schedule(Callback cb) = 0;
+  // Executors without lanes run every task at the same priority.
+  virtual void Schedule(Callback cb, Priority) { Schedule(std::move(cb)); }
+  // Schedules n callbacks, moving them out of cbs. Executors that can
+  // enqueue them all at once should override this.
+  virtual void ScheduleBatch(Callback* cbs, size_t n, Priority priority) {
+    for (size_t i = 0; i < n; ++i) {
+      Schedule(std::move(cbs[i]), priority);
+    }
+  }
+  void ScheduleBatch(Callback* cbs, size_t n) {
+    ScheduleBatch(cbs, n, Priority::kNormal);
+  }
   virtual uint64_t ScheduleAfter(Duration delay, Callback cb) = 0;
   virtual uint64_t ScheduleEvery(Duration delay, Duration interval,
                                  Callback cb) = 0;
@@ -34,16 +54,19 @@ void for_each(Executor* executor, Iterator begin, Iterator end, Task&& task) {
   size_t t = n % p;
 
   Latch latch(p);
+  std::vector<Callback> chunks;
+  chunks.reserve(p);
   Iterator last = begin;
   for (size_t i = 0; i < p; ++i) {
     Iterator first = last;
     Iterator next = first + m + (i < t);
     last = next;
-    executor->Schedule([&, first, next, task] {
+    chunks.emplace_back([&, first, next, task] {
       std::for_each(first, next, task);
       latch.CountDown();
     });
   }
+  executor->ScheduleBatch(chunks.data(), chunks.size());
   latch.Await();
 }
 
@@ -55,18 +78,21 @@ void for_each(Executor* executor, size_t begin, size_t end, Task&& task) {
   size_t t = n % p;
 
   Latch latch(p);
+  std::vector<Callback> chunks;
+  chunks.reserve(p);
   size_t last = begin;
   for (size_t i = 0; i < p; ++i) {
     size_t first = last;
     size_t next = first + m + (i < t);
     last = next;
-    executor->Schedule([&, first, next, task] {
+    chunks.emplace_back([&, first, next, task] {
       for (size_t j = first; j != next; ++j) {
         task(j);
       }
       latch.CountDown();
     });
   }
+  executor->ScheduleBatch(chunks.data(), chunks.size());
   latch.Await();
 }
 
@@ -0,0 +1,55 @@
+#ifndef PEDROLIB_EXECUTOR_KEYED_EXECUTOR_H
+#define PEDROLIB_EXECUTOR_KEYED_EXECUTOR_H
+
+#include <algorithm>
+#include <functional>
+#include "pedrolib/collection/static_vector.h"
+#include "pedrolib/executor/serial_executor.h"
+
+namespace pedrolib {
+
+// Spreads keys over a fixed set of strands: tasks for the same key run in
+// order and never concurrently, while different keys run in parallel on
+// the parent executor.
+template <typename Key, typename Hash = std::hash<Key>>
+class KeyedExecutor : noncopyable, nonmovable {
+  StaticVector<SerialExecutor> strands_;
+  Hash hash_;
+
+ public:
+  // At least one strand, even over a parent that reports no workers.
+  KeyedExecutor(Executor* parent, size_t strands,
+                Priority priority = Priority::kNormal)
+      : strands_(std::max<size_t>(strands, 1)) {
+    for (size_t i = 0; i < strands_.capacity(); ++i) {
+      strands_.emplace_back(parent, priority);
+    }
+  }
+
+  // Four strands per parent worker keeps collisions between hot keys rare.
+  explicit KeyedExecutor(Executor* parent)
+      : KeyedExecutor(parent, 4 * parent->Size()) {}
+
+  SerialExecutor& Strand(const Key& key) {
+    return strands_[hash_(key) % strands_.size()];
+  }
+
+  void Schedule(const Key& key, Callback cb) {
+    Strand(key).Schedule(std::move(cb));
+  }
+
+  uint64_t ScheduleAfter(const Key& key, Duration delay, Callback cb) {
+    return Strand(key).ScheduleAfter(delay, std::move(cb));
+  }
+
+  // Waits for every strand to run out of tasks.
+  void Join() {
+    for (auto& strand : strands_) {
+      strand.Join();
+    }
+  }
+};
+
+}  // namespace pedrolib
+
+#endif  // PEDROLIB_EXECUTOR_KEYED_EXECUTOR_H
@@ -0,0 +1,92 @@
+#ifndef PEDROLIB_EXECUTOR_SERIAL_EXECUTOR_H
+#define PEDROLIB_EXECUTOR_SERIAL_EXECUTOR_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "pedrolib/executor/executor.h"
+
+namespace pedrolib {
+
+// A strand: runs its tasks one at a time and in submission order on top of
+// another executor, without a lock. Submitting is a wait-free push onto an
+// MPSC queue; the first push into an empty strand schedules a drain on the
+// parent, which runs up to kBatch tasks before yielding the worker back.
+class SerialExecutor : public Executor {
+  struct Node {
+    std::atomic<Node*> next{nullptr};
+    Callback callback;
+  };
+
+  // Timer callbacks run on the parent and may fire after the strand is
+  // gone, so they reach it through this handle, which Close detaches.
+  struct Timers {
+    std::mutex mu;
+    SerialExecutor* strand{};
+    // Periodic timers still registered on the parent.
+    std::vector<uint64_t> periodic;
+  };
+
+  constexpr static uint32_t kBatch = 64;
+  // Set in pending_ by Join before it sleeps; the drain that empties the
+  // strand clears it with the count and wakes Join from that one update.
+  constexpr static uint32_t kWaiting = uint32_t{1} << 31;
+
+  Executor* parent_;
+  Priority priority_;
+
+  // tail_ is a consumed node whose successor holds the oldest task.
+  alignas(64) std::atomic<Node*> head_;
+  alignas(64) Node* tail_;
+
+  std::atomic<uint32_t> pending_{0};
+  std::atomic_bool closed_{false};
+  std::shared_ptr<Timers> timers_;
+
+  void push(Node* node) noexcept;
+
+  Callback pop() noexcept;
+
+  void drain();
+
+ public:
+  explicit SerialExecutor(Executor* parent,
+                          Priority priority = Priority::kNormal);
+
+  // Waits for queued tasks; the parent must still be running.
+  ~SerialExecutor() override;
+
+  // Tasks never run concurrently.
+  size_t Size() const noexcept override { return 1; }
+
+  void Schedule(Callback cb) override;
+
+  // The strand keeps submission order, so the priority applies to the
+  // whole strand and is fixed at construction.
+  void Schedule(Callback cb, Priority) override { Schedule(std::move(cb)); }
+
+  using Executor::ScheduleBatch;
+
+  // Pushes every callback and schedules at most one drain.
+  void ScheduleBatch(Callback* cbs, size_t n, Priority) override;
+
+  // The timer runs on the parent and hands the task to the strand.
+  uint64_t ScheduleAfter(Duration delay, Callback cb) override;
+
+  uint64_t ScheduleEvery(Duration delay, Duration interval,
+                         Callback cb) override;
+
+  void ScheduleCancel(uint64_t id) override;
+
+  // Drops tasks submitted afterwards and cancels the strand's timers.
+  void Close() override;
+
+  // Waits until every accepted task has run.
+  void Join() override;
+};
+
+}  // namespace pedrolib
+
+#endif  // PEDROLIB_EXECUTOR_SERIAL_EXECUTOR_H
@@ -3,21 +3,62 @@
 #include <atomic>
 #include <condition_variable>
 #include <deque>
+#include <list>
 #include <mutex>
-#include <queue>
 #include <thread>
-#include "pedrolib/collection/static_vector.h"
+#include <vector>
+#include "pedrolib/clock.h"
 #include "pedrolib/executor/executor.h"
+#include "pedrolib/format/formatter.h"
+#include "pedrolib/metric/histogram.h"
 namespace pedrolib {
 
+struct LaneStats {
+  uint32_t weight{};
+  uint64_t scheduled{};
+  uint64_t executed{};
+  size_t pending{};
+  // Time from Schedule to the start of execution, in microseconds.
+  HistogramSnapshot queue_wait;
+
+  [[nodiscard]] std::string String() const;
+};
+
 namespace detail {
-struct PriorityCallback {
-  uint64_t id{};
-  Timestamp expired;
+
+// A slab slot for a delayed or periodic task. state packs the slot's
+// generation (high 32 bits) with its status (low 32 bits); task ids carry
+// the same generation, so a stale id never matches a reused slot.
+struct TimerSlot {
+  enum Status : uint32_t { kFree, kScheduled, kRunning, kCanceled };
+
+  std::atomic<uint64_t> state{uint64_t{1} << 32};
   Duration interval;
-  std::weak_ptr<Callback> callback;
+  Callback callback;
+};
 
-  bool operator<(const PriorityCallback& other) const noexcept {
+struct ReadyTask {
+  Callback callback;
+  Timestamp enqueued;
+};
+
+// One priority class. Lanes are picked by smooth weighted round-robin, so
+// each gets a share of dispatches proportional to its weight and a backlog
+// in one lane never blocks another.
+struct Lane {
+  std::deque<ReadyTask> tasks;
+  uint32_t weight{1};
+  int64_t current{};
+  uint64_t scheduled{};
+  uint64_t executed{};
+  Histogram queue_wait;
+};
+
+struct TimerEntry {
+  Timestamp expired;
+  uint64_t id{};
+
+  bool operator<(const TimerEntry& other) const noexcept {
     return expired > other.expired;
   }
 };
@@ -25,152 +66,175 @@ struct PriorityCallback {
 }  // namespace detail
 
 class ThreadPoolExecutor : public Executor {
+ public:
+  struct Options {
+    // Workers kept alive even when idle; at least one.
+    size_t min_threads{std::thread::hardware_concurrency()};
+    // Upper bound for workers spawned under load or to replace workers
+    // that are blocked. Equal to min_threads for a fixed-size pool.
+    size_t max_threads{std::thread::hardware_concurrency()};
+    // Workers above min_threads exit after being idle this long.
+    Duration keep_alive{Duration::Seconds(60)};
+    // A worker is added when no worker is idle and the oldest ready task
+    // has waited longer than this.
+    Duration max_queue_delay{Duration::Milliseconds(1)};
+  };
+
+ private:
+  friend class BlockingScope;
+
+  constexpr static int kChunkBits = 12;
+  constexpr static size_t kChunkSize = size_t{1} << kChunkBits;
+  constexpr static size_t kMaxChunks = 1024;
+
+  inline static thread_local ThreadPoolExecutor* current_{};
+
+  Options options_;
+
   std::mutex mu_;
   std::atomic_bool shutdown_{false};
-  StaticVector<std::thread> workers_;
+  // Live workers; a worker moves itself to exited_ under mu_ as its last
+  // step, so only join() and spawn() join threads and only from exited_.
+  std::list<std::thread> threads_;
+  std::list<std::thread> exited_;
+  std::atomic<size_t> workers_{};
+  size_t idle_{};
+  size_t blocking_{};
 
   std::condition_variable non_empty_;
-
-  std::priority_queue<detail::PriorityCallback> queue_;
-  std::unordered_map<uint64_t, std::shared_ptr<Callback>> callbacks_;
-  uint64_t id_{};
-
-  void worker() {
-    while (!shutdown_.load(std::memory_order_acquire)) {
-      std::unique_lock<std::mutex> lock(mu_);
-      while (true) {
-        if (shutdown_.load(std::memory_order_acquire)) {
-          return;
-        }
-        if (queue_.empty()) {
-          non_empty_.wait(lock);
-          continue;
-        }
-        auto& top = queue_.top();
-        Duration d = top.expired - Timestamp::Now();
-        if (d <= Duration::Microseconds(100)) {
-          break;
-        }
-        non_empty_.wait_for(lock, std::chrono::microseconds(d.usecs));
-      }
-
-      auto top = queue_.top();
-      queue_.pop();
-
-      if (top.callback.expired()) {
-        continue;
-      }
-
-      auto callback = top.callback.lock();
-      if (callback == nullptr) {
-        continue;
-      }
-
-      if (top.interval != Duration::Zero()) {
-        detail::PriorityCallback detail{
-            .id = top.id,
-            .expired = Timestamp::Now() + top.interval,
-            .interval = top.interval,
-            .callback = top.callback,
-        };
-        queue_.emplace(std::move(detail));
-      } else {
-        callbacks_.erase(top.id);
-      }
-      lock.unlock();
-
-      if (*callback) {
-        (*callback)();
-      }
-    }
+  // Signaled when the last worker exits.
+  std::condition_variable stopped_;
+
+  detail::Lane lanes_[kPriorities];
+  size_t ready_{};
+  std::vector<detail::TimerEntry> timers_;
+
+  // Slots never move once allocated, so ScheduleCancel can reach them
+  // without taking mu_.
+  std::atomic<detail::TimerSlot*> chunks_[kMaxChunks]{};
+  std::vector<uint32_t> free_;
+  uint32_t slots_{};
+  // May briefly go negative while a cancel races with a worker.
+  std::atomic<int64_t> canceled_{};
+
+  detail::TimerSlot* slot(uint32_t index) const noexcept {
+    detail::TimerSlot* chunk =
+        chunks_[index >> kChunkBits].load(std::memory_order_acquire);
+    return chunk + (index & (kChunkSize - 1));
   }
 
+  uint32_t allocate();
+
+  void release(uint32_t index, detail::TimerSlot* slot);
+
+  void fire(std::unique_lock<std::mutex>& lock);
+
+  void purge();
+
+  detail::Lane* pick() noexcept;
+
+  void worker(std::list<std::thread>::iterator self);
+
+  // Called with mu_ held by a worker about to return.
+  void retire(std::list<std::thread>::iterator self);
+
+  // Workers not inside a BlockingScope.
+  size_t runnable() const noexcept;
+
+  void spawn();
+
+  // Spawns a worker if no worker is idle and the oldest ready task has
+  // waited longer than max_queue_delay.
+  void grow(Timestamp now);
+
+  void begin_blocking();
+
+  void end_blocking();
+
   uint64_t schedule(const Duration& delay, const Duration& interval,
-                    Callback cb) {
-    uint64_t id = id_++;
-    detail::PriorityCallback detail{
-        .id = id,
-        .expired = Timestamp::Now() + delay,
-        .interval = interval,
-        .callback = callbacks_[id] = std::make_shared<Callback>(std::move(cb)),
-    };
-    queue_.emplace(std::move(detail));
-    return id;
-  }
+                    Callback cb);
 
-  void close() {
-    callbacks_.clear();
-    shutdown_.store(true, std::memory_order_release);
-    non_empty_.notify_all();
-  }
+  void close();
 
-  void join() {
-    for (auto& thread : workers_) {
-      if (thread.joinable()) {
-        thread.join();
-      }
-    }
-  }
+  void join();
 
  public:
   explicit ThreadPoolExecutor()
       : ThreadPoolExecutor(std::thread::hardware_concurrency()) {}
 
-  explicit ThreadPoolExecutor(size_t threads) : workers_(threads) {
-    for (size_t i = 0; i < threads; ++i) {
-      workers_.emplace_back([this] { worker(); });
-    }
-  }
+  explicit ThreadPoolExecutor(size_t threads)
+      : ThreadPoolExecutor(Options{threads, threads}) {}
 
-  ~ThreadPoolExecutor() override {
-    close();
-    join();
-  }
+  explicit ThreadPoolExecutor(const Options& options);
 
-  size_t Size() const noexcept override { return workers_.size(); }
+  ~ThreadPoolExecutor() override;
 
-  void Schedule(Callback cb) override {
-    std::unique_lock<std::mutex> lock(mu_);
-    bool wakeup = queue_.empty();
-    schedule(Duration::Zero(), Duration::Zero(), std::move(cb));
-    if (wakeup) {
-      non_empty_.notify_all();
-    }
+  // The pool the calling thread works for, or nullptr.
+  static ThreadPoolExecutor* Current() noexcept { return current_; }
+
+  // The number of live workers.
+  size_t Size() const noexcept override {
+    return workers_.load(std::memory_order_relaxed);
   }
-  
-  uint64_t ScheduleAfter(Duration delay, Callback cb) override {
-    std::unique_lock<std::mutex> lock(mu_);
-    bool wakeup = queue_.empty();
-    uint64_t id = schedule(delay, Duration::Zero(), std::move(cb));
-    if (wakeup) {
-      non_empty_.notify_all();
-    }
-    return id;
+
+  void Schedule(Callback cb) override {
+    Schedule(std::move(cb), Priority::kNormal);
   }
-  
+
+  void Schedule(Callback cb, Priority priority) override;
+
+  using Executor::ScheduleBatch;
+
+  // Enqueues every callback under one lock acquisition and wakes at most
+  // min(n, idle) workers.
+  void ScheduleBatch(Callback* cbs, size_t n, Priority priority) override;
+
+  // Sets the share of dispatches a lane gets while others are backlogged.
+  // The defaults are 16:4:1 for high, normal and low.
+  void SetPriorityWeight(Priority priority, uint32_t weight);
+
+  [[nodiscard]] LaneStats Stats(Priority priority);
+
+  uint64_t ScheduleAfter(Duration delay, Callback cb) override;
+
   uint64_t ScheduleEvery(Duration delay, Duration interval,
-                         Callback cb) override {
-    std::unique_lock<std::mutex> lock(mu_);
-    bool wakeup = queue_.empty();
-    uint64_t id = schedule(delay, interval, std::move(cb));
-    if (wakeup) {
-      non_empty_.notify_all();
+                         Callback cb) override;
+
+  // A single state change on the task's slot; the slot and its callback
+  // are reclaimed by a worker soon after.
+  void ScheduleCancel(uint64_t id) override;
+
+  void Close() override;
+
+  void Join() override { join(); }
+};
+
+// Marks the enclosing code of a pool task as blocking (waiting on a file, a
+// latch, another task). While it is alive the pool may spawn a replacement
+// worker, up to max_threads, so blocked tasks do not starve the queue.
+// Outside a pool worker it does nothing.
+// Nested scopes count once: only the outermost one marks the worker.
+class BlockingScope : noncopyable, nonmovable {
+  inline static thread_local size_t depth_{};
+
+  ThreadPoolExecutor* executor_;
+
+ public:
+  BlockingScope() : executor_(ThreadPoolExecutor::Current()) {
+    if (executor_ != nullptr && depth_++ == 0) {
+      executor_->begin_blocking();
     }
-    return id;
-  }
-  
-  void ScheduleCancel(uint64_t id) override {
-    std::unique_lock<std::mutex> lock(mu_);
-    callbacks_.erase(id);
   }
 
-  void Close() override {
-    std::unique_lock<std::mutex> lock(mu_);
-    close();
+  ~BlockingScope() {
+    if (executor_ != nullptr && --depth_ == 0) {
+      executor_->end_blocking();
+    }
   }
-
-  void Join() override { join(); }
 };
+
 }  // namespace pedrolib
 
+PEDROLIB_CLASS_FORMATTER(pedrolib::LaneStats);
+
 #endif  // PEDRODB_THREAD_POOL_EXECUTOR_H
@@ -0,0 +1,161 @@
+#ifndef PEDROLIB_FILE_BUFFERED_FILE_H
+#define PEDROLIB_FILE_BUFFERED_FILE_H
+
+#include <atomic>
+#include <cstdlib>
+#include <memory>
+#include <optional>
+#include <string_view>
+#include "pedrolib/file/file.h"
+#include "pedrolib/noncopyable.h"
+#include "pedrolib/nonmovable.h"
+
+namespace pedrolib {
+
+struct Executor;
+
+namespace detail {
+
+// One buffer of a BufferedFileReader or BufferedFileWriter, read or
+// written by a task on the executor.
+struct IoWindow {
+  // done holds kDone once the io finished and kWaiting once the owner may
+  // be blocked on it. The task finishes with a single exchange, so it never
+  // touches a window that the woken owner may already have reused or freed.
+  static constexpr uint32_t kDone = 1;
+  static constexpr uint32_t kWaiting = 2;
+
+  char* data{};
+  uint64_t offset{};
+  size_t size{};
+  ssize_t result{};
+  Error error;
+  std::atomic<uint32_t> done{kDone};
+
+  void Wait() noexcept;
+};
+
+struct IoOptions {
+  // Bytes per buffer, rounded up to a multiple of alignment.
+  size_t buffer_size{1 << 20};
+  // Buffers in flight; 2 is double buffering.
+  size_t windows{2};
+  // Buffer address alignment; 4096 suits O_DIRECT files.
+  size_t alignment{4096};
+};
+
+class IoWindows {
+  struct Deleter {
+    void operator()(char* p) const noexcept { std::free(p); }
+  };
+
+  std::unique_ptr<char, Deleter> memory_;
+  std::unique_ptr<IoWindow[]> windows_;
+  size_t count_;
+  size_t buffer_size_;
+
+ public:
+  explicit IoWindows(const IoOptions& options);
+
+  ~IoWindows();
+
+  IoWindow& operator[](size_t i) noexcept { return windows_[i % count_]; }
+
+  [[nodiscard]] size_t Count() const noexcept { return count_; }
+
+  [[nodiscard]] size_t BufferSize() const noexcept { return buffer_size_; }
+};
+
+}  // namespace detail
+
+// Reads a File sequentially from offset with Pread, keeping the next
+// windows in flight on executor while the caller consumes the current
+// one. With a null executor the reads run inline. The file position is
+// left alone.
+class BufferedFileReader : noncopyable, nonmovable {
+ public:
+  using Options = detail::IoOptions;
+
+ private:
+  File* file_;
+  Executor* executor_;
+  detail::IoWindows windows_;
+  uint64_t next_offset_;
+  size_t issued_{};
+  size_t consumed_{};
+  // The caller holds window consumed_ - 1 until the next call.
+  bool held_{false};
+  // Set by a short read or an error; nothing more is issued.
+  bool stopped_{false};
+  bool eof_{false};
+  Error error_;
+  std::string_view remaining_;
+
+  void issue();
+
+ public:
+  BufferedFileReader(File* file, Executor* executor, uint64_t offset = 0)
+      : BufferedFileReader(file, executor, offset, Options{}) {}
+
+  BufferedFileReader(File* file, Executor* executor, uint64_t offset,
+                     const Options& options);
+
+  ~BufferedFileReader();
+
+  // The next bytes of the file, at most one window, valid until the next
+  // call. Returns nullopt at the end or on an error.
+  std::optional<std::string_view> Next();
+
+  // Copies up to n bytes; returns 0 at the end and -1 on an error.
+  ssize_t Read(void* buf, size_t n);
+
+  [[nodiscard]] bool Eof() const noexcept { return eof_; }
+
+  [[nodiscard]] Error GetError() const noexcept { return error_; }
+};
+
+// Writes a File sequentially from offset. Full buffers are written with
+// Pwritev by tasks on executor while the caller fills the next one, and
+// writes larger than a buffer go straight to the file together with the
+// buffered bytes. With a null executor the writes run inline. Errors from
+// background writes surface from the next Write or Flush.
+class BufferedFileWriter : noncopyable, nonmovable {
+ public:
+  using Options = detail::IoOptions;
+
+ private:
+  File* file_;
+  Executor* executor_;
+  detail::IoWindows windows_;
+  uint64_t offset_;
+  size_t current_{};
+  size_t used_{};
+  Error error_;
+
+  void submit();
+  void collect(detail::IoWindow& window) noexcept;
+
+ public:
+  BufferedFileWriter(File* file, Executor* executor, uint64_t offset = 0)
+      : BufferedFileWriter(file, executor, offset, Options{}) {}
+
+  BufferedFileWriter(File* file, Executor* executor, uint64_t offset,
+                     const Options& options);
+
+  // Flushes; call Flush first to see its error.
+  ~BufferedFileWriter();
+
+  Error Write(const void* data, size_t n);
+
+  Error Write(std::string_view data) { return Write(data.data(), data.size()); }
+
+  // Writes the buffered bytes and waits for all background writes.
+  Error Flush();
+
+  // The file offset after the last byte written so far.
+  [[nodiscard]] uint64_t Offset() const noexcept { return offset_ + used_; }
+};
+
+}  // namespace pedrolib
+
+#endif  // PEDROLIB_FILE_BUFFERED_FILE_H
@@ -3,7 +3,6 @@
 
 #include "pedrolib/file/error.h"
 #include "pedrolib/format/formatter.h"
-#include "pedrolib/logger/logger.h"
 #include "pedrolib/noncopyable.h"
 
 #include <optional>
@@ -63,6 +62,10 @@ class File : pedrolib::noncopyable {
 
   virtual ssize_t Pwritev(uint64_t offset, std::string_view* buf, size_t n);
 
+  // Copies n bytes at offset to the current position of target inside the
+  // kernel when possible. The offset is ignored for pipes and sockets.
+  virtual ssize_t TransferTo(File& target, uint64_t offset, size_t n);
+
   [[nodiscard]] bool Valid() const noexcept { return fd_ != kInvalid; }
 
   [[nodiscard]] int Descriptor() const noexcept { return fd_; }
@@ -81,4 +84,11 @@ class File : pedrolib::noncopyable {
 }  // namespace pedrolib
 
 PEDROLIB_CLASS_FORMATTER(pedrolib::File);
+
+// Kept for users that get the logger through this header. It comes last
+// and is skipped while a log sink, which needs File, includes this header.
+#if !defined(PEDROLIB_LOGGER_ASYNC_SINK_H) && \
+    !defined(PEDROLIB_LOGGER_BINARY_SINK_H)
+#include "pedrolib/logger/logger.h"
+#endif
 #endif  // PEDROLIB_FILE_FILE_H
\ No newline at end of file
@@ -0,0 +1,81 @@
+#ifndef PEDROLIB_FILE_PARALLEL_SCAN_H
+#define PEDROLIB_FILE_PARALLEL_SCAN_H
+
+#include <algorithm>
+#include <functional>
+#include <optional>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+#include "pedrolib/file/file.h"
+
+namespace pedrolib {
+
+struct Executor;
+
+struct ScanChunk {
+  // Chunk number, from 0 in file order.
+  size_t index;
+  // File offset of data.
+  uint64_t offset;
+  // Valid only during the callback.
+  std::string_view data;
+};
+
+struct ScanOptions {
+  size_t chunk_size{4 << 20};
+  // When set, chunks are moved to record boundaries: each holds the whole
+  // records that start inside its nominal range, up to and including the
+  // delimiter. A record longer than a chunk leaves the following chunks
+  // empty.
+  std::optional<char> delimiter;
+  // Maps the file instead of reading each chunk with Pread.
+  bool map{false};
+};
+
+// Splits file into chunks and calls fn on each from the tasks of
+// executor, inline when it is null, concurrently and in no particular
+// order. Empty chunks are skipped. Returns the first read error; chunks
+// not started by then are skipped.
+Error ParallelScan(File& file, Executor* executor, const ScanOptions& options,
+                   const std::function<void(const ScanChunk&)>& fn);
+
+inline Error ParallelScan(File& file, Executor* executor, size_t chunk_size,
+                          const std::function<void(const ScanChunk&)>& fn) {
+  ScanOptions options;
+  options.chunk_size = chunk_size;
+  return ParallelScan(file, executor, options, fn);
+}
+
+// Runs map on every chunk in parallel, then reduce on the results in file
+// order on the calling thread.
+template <typename Map, typename Reduce>
+Error ParallelScan(File& file, Executor* executor, const ScanOptions& options,
+                   Map&& map, Reduce&& reduce) {
+  using Result = std::invoke_result_t<Map&, const ScanChunk&>;
+
+  int64_t size = file.GetSize();
+  if (size < 0) {
+    return file.GetError();
+  }
+  size_t chunk_size = std::max<size_t>(options.chunk_size, 1);
+  std::vector<std::optional<Result>> results((size + chunk_size - 1) /
+                                             chunk_size);
+  Error error = ParallelScan(file, executor, options,
+                             [&](const ScanChunk& chunk) {
+                               results[chunk.index].emplace(map(chunk));
+                             });
+  if (!error.Empty()) {
+    return error;
+  }
+  for (auto& result : results) {
+    if (result) {
+      reduce(std::move(*result));
+    }
+  }
+  return error;
+}
+
+}  // namespace pedrolib
+
+#endif  // PEDROLIB_FILE_PARALLEL_SCAN_H
@@ -0,0 +1,138 @@
+#ifndef PEDROLIB_LOGGER_ASYNC_SINK_H
+#define PEDROLIB_LOGGER_ASYNC_SINK_H
+
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <thread>
+#include "pedrolib/duration.h"
+#include "pedrolib/file/file.h"
+#include "pedrolib/noncopyable.h"
+#include "pedrolib/nonmovable.h"
+#include "pedrolib/timestamp.h"
+
+namespace pedrolib {
+
+// A bounded MPSC ring of preformatted log records. Producers format the
+// message straight into a ring slot; a background thread prepends the
+// timestamp and logger prefix and writes records in batches with Writev.
+class AsyncLogSink : noncopyable, nonmovable {
+ public:
+  enum class OverflowPolicy {
+    kBlock,
+    kDrop,
+    kCount,
+  };
+
+  struct Options {
+    size_t capacity{8192};
+    size_t record_bytes{512};
+    OverflowPolicy overflow{OverflowPolicy::kBlock};
+    Duration flush_interval{Duration::Milliseconds(10)};
+  };
+
+ private:
+  struct alignas(64) Slot {
+    std::atomic<uint64_t> sequence;
+    int64_t usecs;
+    const char* level;
+    uint32_t name_size;
+    uint32_t size;
+
+    char* data() noexcept { return reinterpret_cast<char*>(this + 1); }
+  };
+
+  struct Deleter {
+    void operator()(char* p) const noexcept { std::free(p); }
+  };
+
+  File file_;
+  Options options_;
+  size_t stride_;
+  size_t mask_;
+  std::unique_ptr<char, Deleter> slots_;
+
+  alignas(64) std::atomic<uint64_t> tail_{};
+  alignas(64) std::atomic<uint64_t> head_{};
+  std::atomic<uint64_t> dropped_{};
+  std::atomic_bool wakeup_{false};
+
+  std::mutex mu_;
+  std::condition_variable non_empty_;
+  std::condition_variable flushed_;
+  uint64_t flush_target_{};
+  bool closed_{false};
+  std::thread flusher_;
+
+  Slot* slot(uint64_t pos) const noexcept {
+    return reinterpret_cast<Slot*>(slots_.get() + (pos & mask_) * stride_);
+  }
+
+  Slot* acquire(uint64_t* pos) noexcept;
+
+  // Copies the logger name ahead of the message, so records outlive the
+  // logger that produced them. Returns the bytes used.
+  size_t copy_name(Slot* s, std::string_view name) const noexcept;
+
+  // Writes a note about a message that failed to format in its place.
+  // Returns the bytes used.
+  static size_t write_error(char* out, size_t cap, const char* what,
+                            const char* fmt) noexcept;
+
+  void publish(Slot* s, uint64_t pos, int64_t usecs, const char* level,
+               size_t name_size, size_t size) noexcept;
+
+  void wakeup() noexcept;
+
+  size_t drain();
+
+  void flusher();
+
+ public:
+  explicit AsyncLogSink(File file) : AsyncLogSink(std::move(file), {}) {}
+
+  AsyncLogSink(File file, const Options& options);
+
+  ~AsyncLogSink();
+
+  template <typename... Args>
+  void Append(std::string_view name, const char* level, const char* fmt,
+              Args&&... args) {
+    uint64_t pos;
+    Slot* s = acquire(&pos);
+    if (s == nullptr) {
+      return;
+    }
+
+    int64_t usecs = Timestamp::Now().usecs;
+    size_t name_size = copy_name(s, name);
+    size_t cap = stride_ - sizeof(Slot) - 1 - name_size;
+    char* out = s->data() + name_size;
+    // The slot is claimed, so it must be published even if formatting
+    // throws; the flusher would wait on it forever otherwise.
+    size_t size;
+    try {
+      auto r = fmt::format_to_n(out, cap, fmt, std::forward<Args>(args)...);
+      size = std::min(r.size, cap);
+    } catch (const std::exception& e) {
+      size = write_error(out, cap, e.what(), fmt);
+    } catch (...) {
+      size = write_error(out, cap, "unknown exception", fmt);
+    }
+    publish(s, pos, usecs, level, name_size, size);
+  }
+
+  // Blocks until every record appended before the call has been written.
+  void Flush();
+
+  [[nodiscard]] uint64_t Dropped() const noexcept {
+    return dropped_.load(std::memory_order_relaxed);
+  }
+};
+
+}  // namespace pedrolib
+
+#endif  // PEDROLIB_LOGGER_ASYNC_SINK_H
@@ -0,0 +1,255 @@
+#ifndef PEDROLIB_LOGGER_BINARY_SINK_H
+#define PEDROLIB_LOGGER_BINARY_SINK_H
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <vector>
+#include "pedrolib/concurrent/futex.h"
+#include "pedrolib/file/error.h"
+#include "pedrolib/file/file.h"
+#include "pedrolib/logger/async_sink.h"
+#include "pedrolib/noncopyable.h"
+#include "pedrolib/nonmovable.h"
+#include "pedrolib/timestamp.h"
+
+namespace pedrolib {
+
+namespace detail {
+
+enum class ArgType : uint8_t {
+  kBool,
+  kChar,
+  kInt64,
+  kUInt64,
+  kDouble,
+  kPointer,
+  kString,
+};
+
+// Describes how one argument is stored in a binary record. Arithmetic values
+// and strings are copied raw; any other formattable type is formatted
+// eagerly and stored as a string.
+template <typename T, typename = void>
+struct BinaryArg {
+  constexpr static ArgType kType = ArgType::kString;
+
+  static size_t Size(const T& value) {
+    return sizeof(uint32_t) + fmt::formatted_size("{}", value);
+  }
+
+  static char* Encode(char* p, const T& value) {
+    auto n = static_cast<uint32_t>(fmt::formatted_size("{}", value));
+    std::memcpy(p, &n, sizeof(n));
+    return fmt::format_to(p + sizeof(n), "{}", value);
+  }
+};
+
+template <typename T, ArgType type, typename Stored>
+struct RawBinaryArg {
+  constexpr static ArgType kType = type;
+
+  static size_t Size(const T&) { return sizeof(Stored); }
+
+  static char* Encode(char* p, const T& value) {
+    auto x = static_cast<Stored>(value);
+    std::memcpy(p, &x, sizeof(x));
+    return p + sizeof(x);
+  }
+};
+
+template <>
+struct BinaryArg<bool> : RawBinaryArg<bool, ArgType::kBool, bool> {};
+
+template <>
+struct BinaryArg<char> : RawBinaryArg<char, ArgType::kChar, char> {};
+
+template <typename T>
+struct BinaryArg<T, std::enable_if_t<std::is_integral_v<T> &&
+                                     std::is_signed_v<T>>>
+    : RawBinaryArg<T, ArgType::kInt64, int64_t> {};
+
+template <typename T>
+struct BinaryArg<T, std::enable_if_t<std::is_integral_v<T> &&
+                                     std::is_unsigned_v<T>>>
+    : RawBinaryArg<T, ArgType::kUInt64, uint64_t> {};
+
+template <typename T>
+struct BinaryArg<T, std::enable_if_t<std::is_floating_point_v<T>>>
+    : RawBinaryArg<T, ArgType::kDouble, double> {};
+
+template <typename T>
+struct BinaryArg<T*> {
+  constexpr static ArgType kType = ArgType::kPointer;
+
+  static size_t Size(const T*) { return sizeof(uint64_t); }
+
+  static char* Encode(char* p, const T* value) {
+    auto x = reinterpret_cast<uint64_t>(value);
+    std::memcpy(p, &x, sizeof(x));
+    return p + sizeof(x);
+  }
+};
+
+struct StringBinaryArg {
+  constexpr static ArgType kType = ArgType::kString;
+
+  static size_t Size(std::string_view value) {
+    return sizeof(uint32_t) + value.size();
+  }
+
+  static char* Encode(char* p, std::string_view value) {
+    auto n = static_cast<uint32_t>(value.size());
+    std::memcpy(p, &n, sizeof(n));
+    std::memcpy(p + sizeof(n), value.data(), n);
+    return p + sizeof(n) + n;
+  }
+};
+
+template <>
+struct BinaryArg<const char*> : StringBinaryArg {};
+
+template <>
+struct BinaryArg<char*> : StringBinaryArg {};
+
+template <>
+struct BinaryArg<std::string> : StringBinaryArg {};
+
+template <>
+struct BinaryArg<std::string_view> : StringBinaryArg {};
+
+template <typename... Args>
+struct BinaryArgTypes {
+  constexpr static std::array<ArgType, sizeof...(Args)> kTypes{
+      BinaryArg<Args>::kType...};
+};
+
+}  // namespace detail
+
+struct BinaryLogFormat {
+  std::string name;
+  std::string level;
+  std::string fmt;
+  std::vector<detail::ArgType> types;
+};
+
+// A logging backend that never formats on the caller's thread. Each message
+// is reduced to a format id, a timestamp and the raw argument bytes, which
+// are copied into a buffer owned by the calling thread. A background thread
+// either formats the records (kText) or writes them out unformatted (kBinary)
+// for pedrolib-logdecode to format offline.
+//
+// Each distinct format text is registered once and kept for the life of the
+// process, so text that varies per message belongs in an argument.
+class BinaryLogSink : noncopyable, nonmovable {
+ public:
+  using OverflowPolicy = AsyncLogSink::OverflowPolicy;
+
+  enum class Mode {
+    kBinary,
+    kText,
+  };
+
+  struct Options {
+    Mode mode{Mode::kBinary};
+    size_t buffer_bytes{1 << 20};
+    OverflowPolicy overflow{OverflowPolicy::kCount};
+  };
+
+  struct ThreadBuffer;
+
+ private:
+  uint64_t id_;
+  File file_;
+  Options options_;
+
+  // Set while the flusher is about to block; the first producer to clear it
+  // wakes the flusher.
+  std::atomic<uint32_t> sleeping_{0};
+
+  std::mutex mu_;
+  std::condition_variable flushed_;
+  std::vector<std::shared_ptr<ThreadBuffer>> buffers_;
+  std::atomic<uint64_t> dropped_{};
+  uint64_t rounds_{};
+  size_t flushing_{};
+  bool closed_{false};
+  std::thread flusher_;
+
+  static uint32_t lookup(std::string_view name, const char* level,
+                         const char* fmt, const detail::ArgType* types,
+                         size_t nargs);
+
+  ThreadBuffer* buffer();
+
+  char* reserve(ThreadBuffer* buffer, size_t n);
+
+  void commit(ThreadBuffer* buffer, size_t n);
+
+  void wakeup() noexcept;
+
+  bool pending();
+
+  void flusher();
+
+ public:
+  explicit BinaryLogSink(File file) : BinaryLogSink(std::move(file), {}) {}
+
+  BinaryLogSink(File file, const Options& options);
+
+  ~BinaryLogSink();
+
+  template <typename... Args>
+  void Append(std::string_view name, const char* level, const char* fmt,
+              Args&&... args) {
+    using Types = detail::BinaryArgTypes<std::decay_t<Args>...>;
+    uint32_t id = lookup(name, level, fmt, Types::kTypes.data(),
+                         Types::kTypes.size());
+
+    size_t size = kRecordHeader;
+    ((size += detail::BinaryArg<std::decay_t<Args>>::Size(args)), ...);
+
+    ThreadBuffer* buf = buffer();
+    char* p = reserve(buf, size);
+    if (p == nullptr) {
+      return;
+    }
+
+    auto n = static_cast<uint32_t>(size);
+    int64_t usecs = Timestamp::Now().usecs;
+    std::memcpy(p, &n, sizeof(n));
+    std::memcpy(p + 4, &id, sizeof(id));
+    std::memcpy(p + 8, &usecs, sizeof(usecs));
+    [[maybe_unused]] char* q = p + kRecordHeader;
+    ((q = detail::BinaryArg<std::decay_t<Args>>::Encode(q, args)), ...);
+    commit(buf, size);
+  }
+
+  // Blocks until every record appended before the call has been written.
+  void Flush();
+
+  [[nodiscard]] uint64_t Dropped() const noexcept {
+    return dropped_.load(std::memory_order_relaxed);
+  }
+
+  constexpr static size_t kRecordHeader = 16;
+};
+
+// Formats the stream written by a kBinary BinaryLogSink back into text.
+class BinaryLogDecoder {
+  std::vector<BinaryLogFormat> formats_;
+
+ public:
+  Error Decode(File* input, File* output);
+};
+
+}  // namespace pedrolib
+
+#endif  // PEDROLIB_LOGGER_BINARY_SINK_H
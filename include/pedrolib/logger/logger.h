@@ -2,11 +2,21 @@
 #define PEDROLIB_LOGGER_LOGGER_H
 
 #include <fmt/color.h>
+#include <atomic>
+#include <memory>
 #include <mutex>
 #include <string>
+#include "pedrolib/logger/async_sink.h"
+#include "pedrolib/logger/binary_sink.h"
 #include "pedrolib/timestamp.h"
 
+#if !defined(USE_SPDLOG) && !defined(USE_STDLOG)
 #define USE_SPDLOG
+#endif
+
+#ifndef PEDROLIB_MIN_LOG_LEVEL
+#define PEDROLIB_MIN_LOG_LEVEL 0
+#endif
 
 #ifdef USE_SPDLOG
 #include <spdlog/sinks/stdout_color_sinks.h>
@@ -38,7 +48,25 @@ class Logger {
 
   std::string name_;
   std::mutex mu_;
-  Level level_{Level::kDisable};
+  std::atomic<Level> level_{Level::kDisable};
+  // SetSink may race with logging threads, so both are only accessed through
+  // std::atomic_load and std::atomic_store.
+  std::shared_ptr<AsyncLogSink> sink_;
+  std::shared_ptr<BinaryLogSink> binary_;
+
+  // Returns false if no sink is set and the message was not consumed.
+  template <typename... Args>
+  bool append(const char* name, const char* fmt, Args&&... args) {
+    if (auto binary = std::atomic_load(&binary_)) {
+      binary->Append(name_, name, fmt, std::forward<Args>(args)...);
+      return true;
+    }
+    if (auto sink = std::atomic_load(&sink_)) {
+      sink->Append(name_, name, fmt, std::forward<Args>(args)...);
+      return true;
+    }
+    return false;
+  }
 
  public:
   explicit Logger(const char* name) : name_(name) {
@@ -46,11 +74,34 @@ class Logger {
     logger = spdlog::stdout_color_mt(name);
 #endif
 
-    SetLevel(level_);
+    SetLevel(Level::kDisable);
+  }
+
+  ~Logger() {
+    if (auto binary = std::atomic_load(&binary_)) {
+      binary->Flush();
+    }
+    if (auto sink = std::atomic_load(&sink_)) {
+      sink->Flush();
+    }
+  }
+
+  // Routes every message of this logger through the background sink.
+  void SetSink(std::shared_ptr<AsyncLogSink> sink) {
+    std::atomic_store(&sink_, std::move(sink));
+  }
+
+  // Records messages unformatted; takes precedence over SetSink.
+  void SetSink(std::shared_ptr<BinaryLogSink> sink) {
+    std::atomic_store(&binary_, std::move(sink));
+  }
+
+  [[nodiscard]] bool ShouldLog(Level level) const noexcept {
+    return Compare(level_.load(std::memory_order_relaxed), level) <= 0;
   }
 
   void SetLevel(Level level) {
-    level_ = level;
+    level_.store(level, std::memory_order_relaxed);
 #ifdef USE_SPDLOG
     {
       auto loglevel = [](Level level) {
@@ -75,14 +126,18 @@ class Logger {
 
   template <typename... Args>
   void Info(const char* fmt, Args&&... args) {
+    if (!ShouldLog(Level::kInfo)) {
+      return;
+    }
+    if (append("INFO", fmt, std::forward<Args>(args)...)) {
+      return;
+    }
+
 #ifdef USE_SPDLOG
     logger->info(fmt, std::forward<Args>(args)...);
 #endif
 
 #ifdef USE_STDLOG
-    if (Compare(level_, Level::kInfo) > 0) {
-      return;
-    }
     static std::string level = "INFO";
     Timestamp now = Timestamp::Now();
     std::string msg = fmt::format(fmt, std::forward<Args>(args)...);
@@ -92,14 +147,18 @@ class Logger {
 
   template <typename... Args>
   void Warn(const char* fmt, Args&&... args) {
+    if (!ShouldLog(Level::kWarn)) {
+      return;
+    }
+    if (append("WARN", fmt, std::forward<Args>(args)...)) {
+      return;
+    }
+
 #ifdef USE_SPDLOG
     logger->warn(fmt, std::forward<Args>(args)...);
 #endif
 
 #ifdef USE_STDLOG
-    if (Compare(level_, Level::kWarn) > 0) {
-      return;
-    }
     static std::string level = "WARN";
     Timestamp now = Timestamp::Now();
     std::string msg = fmt::format(fmt, std::forward<Args>(args)...);
@@ -109,14 +168,18 @@ class Logger {
 
   template <typename... Args>
   void Error(const char* fmt, Args&&... args) {
+    if (!ShouldLog(Level::kError)) {
+      return;
+    }
+    if (append("ERROR", fmt, std::forward<Args>(args)...)) {
+      return;
+    }
+
 #ifdef USE_SPDLOG
     logger->error(fmt, std::forward<Args>(args)...);
 #endif
 
 #ifdef USE_STDLOG
-    if (Compare(level_, Level::kError) > 0) {
-      return;
-    }
     static std::string level = "ERROR";
     Timestamp now = Timestamp::Now();
     std::string msg = fmt::format(fmt, std::forward<Args>(args)...);
@@ -126,14 +189,18 @@ class Logger {
 
   template <typename... Args>
   void Trace(const char* fmt, Args&&... args) {
+    if (!ShouldLog(Level::kTrace)) {
+      return;
+    }
+    if (append("TRACE", fmt, std::forward<Args>(args)...)) {
+      return;
+    }
+
 #ifdef USE_SPDLOG
     logger->trace(fmt, std::forward<Args>(args)...);
 #endif
 
 #ifdef USE_STDLOG
-    if (Compare(level_, Level::kTrace) > 0) {
-      return;
-    }
     static std::string level = "TRACE";
     Timestamp now = Timestamp::Now();
     std::string msg = fmt::format(fmt, std::forward<Args>(args)...);
@@ -143,14 +210,22 @@ class Logger {
 
   template <typename... Args>
   void Fatal(const char* fmt, Args&&... args) {
+    if (auto binary = std::atomic_load(&binary_)) {
+      binary->Append(name_, "FATAL", fmt, std::forward<Args>(args)...);
+      binary->Flush();
+      std::terminate();
+    }
+    if (auto sink = std::atomic_load(&sink_)) {
+      sink->Append(name_, "FATAL", fmt, std::forward<Args>(args)...);
+      sink->Flush();
+      std::terminate();
+    }
+
 #ifdef USE_SPDLOG
     logger->critical(fmt, std::forward<Args>(args)...);
 #endif
 
 #ifdef USE_STDLOG
-    if (Compare(level_, Level::kDisable) > 0) {
-      return;
-    }
     static std::string level = "FATAL";
     Timestamp now = Timestamp::Now();
     std::string msg = fmt::format(fmt, std::forward<Args>(args)...);
@@ -161,4 +236,52 @@ class Logger {
 };
 }  // namespace pedrolib
 
+// Level checked logging: arguments are evaluated only when the level is
+// enabled, and statements below PEDROLIB_MIN_LOG_LEVEL are compiled out.
+#define PEDROLIB_LOG(logger, level, method, ...) \
+  do {                                           \
+    auto& pedrolib_logger_ = (logger);           \
+    if (pedrolib_logger_.ShouldLog(level)) {     \
+      pedrolib_logger_.method(__VA_ARGS__);      \
+    }                                            \
+  } while (0)
+
+#if PEDROLIB_MIN_LOG_LEVEL <= 0
+#define PEDROLIB_LOG_TRACE(logger, ...) \
+  PEDROLIB_LOG(logger, ::pedrolib::Logger::Level::kTrace, Trace, __VA_ARGS__)
+#else
+#define PEDROLIB_LOG_TRACE(logger, ...) \
+  do {                                  \
+  } while (0)
+#endif
+
+#if PEDROLIB_MIN_LOG_LEVEL <= 1
+#define PEDROLIB_LOG_INFO(logger, ...) \
+  PEDROLIB_LOG(logger, ::pedrolib::Logger::Level::kInfo, Info, __VA_ARGS__)
+#else
+#define PEDROLIB_LOG_INFO(logger, ...) \
+  do {                                 \
+  } while (0)
+#endif
+
+#if PEDROLIB_MIN_LOG_LEVEL <= 2
+#define PEDROLIB_LOG_WARN(logger, ...) \
+  PEDROLIB_LOG(logger, ::pedrolib::Logger::Level::kWarn, Warn, __VA_ARGS__)
+#else
+#define PEDROLIB_LOG_WARN(logger, ...) \
+  do {                                 \
+  } while (0)
+#endif
+
+#if PEDROLIB_MIN_LOG_LEVEL <= 3
+#define PEDROLIB_LOG_ERROR(logger, ...) \
+  PEDROLIB_LOG(logger, ::pedrolib::Logger::Level::kError, Error, __VA_ARGS__)
+#else
+#define PEDROLIB_LOG_ERROR(logger, ...) \
+  do {                                  \
+  } while (0)
+#endif
+
+#define PEDROLIB_LOG_FATAL(logger, ...) (logger).Fatal(__VA_ARGS__)
+
 #endif  // PEDROLIB_LOGGER_LOGGER_H
@@ -0,0 +1,77 @@
+#ifndef PEDROLIB_MEMORY_ARENA_H
+#define PEDROLIB_MEMORY_ARENA_H
+
+#include <pedrolib/noncopyable.h>
+#include <pedrolib/nonmovable.h>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+
+namespace pedrolib {
+
+// A bump allocator safe for concurrent use. Allocation is one fetch_add on
+// the current block; only starting a new block takes the lock. Memory is
+// released all at once when the arena is destroyed, and no destructors
+// run, so owners destroy non-trivial objects themselves.
+class Arena : noncopyable, nonmovable {
+  struct alignas(std::max_align_t) Block {
+    Block* prev;
+    size_t size;
+    std::atomic<size_t> used;
+
+    char* Data() noexcept { return reinterpret_cast<char*>(this + 1); }
+  };
+
+  static constexpr size_t kMinAlign = alignof(std::max_align_t);
+
+  const size_t block_size_;
+  std::atomic<Block*> current_{nullptr};
+  // Every block, current or not, for the destructor.
+  Block* blocks_{nullptr};
+  std::atomic<size_t> memory_usage_{0};
+  std::mutex mu_;
+
+  static void* aligned(char* p, size_t align) noexcept {
+    auto address = reinterpret_cast<uintptr_t>(p);
+    return reinterpret_cast<void*>((address + align - 1) & ~(align - 1));
+  }
+
+  void* allocate(size_t reserve, size_t align);
+
+ public:
+  explicit Arena(size_t block_size = 64 << 10) : block_size_(block_size) {}
+
+  ~Arena();
+
+  // n bytes aligned to align, which must be a power of two.
+  void* Allocate(size_t n, size_t align = kMinAlign) {
+    size_t reserve = (n + (align > kMinAlign ? align - kMinAlign : 0) +
+                      kMinAlign - 1) &
+                     ~(kMinAlign - 1);
+    // Large requests get a block of their own so they waste no tail.
+    Block* block = current_.load(std::memory_order_acquire);
+    if (block != nullptr && reserve <= block_size_ / 4) {
+      size_t offset =
+          block->used.fetch_add(reserve, std::memory_order_relaxed);
+      if (offset + reserve <= block->size) {
+        return aligned(block->Data() + offset, align);
+      }
+    }
+    return allocate(reserve, align);
+  }
+
+  template <typename T>
+  T* Allocate() {
+    return static_cast<T*>(Allocate(sizeof(T), alignof(T)));
+  }
+
+  // Bytes obtained from the system, including unused block tails.
+  [[nodiscard]] size_t MemoryUsage() const noexcept {
+    return memory_usage_.load(std::memory_order_relaxed);
+  }
+};
+
+}  // namespace pedrolib
+
+#endif  // PEDROLIB_MEMORY_ARENA_H
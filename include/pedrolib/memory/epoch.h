@@ -0,0 +1,153 @@
+#ifndef PEDROLIB_MEMORY_EPOCH_H
+#define PEDROLIB_MEMORY_EPOCH_H
+
+#include <pedrolib/memory/retired.h>
+#include <pedrolib/noncopyable.h>
+#include <pedrolib/nonmovable.h>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace pedrolib {
+
+// Epoch-based reclamation. Readers pin the domain while they hold pointers
+// into a lock-free structure, and writers retire the nodes they unlink.
+// Retired nodes are freed in batches once the global epoch has advanced
+// twice past them, which is only possible after every pinned thread has
+// left the critical section it was in when the node was retired.
+//
+// Pinning costs a store and a fence, so it suits read-heavy structures; a
+// thread that stays pinned stalls reclamation for everyone.
+class EpochDomain : noncopyable, nonmovable {
+ public:
+  struct Bag {
+    uint64_t epoch{0};
+    std::vector<Retired> retired;
+  };
+
+  struct alignas(64) Record {
+    // (epoch << 1) | 1 while pinned, 0 otherwise.
+    std::atomic<uint64_t> local{0};
+    uint32_t nesting{0};
+    uint32_t retires{0};
+    Bag bags[3];
+    std::atomic_bool exited{false};
+    Record* next{nullptr};
+  };
+
+  // Pins the domain for the current thread; guards may be nested.
+  class Guard : noncopyable, nonmovable {
+    Record* record_;
+    // Held by a guard made during thread exit, after the thread's records
+    // are gone; handed back when the guard is destroyed.
+    std::shared_ptr<Record> borrowed_;
+
+   public:
+    explicit Guard(EpochDomain& domain) : record_(domain.record()) {
+      if (record_ == nullptr) {
+        borrowed_ = domain.borrow();
+        record_ = borrowed_.get();
+      }
+      if (record_->nesting++ == 0) {
+        domain.Pin(record_);
+      }
+    }
+
+    ~Guard() {
+      if (--record_->nesting == 0) {
+        record_->local.store(0, std::memory_order_release);
+      }
+      if (borrowed_ != nullptr) {
+        borrowed_->exited.store(true, std::memory_order_release);
+      }
+    }
+  };
+
+  struct ThreadRecords;
+
+ private:
+  struct RecordCache {
+    uint64_t id;
+    Record* record;
+  };
+
+  // Retires between attempts to advance the epoch.
+  constexpr static uint32_t kAdvanceInterval = 64;
+
+  inline static thread_local RecordCache cache_{};
+
+  uint64_t id_;
+  alignas(64) std::atomic<uint64_t> epoch_{0};
+  std::atomic<Record*> records_{nullptr};
+
+  std::mutex mu_;
+  std::vector<std::shared_ptr<Record>> owned_;
+
+  // Null once the thread's records are destroyed during its exit.
+  Record* record() {
+    if (cache_.id == id_) {
+      return cache_.record;
+    }
+    return lookup();
+  }
+
+  Record* lookup();
+
+  Record* adopt();
+
+  // Claims an exited record, or a new one, for the caller alone; it is
+  // handed back by marking it exited again.
+  std::shared_ptr<Record> borrow();
+
+  void Pin(Record* record) noexcept {
+    uint64_t epoch = epoch_.load(std::memory_order_relaxed);
+    record->local.store((epoch << 1) | 1, std::memory_order_relaxed);
+    // Publish the pin before reading any shared pointer.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+  }
+
+  void Retire(Record* record, Retired retired);
+
+  // Frees the bags of record that are two epochs behind.
+  void Collect(Record* record, uint64_t epoch);
+
+  void CollectExited(uint64_t epoch);
+
+ public:
+  EpochDomain();
+
+  // Frees everything still retired; no thread may be pinned.
+  ~EpochDomain();
+
+  // The shared domain, for structures that do not bring their own.
+  static EpochDomain& Default();
+
+  // Frees p once no thread can still hold a reference obtained under a
+  // guard. p must already be unreachable for new readers.
+  template <typename T>
+  void Retire(T* p) {
+    Retire(record(), MakeRetired(p));
+  }
+
+  void Retire(void* p, void (*deleter)(void*)) {
+    Retire(record(), Retired{p, deleter});
+  }
+
+  [[nodiscard]] uint64_t Epoch() const noexcept {
+    return epoch_.load(std::memory_order_relaxed);
+  }
+
+  // Advances the global epoch if every pinned thread has observed the
+  // current one. Returns true on success.
+  bool TryAdvance() noexcept;
+
+  // Advances the epoch twice and frees what the calling thread and exited
+  // threads retired before the call. Must not be called while pinned.
+  void Synchronize();
+};
+
+}  // namespace pedrolib
+
+#endif  // PEDROLIB_MEMORY_EPOCH_H
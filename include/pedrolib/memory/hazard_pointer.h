@@ -0,0 +1,147 @@
+#ifndef PEDROLIB_MEMORY_HAZARD_POINTER_H
+#define PEDROLIB_MEMORY_HAZARD_POINTER_H
+
+#include <pedrolib/memory/retired.h>
+#include <pedrolib/noncopyable.h>
+#include <pedrolib/nonmovable.h>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace pedrolib {
+
+// Hazard-pointer reclamation. A reader publishes the pointer it is about to
+// dereference in a hazard slot; retired nodes are only freed by a scan that
+// finds them in no slot. Unlike epochs, a stalled reader only keeps the
+// nodes it protects alive, at the cost of a fence per protected load.
+class HazardPointerDomain : noncopyable, nonmovable {
+ public:
+  struct alignas(64) Slot {
+    std::atomic<const void*> ptr{nullptr};
+    std::atomic_bool active{false};
+    Slot* next{nullptr};
+  };
+
+  struct Record {
+    std::vector<Retired> retired;
+    std::vector<Slot*> slots;
+    std::atomic_bool exited{false};
+    Record* next{nullptr};
+  };
+
+  // Owns one hazard slot for its lifetime.
+  class HazardPointer : noncopyable, nonmovable {
+    HazardPointerDomain* domain_;
+    Slot* slot_;
+
+   public:
+    explicit HazardPointer(HazardPointerDomain& domain = Default())
+        : domain_(&domain), slot_(domain.AcquireSlot()) {}
+
+    ~HazardPointer() { domain_->ReleaseSlot(slot_); }
+
+    // Loads src and protects the result; the pointer stays valid until the
+    // hazard pointer is reset, reused or destroyed.
+    template <typename T>
+    T* Protect(const std::atomic<T*>& src) noexcept {
+      T* p = src.load(std::memory_order_relaxed);
+      for (;;) {
+        slot_->ptr.store(p, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        T* q = src.load(std::memory_order_acquire);
+        if (q == p) {
+          return p;
+        }
+        p = q;
+      }
+    }
+
+    void Reset() noexcept {
+      slot_->ptr.store(nullptr, std::memory_order_release);
+    }
+  };
+
+  struct ThreadRecords;
+
+ private:
+  struct RecordCache {
+    uint64_t id;
+    Record* record;
+  };
+
+  // Slots kept per thread so short-lived hazard pointers skip the slot list.
+  constexpr static size_t kCachedSlots = 8;
+  // Scans are deferred until this many nodes (or twice the number of slots)
+  // have been retired, which keeps the cost per retire constant.
+  constexpr static size_t kScanThreshold = 64;
+
+  inline static thread_local RecordCache cache_{};
+
+  uint64_t id_;
+  std::atomic<Slot*> slots_{nullptr};
+  std::atomic<size_t> slot_count_{0};
+  std::atomic<Record*> records_{nullptr};
+
+  std::mutex mu_;
+  std::vector<std::unique_ptr<Slot>> owned_slots_;
+  std::vector<std::shared_ptr<Record>> owned_records_;
+
+  // Null once the thread's records are destroyed during its exit.
+  Record* record() {
+    if (cache_.id == id_) {
+      return cache_.record;
+    }
+    return lookup();
+  }
+
+  Record* lookup();
+
+  Record* adopt();
+
+  // Claims an exited record, or a new one, for the caller alone; it is
+  // handed back by marking it exited again.
+  std::shared_ptr<Record> borrow();
+
+  Slot* AcquireSlot();
+
+  void ReleaseSlot(Slot* slot) noexcept;
+
+  void Retire(Record* record, Retired retired);
+
+  // Frees the nodes of record that no slot protects.
+  void Scan(Record* record, std::vector<const void*>& hazards);
+
+  void CollectHazards(std::vector<const void*>& hazards);
+
+ public:
+  HazardPointerDomain();
+
+  // Frees everything still retired; no hazard pointer may be alive.
+  ~HazardPointerDomain();
+
+  // The shared domain, for structures that do not bring their own.
+  static HazardPointerDomain& Default();
+
+  // Frees p once no hazard pointer protects it. p must already be
+  // unreachable for new readers.
+  template <typename T>
+  void Retire(T* p) {
+    Retire(record(), MakeRetired(p));
+  }
+
+  void Retire(void* p, void (*deleter)(void*)) {
+    Retire(record(), Retired{p, deleter});
+  }
+
+  // Scans now instead of waiting for the threshold; also frees what exited
+  // threads left behind.
+  void Reclaim();
+};
+
+using HazardPointer = HazardPointerDomain::HazardPointer;
+
+}  // namespace pedrolib
+
+#endif  // PEDROLIB_MEMORY_HAZARD_POINTER_H
@@ -0,0 +1,21 @@
+#ifndef PEDROLIB_MEMORY_RETIRED_H
+#define PEDROLIB_MEMORY_RETIRED_H
+
+namespace pedrolib {
+
+// An unlinked object waiting to be freed by a reclamation domain.
+struct Retired {
+  void* ptr;
+  void (*deleter)(void*);
+
+  void Free() const { deleter(ptr); }
+};
+
+template <typename T>
+Retired MakeRetired(T* ptr) noexcept {
+  return Retired{ptr, [](void* p) { delete static_cast<T*>(p); }};
+}
+
+}  // namespace pedrolib
+
+#endif  // PEDROLIB_MEMORY_RETIRED_H
@@ -0,0 +1,148 @@
+#ifndef PEDROLIB_METRIC_HISTOGRAM_H
+#define PEDROLIB_METRIC_HISTOGRAM_H
+
+#include <algorithm>
+#include <atomic>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "pedrolib/duration.h"
+#include "pedrolib/format/formatter.h"
+#include "pedrolib/noncopyable.h"
+#include "pedrolib/nonmovable.h"
+
+namespace pedrolib {
+
+class HistogramSnapshot {
+  friend class Histogram;
+
+  int sub_bucket_bits_{};
+  std::vector<uint64_t> counts_;
+  uint64_t count_{};
+  int64_t sum_{};
+  int64_t min_{};
+  int64_t max_{};
+
+ public:
+  [[nodiscard]] uint64_t Count() const noexcept { return count_; }
+
+  [[nodiscard]] int64_t Min() const noexcept { return min_; }
+
+  [[nodiscard]] int64_t Max() const noexcept { return max_; }
+
+  [[nodiscard]] double Mean() const noexcept {
+    return count_ ? static_cast<double>(sum_) / count_ : 0;
+  }
+
+  // Returns the value below which the given percentage (0-100) of the
+  // recorded values fall, within the precision of the histogram.
+  [[nodiscard]] int64_t Percentile(double percentile) const noexcept;
+
+  [[nodiscard]] std::string String() const;
+};
+
+// A log-linear (HDR) histogram of non-negative values. Every thread records
+// into its own shard with plain relaxed stores, and shards are merged when a
+// snapshot is taken. Durations are recorded in microseconds.
+class Histogram : noncopyable, nonmovable {
+ public:
+  struct Shard {
+    explicit Shard(size_t buckets);
+
+    void Reset() noexcept;
+
+    std::unique_ptr<std::atomic<uint64_t>[]> counts;
+    size_t buckets;
+    std::atomic<int64_t> sum{};
+    std::atomic<int64_t> min{std::numeric_limits<int64_t>::max()};
+    std::atomic<int64_t> max{std::numeric_limits<int64_t>::min()};
+    std::atomic_bool exited{false};
+  };
+
+ private:
+  struct ShardCache {
+    uint64_t id;
+    Shard* shard;
+  };
+
+  inline static thread_local ShardCache cache_{};
+
+  uint64_t id_;
+  int64_t max_value_;
+  int sub_bucket_bits_;
+  size_t buckets_;
+
+  mutable std::mutex mu_;
+  std::vector<std::shared_ptr<Shard>> shards_;
+
+  Shard* shard() {
+    if (cache_.id == id_) {
+      return cache_.shard;
+    }
+    return lookup();
+  }
+
+  Shard* lookup();
+
+  Shard* adopt();
+
+ public:
+  explicit Histogram(int64_t max_value = 3600 * Duration::kMicroseconds,
+                     int significant_digits = 2);
+
+  ~Histogram();
+
+  void Record(int64_t value) noexcept {
+    value = std::clamp<int64_t>(value, 0, max_value_);
+    Shard* s = shard();
+
+    // Only the owning thread writes a shard, so no read-modify-write is
+    // needed; snapshots may observe a slightly stale shard.
+    auto& count = s->counts[BucketIndex(value)];
+    count.store(count.load(std::memory_order_relaxed) + 1,
+                std::memory_order_relaxed);
+    s->sum.store(s->sum.load(std::memory_order_relaxed) + value,
+                 std::memory_order_relaxed);
+    if (value < s->min.load(std::memory_order_relaxed)) {
+      s->min.store(value, std::memory_order_relaxed);
+    }
+    if (value > s->max.load(std::memory_order_relaxed)) {
+      s->max.store(value, std::memory_order_relaxed);
+    }
+  }
+
+  void Record(const Duration& d) noexcept { Record(d.Microseconds()); }
+
+  // Clears recorded values; records racing with the reset may be lost.
+  void Reset();
+
+  [[nodiscard]] HistogramSnapshot Snapshot() const;
+
+  [[nodiscard]] std::string String() const { return Snapshot().String(); }
+
+  [[nodiscard]] size_t BucketIndex(int64_t value) const noexcept {
+    value = std::clamp<int64_t>(value, 0, max_value_);
+    int p = sub_bucket_bits_;
+    if (value < (int64_t{1} << p)) {
+      return value;
+    }
+
+    int msb = 63 - __builtin_clzll(value);
+    int shift = msb - p + 1;
+    auto sub = static_cast<size_t>(value >> shift);
+    size_t half = size_t{1} << (p - 1);
+    return (size_t{1} << p) + (shift - 1) * half + (sub - half);
+  }
+
+  [[nodiscard]] static int64_t BucketValue(int sub_bucket_bits,
+                                           size_t index) noexcept;
+};
+
+}  // namespace pedrolib
+
+PEDROLIB_CLASS_FORMATTER(pedrolib::HistogramSnapshot);
+PEDROLIB_CLASS_FORMATTER(pedrolib::Histogram);
+
+#endif  // PEDROLIB_METRIC_HISTOGRAM_H
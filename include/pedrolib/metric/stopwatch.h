@@ -0,0 +1,44 @@
+#ifndef PEDROLIB_METRIC_STOPWATCH_H
+#define PEDROLIB_METRIC_STOPWATCH_H
+
+#include "pedrolib/clock.h"
+#include "pedrolib/metric/histogram.h"
+#include "pedrolib/noncopyable.h"
+
+namespace pedrolib {
+
+class Stopwatch {
+  Timestamp start_;
+
+ public:
+  Stopwatch() : start_(MonotonicClock::Now()) {}
+
+  void Reset() noexcept { start_ = MonotonicClock::Now(); }
+
+  [[nodiscard]] Duration Elapsed() const noexcept {
+    return MonotonicClock::Now() - start_;
+  }
+
+  // Returns the time since the last lap (or start) and starts a new lap.
+  Duration Lap() noexcept {
+    Timestamp now = MonotonicClock::Now();
+    Duration d = now - start_;
+    start_ = now;
+    return d;
+  }
+};
+
+// Records the lifetime of the scope into a histogram.
+class ScopedTimer : noncopyable {
+  Histogram* histogram_;
+  Stopwatch stopwatch_;
+
+ public:
+  explicit ScopedTimer(Histogram* histogram) : histogram_(histogram) {}
+
+  ~ScopedTimer() { histogram_->Record(stopwatch_.Elapsed()); }
+};
+
+}  // namespace pedrolib
+
+#endif  // PEDROLIB_METRIC_STOPWATCH_H
@@ -0,0 +1,128 @@
+#ifndef PEDROLIB_NET_SOCKET_H
+#define PEDROLIB_NET_SOCKET_H
+
+#include <utility>
+#include <vector>
+#include "pedrolib/file/file.h"
+#include "pedrolib/net/socket_address.h"
+
+namespace pedrolib {
+
+// A non-blocking, close-on-exec socket. Read, Write and Writev keep the
+// File semantics, so ArrayBuffer and TransferTo work on sockets unchanged;
+// writes never raise SIGPIPE.
+class Socket : public File {
+ public:
+  enum class Type { kStream, kDatagram };
+
+  // One message of a batched send or receive. For a send, size is the
+  // message length and address the destination (nullptr when connected).
+  // For a receive, size is the capacity on input and the received length
+  // on output, and address, if set, receives the source.
+  struct Datagram {
+    void* data{};
+    size_t size{};
+    SocketAddress* address{};
+  };
+
+  struct ZeroCopyStats {
+    // Sends before this one have all had their buffers released; send i is
+    // done once completed > i.
+    uint32_t completed{};
+    // Completed sends the kernel had to copy after all, which happens for
+    // example on loopback. Zero copy does not pay off when this grows.
+    uint32_t copied{};
+  };
+
+ private:
+  uint32_t zerocopy_sent_{};
+  ZeroCopyStats zerocopy_;
+  // Completed [begin, end) ranges past zerocopy_.completed. Notifications
+  // usually arrive in order, but the kernel does not promise it.
+  std::vector<std::pair<uint32_t, uint32_t>> zerocopy_ranges_;
+
+  void completeZeroCopy(uint32_t begin, uint32_t end);
+
+ public:
+  Socket() = default;
+
+  explicit Socket(int fd) : File(fd) {}
+
+  // Returns an invalid socket on failure; errno is set.
+  static Socket Create(int family, Type type);
+
+  // Creates a socket for address's family, binds it and, for streams,
+  // listens. Sets SO_REUSEADDR, plus SO_REUSEPORT when reuse_port is set.
+  static Socket CreateListener(const SocketAddress& address, Type type,
+                               bool reuse_port = false);
+
+  Error Bind(const SocketAddress& address);
+
+  Error Listen(int backlog = SOMAXCONN);
+
+  // Starts a connect. A stream socket usually returns EINPROGRESS; wait
+  // until it is writable and check ConnectResult.
+  Error Connect(const SocketAddress& address);
+
+  [[nodiscard]] Error ConnectResult() const;
+
+  // Accepts one pending connection as a non-blocking socket; returns an
+  // invalid socket when there is none (EAGAIN) or on failure.
+  Socket Accept(SocketAddress* peer = nullptr);
+
+  Error ShutdownWrite();
+
+  [[nodiscard]] std::optional<SocketAddress> LocalAddress() const;
+
+  [[nodiscard]] std::optional<SocketAddress> PeerAddress() const;
+
+  Error SetNoDelay(bool on);
+
+  Error SetReuseAddress(bool on);
+
+  Error SetReusePort(bool on);
+
+  Error SetKeepAlive(bool on);
+
+  Error SetSendBufferSize(int bytes);
+
+  Error SetReceiveBufferSize(int bytes);
+
+  ssize_t Write(const void* buf, size_t n) noexcept override;
+
+  ssize_t Writev(std::string_view* buf, size_t n) noexcept override;
+
+  ssize_t SendTo(const void* buf, size_t n, const SocketAddress& address);
+
+  ssize_t ReceiveFrom(void* buf, size_t n, SocketAddress* address);
+
+  // Sends up to n datagrams with one sendmmsg. Returns how many were sent,
+  // or -1 when none was.
+  int SendBatch(const Datagram* datagrams, size_t n);
+
+  // Receives up to n datagrams with one recvmmsg, updating each size.
+  // Returns how many were received, or -1 when none was.
+  int ReceiveBatch(Datagram* datagrams, size_t n);
+
+  // Needed once before SendZeroCopy.
+  Error EnableZeroCopy();
+
+  // Sends with MSG_ZEROCOPY: buf must stay untouched until the send is
+  // reported completed. The send's sequence number is stored in id.
+  ssize_t SendZeroCopy(const void* buf, size_t n, uint32_t* id = nullptr);
+
+  // Drains completion notifications from the error queue without blocking
+  // and returns the updated totals.
+  ZeroCopyStats ReapZeroCopy();
+
+  [[nodiscard]] bool ZeroCopyCompleted(uint32_t id) const noexcept {
+    return static_cast<int32_t>(zerocopy_.completed - id) > 0;
+  }
+
+  [[nodiscard]] std::string String() const override;
+};
+
+}  // namespace pedrolib
+
+PEDROLIB_CLASS_FORMATTER(pedrolib::Socket);
+#endif  // PEDROLIB_NET_SOCKET_H
@@ -0,0 +1,67 @@
+#ifndef PEDROLIB_NET_SOCKET_ADDRESS_H
+#define PEDROLIB_NET_SOCKET_ADDRESS_H
+
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <cstring>
+#include <optional>
+#include <string>
+#include <string_view>
+#include "pedrolib/format/formatter.h"
+
+namespace pedrolib {
+
+// An IPv4, IPv6 or Unix-domain address, stored by value.
+class SocketAddress {
+  struct sockaddr_storage storage_ {};
+  socklen_t length_{sizeof(storage_)};
+
+ public:
+  SocketAddress() = default;
+
+  SocketAddress(const struct sockaddr* addr, socklen_t length)
+      : length_(length) {
+    std::memcpy(&storage_, addr, length);
+  }
+
+  // Parses a numeric IPv4 or IPv6 address.
+  static std::optional<SocketAddress> Parse(std::string_view ip,
+                                            uint16_t port);
+
+  static SocketAddress Loopback(uint16_t port = 0);
+
+  static SocketAddress Any(uint16_t port = 0);
+
+  // A path longer than sun_path is truncated; a leading '\0' selects the
+  // abstract namespace.
+  static SocketAddress Unix(std::string_view path);
+
+  [[nodiscard]] int Family() const noexcept { return storage_.ss_family; }
+
+  // 0 for Unix-domain addresses.
+  [[nodiscard]] uint16_t Port() const noexcept;
+
+  struct sockaddr* Data() noexcept {
+    return reinterpret_cast<struct sockaddr*>(&storage_);
+  }
+
+  [[nodiscard]] const struct sockaddr* Data() const noexcept {
+    return reinterpret_cast<const struct sockaddr*>(&storage_);
+  }
+
+  [[nodiscard]] socklen_t Length() const noexcept { return length_; }
+
+  // For calls that fill the address in, such as accept4 and recvfrom.
+  socklen_t* MutableLength() noexcept {
+    length_ = sizeof(storage_);
+    return &length_;
+  }
+
+  [[nodiscard]] std::string String() const;
+};
+
+}  // namespace pedrolib
+
+PEDROLIB_CLASS_FORMATTER(pedrolib::SocketAddress);
+#endif  // PEDROLIB_NET_SOCKET_ADDRESS_H
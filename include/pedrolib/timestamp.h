@@ -37,10 +37,27 @@ struct Timestamp : public Comparable<Timestamp> {
     return Timestamp{usecs - d.usecs};
   }
 
+  // Length of the local time text "YYYY-MM-DD-HH:MM:SS:uuuuuu".
+  constexpr inline static size_t kFormatSize = 26;
+
+  // Writes kFormatSize characters without a terminator and returns the end.
+  // The date and time are cached per thread and reformatted once a second.
+  char* FormatTo(char* buf) const noexcept;
+
   std::string String() const noexcept;
 };
 }  // namespace pedrolib
 
-PEDROLIB_CLASS_FORMATTER(pedrolib::Timestamp);
+template <>
+struct fmt::formatter<pedrolib::Timestamp> {
+  constexpr auto parse(format_parse_context& ctx)
+      -> format_parse_context::iterator {
+    return ctx.end();
+  }
+  auto format(const pedrolib::Timestamp& item, format_context& ctx) const {
+    char buf[pedrolib::Timestamp::kFormatSize];
+    return std::copy(buf, item.FormatTo(buf), ctx.out());
+  }
+};
 
 #endif  // PEDROLIB_TIMESTAMP_H
\ No newline at end of file
@@ -0,0 +1,102 @@
+#include "pedrolib/buffer/record_reader.h"
+#include <cstring>
+#include "pedrolib/buffer/search.h"
+
+namespace pedrolib {
+
+RecordReader::RecordReader(File* file, Options options)
+    : file_(file), options_(std::move(options)), buffer_(options_.read_size) {
+  if (options_.delimiter.empty()) {
+    options_.delimiter = "\n";
+  }
+}
+
+const char* RecordReader::find(const char* begin,
+                               const char* end) const noexcept {
+  const std::string& delimiter = options_.delimiter;
+  if (delimiter.size() == 1) {
+    return FindByte(begin, end, delimiter[0]);
+  }
+  for (const char* p = begin;; ++p) {
+    p = FindPair(p, end, delimiter[0], delimiter[1]);
+    if (p == end || delimiter.size() == 2) {
+      return p;
+    }
+    if (static_cast<size_t>(end - p) < delimiter.size()) {
+      return end;
+    }
+    if (std::memcmp(p, delimiter.data(), delimiter.size()) == 0) {
+      return p;
+    }
+  }
+}
+
+std::optional<std::string_view> RecordReader::Next() {
+  const std::string& delimiter = options_.delimiter;
+  error_.Clear();
+  for (;;) {
+    const char* begin = buffer_.ReadIndex();
+    size_t readable = buffer_.ReadableBytes();
+    const char* end = begin + readable;
+
+    const char* hit = find(begin + scanned_, end);
+    if (hit != end && skipping_) {
+      buffer_.Retrieve(hit - begin + delimiter.size());
+      scanned_ = 0;
+      skipping_ = false;
+      continue;
+    }
+    if (hit != end) {
+      std::string_view record(begin, hit - begin);
+      buffer_.Retrieve(record.size() + delimiter.size());
+      scanned_ = 0;
+      if (options_.strip_cr && delimiter == "\n" && !record.empty() &&
+          record.back() == '\r') {
+        record.remove_suffix(1);
+      }
+      return record;
+    }
+    // A delimiter may straddle the end of what has been read so far.
+    size_t tail = delimiter.size() - 1;
+    scanned_ = readable > tail ? readable - tail : 0;
+
+    // Bytes of an oversized record are dropped as they are scanned; only
+    // the tail may still begin its delimiter.
+    if (skipping_) {
+      buffer_.Retrieve(scanned_);
+      scanned_ = 0;
+      if (eof_) {
+        buffer_.Retrieve(buffer_.ReadableBytes());
+        skipping_ = false;
+        return std::nullopt;
+      }
+    } else if (eof_) {
+      if (readable == 0) {
+        return std::nullopt;
+      }
+      buffer_.Retrieve(readable);
+      scanned_ = 0;
+      return std::string_view(begin, readable);
+    } else if (readable > options_.max_record + delimiter.size()) {
+      error_ = Error(EMSGSIZE);
+      skipping_ = true;
+      buffer_.Retrieve(scanned_);
+      scanned_ = 0;
+      return std::nullopt;
+    }
+
+    buffer_.EnsureWritable(options_.read_size, false);
+    ssize_t r = buffer_.Append(file_);
+    if (r == 0) {
+      eof_ = true;
+    } else if (r < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      error_ = Error(errno);
+      return std::nullopt;
+    }
+  }
+}
+
+}  // namespace pedrolib
@@ -0,0 +1,126 @@
+#include "pedrolib/buffer/ring_buffer.h"
+#include <sys/mman.h>
+#include <unistd.h>
+#include <system_error>
+
+namespace pedrolib {
+
+namespace {
+
+size_t RoundToPages(size_t n) {
+  static const size_t kPageSize = ::sysconf(_SC_PAGESIZE);
+  n = std::max(n, kPageSize);
+  return (n + kPageSize - 1) / kPageSize * kPageSize;
+}
+
+[[noreturn]] void Fail(const char* what) {
+  throw std::system_error(errno, std::generic_category(), what);
+}
+
+// Reserves 2 * capacity of address space, then maps the same memfd pages
+// into both halves.
+char* MapMirrored(size_t capacity) {
+  int fd = ::memfd_create("pedrolib-ring", MFD_CLOEXEC);
+  if (fd < 0) {
+    Fail("memfd_create");
+  }
+  File memfd(fd);
+  if (::ftruncate(fd, static_cast<off_t>(capacity)) != 0) {
+    Fail("ftruncate");
+  }
+  void* base = ::mmap(nullptr, 2 * capacity, PROT_NONE,
+                      MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (base == MAP_FAILED) {
+    Fail("mmap");
+  }
+  auto bytes = static_cast<char*>(base);
+  for (char* half : {bytes, bytes + capacity}) {
+    if (::mmap(half, capacity, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED,
+               fd, 0) == MAP_FAILED) {
+      int error = errno;
+      ::munmap(base, 2 * capacity);
+      errno = error;
+      Fail("mmap");
+    }
+  }
+  return bytes;
+}
+
+}  // namespace
+
+RingBuffer::RingBuffer(size_t capacity)
+    : capacity_(RoundToPages(capacity)) {
+  base_ = MapMirrored(capacity_);
+}
+
+RingBuffer::~RingBuffer() {
+  if (base_ != nullptr) {
+    ::munmap(base_, 2 * capacity_);
+  }
+}
+
+void RingBuffer::remap(size_t capacity) {
+  char* base = MapMirrored(capacity);
+  memcpy(base, ReadIndex(), readable_);
+  ::munmap(base_, 2 * capacity_);
+  base_ = base;
+  capacity_ = capacity;
+  read_index_ = 0;
+}
+
+void RingBuffer::EnsureWritable(size_t n, bool fixed) {
+  if (n <= WritableBytes()) {
+    return;
+  }
+  size_t size = readable_ + n;
+  if (!fixed) {
+    size = std::max(size, capacity_ << 1);
+  }
+  remap(RoundToPages(size));
+}
+
+void RingBuffer::Append(const char* data, size_t n) {
+  EnsureWritable(n, false);
+  memcpy(WriteIndex(), data, n);
+  Append(n);
+}
+
+size_t RingBuffer::Retrieve(char* data, size_t n) {
+  n = std::min(n, ReadableBytes());
+  memcpy(data, ReadIndex(), n);
+  Retrieve(n);
+  return n;
+}
+
+ssize_t RingBuffer::Append(File* source) {
+  if (WritableBytes() == 0) {
+    EnsureWritable(capacity_, true);
+  }
+  ssize_t r = source->Read(WriteIndex(), WritableBytes());
+  if (r > 0) {
+    Append(r);
+  }
+  return r;
+}
+
+ssize_t RingBuffer::Retrieve(File* target) {
+  ssize_t w = target->Write(ReadIndex(), ReadableBytes());
+  if (w > 0) {
+    Retrieve(w);
+  }
+  return w;
+}
+
+void RingBuffer::Append(RingBuffer* buffer) {
+  size_t r = buffer->ReadableBytes();
+  EnsureWritable(r, false);
+  buffer->Retrieve(WriteIndex(), r);
+  Append(r);
+}
+
+void RingBuffer::Retrieve(RingBuffer* buffer) {
+  buffer->Append(ReadIndex(), ReadableBytes());
+  Retrieve(ReadableBytes());
+}
+
+}  // namespace pedrolib
@@ -0,0 +1,302 @@
+#include "pedrolib/buffer/search.h"
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+namespace pedrolib {
+
+namespace {
+
+struct Kernels {
+  SearchIsa isa;
+  const char* (*find_byte)(const char*, const char*, char);
+  const char* (*find_any_of)(const char*, const char*, std::string_view);
+  const char* (*find_pair)(const char*, const char*, char, char);
+};
+
+const char* ScalarFindByte(const char* begin, const char* end, char c) {
+  // memchr is already vectorized by libc; it is the portable baseline.
+  auto p = std::memchr(begin, c, end - begin);
+  return p ? static_cast<const char*>(p) : end;
+}
+
+const char* ScalarFindAnyOf(const char* begin, const char* end,
+                            std::string_view set) {
+  bool table[256]{};
+  for (char c : set) {
+    table[static_cast<uint8_t>(c)] = true;
+  }
+  for (const char* p = begin; p < end; ++p) {
+    if (table[static_cast<uint8_t>(*p)]) {
+      return p;
+    }
+  }
+  return end;
+}
+
+const char* ScalarFindPair(const char* begin, const char* end, char first,
+                           char second) {
+  for (const char* p = begin; end - p >= 2; ++p) {
+    p = ScalarFindByte(p, end - 1, first);
+    if (p == end - 1) {
+      break;
+    }
+    if (p[1] == second) {
+      return p;
+    }
+  }
+  return end;
+}
+
+constexpr Kernels kScalar{SearchIsa::kScalar, ScalarFindByte,
+                          ScalarFindAnyOf, ScalarFindPair};
+
+#if defined(__x86_64__)
+
+constexpr size_t kMaxVectorSet = 16;
+
+// SSE2 is part of x86-64, so these need no target attribute.
+
+const char* Sse2FindByte(const char* begin, const char* end, char c) {
+  const __m128i needle = _mm_set1_epi8(c);
+  const char* p = begin;
+  for (; end - p >= 16; p += 16) {
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+    int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(v, needle));
+    if (mask != 0) {
+      return p + __builtin_ctz(mask);
+    }
+  }
+  for (; p < end; ++p) {
+    if (*p == c) {
+      return p;
+    }
+  }
+  return end;
+}
+
+const char* Sse2FindAnyOf(const char* begin, const char* end,
+                          std::string_view set) {
+  if (set.size() > kMaxVectorSet) {
+    return ScalarFindAnyOf(begin, end, set);
+  }
+  __m128i needles[kMaxVectorSet];
+  for (size_t i = 0; i < set.size(); ++i) {
+    needles[i] = _mm_set1_epi8(set[i]);
+  }
+  const char* p = begin;
+  for (; end - p >= 16; p += 16) {
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+    __m128i hits = _mm_setzero_si128();
+    for (size_t i = 0; i < set.size(); ++i) {
+      hits = _mm_or_si128(hits, _mm_cmpeq_epi8(v, needles[i]));
+    }
+    int mask = _mm_movemask_epi8(hits);
+    if (mask != 0) {
+      return p + __builtin_ctz(mask);
+    }
+  }
+  return ScalarFindAnyOf(p, end, set);
+}
+
+const char* Sse2FindPair(const char* begin, const char* end, char first,
+                         char second) {
+  const __m128i a = _mm_set1_epi8(first);
+  const __m128i b = _mm_set1_epi8(second);
+  const char* p = begin;
+  // Loads at p and p + 1, so the last 16 bytes go to the scalar tail.
+  for (; end - p >= 17; p += 16) {
+    __m128i v0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+    __m128i v1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 1));
+    int mask = _mm_movemask_epi8(
+        _mm_and_si128(_mm_cmpeq_epi8(v0, a), _mm_cmpeq_epi8(v1, b)));
+    if (mask != 0) {
+      return p + __builtin_ctz(mask);
+    }
+  }
+  return ScalarFindPair(p, end, first, second);
+}
+
+constexpr Kernels kSse2{SearchIsa::kSse2, Sse2FindByte, Sse2FindAnyOf,
+                        Sse2FindPair};
+
+__attribute__((target("avx2"))) const char* Avx2FindByte(const char* begin,
+                                                         const char* end,
+                                                         char c) {
+  const __m256i needle = _mm256_set1_epi8(c);
+  const char* p = begin;
+  // Short records are common, so the first vector is checked on its own
+  // before the unrolled loop.
+  if (end - p >= 32) {
+    __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+    auto mask = static_cast<uint32_t>(
+        _mm256_movemask_epi8(_mm256_cmpeq_epi8(v, needle)));
+    if (mask != 0) {
+      return p + __builtin_ctz(mask);
+    }
+    p += 32;
+  }
+  // Four vectors per iteration: one branch per 128 bytes keeps the loop
+  // bound by load throughput.
+  for (; end - p >= 128; p += 128) {
+    auto q = reinterpret_cast<const __m256i*>(p);
+    __m256i e0 = _mm256_cmpeq_epi8(_mm256_loadu_si256(q), needle);
+    __m256i e1 = _mm256_cmpeq_epi8(_mm256_loadu_si256(q + 1), needle);
+    __m256i e2 = _mm256_cmpeq_epi8(_mm256_loadu_si256(q + 2), needle);
+    __m256i e3 = _mm256_cmpeq_epi8(_mm256_loadu_si256(q + 3), needle);
+    __m256i any = _mm256_or_si256(_mm256_or_si256(e0, e1),
+                                  _mm256_or_si256(e2, e3));
+    if (!_mm256_testz_si256(any, any)) {
+      uint64_t low = static_cast<uint32_t>(_mm256_movemask_epi8(e0)) |
+                     uint64_t{static_cast<uint32_t>(_mm256_movemask_epi8(
+                         e1))} << 32;
+      if (low != 0) {
+        return p + __builtin_ctzll(low);
+      }
+      uint64_t high = static_cast<uint32_t>(_mm256_movemask_epi8(e2)) |
+                      uint64_t{static_cast<uint32_t>(_mm256_movemask_epi8(
+                          e3))} << 32;
+      return p + 64 + __builtin_ctzll(high);
+    }
+  }
+  for (; end - p >= 32; p += 32) {
+    __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+    auto mask = static_cast<uint32_t>(
+        _mm256_movemask_epi8(_mm256_cmpeq_epi8(v, needle)));
+    if (mask != 0) {
+      return p + __builtin_ctz(mask);
+    }
+  }
+  return Sse2FindByte(p, end, c);
+}
+
+__attribute__((target("avx2"))) const char* Avx2FindAnyOf(
+    const char* begin, const char* end, std::string_view set) {
+  if (set.size() > kMaxVectorSet) {
+    return ScalarFindAnyOf(begin, end, set);
+  }
+  __m256i needles[kMaxVectorSet];
+  for (size_t i = 0; i < set.size(); ++i) {
+    needles[i] = _mm256_set1_epi8(set[i]);
+  }
+  const char* p = begin;
+  for (; end - p >= 32; p += 32) {
+    __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+    __m256i hits = _mm256_setzero_si256();
+    for (size_t i = 0; i < set.size(); ++i) {
+      hits = _mm256_or_si256(hits, _mm256_cmpeq_epi8(v, needles[i]));
+    }
+    auto mask = static_cast<uint32_t>(_mm256_movemask_epi8(hits));
+    if (mask != 0) {
+      return p + __builtin_ctz(mask);
+    }
+  }
+  return Sse2FindAnyOf(p, end, set);
+}
+
+__attribute__((target("avx2"))) const char* Avx2FindPair(const char* begin,
+                                                         const char* end,
+                                                         char first,
+                                                         char second) {
+  const __m256i a = _mm256_set1_epi8(first);
+  const __m256i b = _mm256_set1_epi8(second);
+  const char* p = begin;
+  for (; end - p >= 33; p += 32) {
+    __m256i v0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+    __m256i v1 =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + 1));
+    auto mask = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_and_si256(
+        _mm256_cmpeq_epi8(v0, a), _mm256_cmpeq_epi8(v1, b))));
+    if (mask != 0) {
+      return p + __builtin_ctz(mask);
+    }
+  }
+  return Sse2FindPair(p, end, first, second);
+}
+
+constexpr Kernels kAvx2{SearchIsa::kAvx2, Avx2FindByte, Avx2FindAnyOf,
+                        Avx2FindPair};
+
+bool Supported(SearchIsa isa) {
+  switch (isa) {
+    case SearchIsa::kAvx2:
+      __builtin_cpu_init();
+      return __builtin_cpu_supports("avx2");
+    default:
+      return true;
+  }
+}
+
+const Kernels* Detect() {
+  // May run from another translation unit's static initializer.
+  __builtin_cpu_init();
+  return __builtin_cpu_supports("avx2") ? &kAvx2 : &kSse2;
+}
+
+const Kernels* Select(SearchIsa isa) {
+  switch (isa) {
+    case SearchIsa::kAvx2:
+      return &kAvx2;
+    case SearchIsa::kSse2:
+      return &kSse2;
+    default:
+      return &kScalar;
+  }
+}
+
+#else
+
+bool Supported(SearchIsa isa) { return isa == SearchIsa::kScalar; }
+
+const Kernels* Detect() { return &kScalar; }
+
+const Kernels* Select(SearchIsa) { return &kScalar; }
+
+#endif
+
+// Detected on first use, so callers in static initializers work too.
+std::atomic<const Kernels*> kernels{nullptr};
+
+const Kernels* Current() noexcept {
+  const Kernels* k = kernels.load(std::memory_order_relaxed);
+  if (k == nullptr) {
+    k = Detect();
+    kernels.store(k, std::memory_order_relaxed);
+  }
+  return k;
+}
+
+}  // namespace
+
+const char* FindByte(const char* begin, const char* end, char c) noexcept {
+  return Current()->find_byte(begin, end, c);
+}
+
+const char* FindAnyOf(const char* begin, const char* end,
+                      std::string_view set) noexcept {
+  if (set.size() == 1) {
+    return FindByte(begin, end, set[0]);
+  }
+  return Current()->find_any_of(begin, end, set);
+}
+
+const char* FindPair(const char* begin, const char* end, char first,
+                     char second) noexcept {
+  return Current()->find_pair(begin, end, first, second);
+}
+
+SearchIsa GetSearchIsa() noexcept { return Current()->isa; }
+
+bool SetSearchIsa(SearchIsa isa) noexcept {
+  if (!Supported(isa)) {
+    return false;
+  }
+  kernels.store(Select(isa), std::memory_order_relaxed);
+  return true;
+}
+
+}  // namespace pedrolib
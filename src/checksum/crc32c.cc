@@ -0,0 +1,234 @@
+#include "pedrolib/checksum/crc32c.h"
+#include <atomic>
+#include <cstring>
+#include <vector>
+#include "pedrolib/executor/executor.h"
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+namespace pedrolib {
+
+namespace {
+
+// Reflected polynomials, zlib style: bit 31 holds x^0.
+constexpr uint32_t kPoly = 0x82f63b78;
+
+constexpr uint32_t MultModP(uint32_t a, uint32_t b) {
+  uint32_t m = uint32_t{1} << 31;
+  uint32_t p = 0;
+  for (;;) {
+    if (a & m) {
+      p ^= b;
+      if ((a & (m - 1)) == 0) {
+        break;
+      }
+    }
+    m >>= 1;
+    b = b & 1 ? (b >> 1) ^ kPoly : b >> 1;
+  }
+  return p;
+}
+
+struct PowerTable {
+  // x^(2^k) mod P.
+  uint32_t x2n[32];
+
+  constexpr PowerTable() : x2n() {
+    uint32_t p = uint32_t{1} << 30;
+    x2n[0] = p;
+    for (int k = 1; k < 32; ++k) {
+      p = MultModP(p, p);
+      x2n[k] = p;
+    }
+  }
+};
+
+constexpr PowerTable kPowers;
+
+// x^n mod P.
+constexpr uint32_t XPow(uint64_t n) {
+  uint32_t p = uint32_t{1} << 31;
+  for (int k = 0; n != 0; n >>= 1, ++k) {
+    if (n & 1) {
+      p = MultModP(kPowers.x2n[k & 31], p);
+    }
+  }
+  return p;
+}
+
+struct SliceTable {
+  uint32_t t[8][256];
+
+  constexpr SliceTable() : t() {
+    for (uint32_t i = 0; i < 256; ++i) {
+      uint32_t c = i;
+      for (int k = 0; k < 8; ++k) {
+        c = c & 1 ? (c >> 1) ^ kPoly : c >> 1;
+      }
+      t[0][i] = c;
+    }
+    for (uint32_t i = 0; i < 256; ++i) {
+      for (int k = 1; k < 8; ++k) {
+        t[k][i] = (t[k - 1][i] >> 8) ^ t[0][t[k - 1][i] & 0xff];
+      }
+    }
+  }
+};
+
+constexpr SliceTable kSlices;
+
+uint64_t Load64(const uint8_t* p) {
+  uint64_t v;
+  std::memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+// The update functions work on the raw register, without the pre- and
+// post-inversion.
+uint32_t TableUpdate(uint32_t crc, const uint8_t* p, size_t n) {
+  const auto& t = kSlices.t;
+  for (; n >= 8; n -= 8, p += 8) {
+    uint64_t v = Load64(p) ^ crc;
+    crc = t[7][v & 0xff] ^ t[6][(v >> 8) & 0xff] ^ t[5][(v >> 16) & 0xff] ^
+          t[4][(v >> 24) & 0xff] ^ t[3][(v >> 32) & 0xff] ^
+          t[2][(v >> 40) & 0xff] ^ t[1][(v >> 48) & 0xff] ^ t[0][v >> 56];
+  }
+  for (; n > 0; --n, ++p) {
+    crc = (crc >> 8) ^ t[0][(crc ^ *p) & 0xff];
+  }
+  return crc;
+}
+
+#if defined(__x86_64__)
+
+// crc32 has a latency of 3 cycles and a throughput of 1, so three
+// independent streams keep the unit busy. Their results are merged by
+// multiplying with x^(8 * block) mod P, computed with one carry-less
+// multiply and one crc32 (which contributes x^33, hence the offset).
+constexpr size_t kLongBlock = 8192;
+constexpr size_t kShortBlock = 256;
+constexpr uint64_t kLongShift = XPow(8 * kLongBlock - 33);
+constexpr uint64_t kShortShift = XPow(8 * kShortBlock - 33);
+
+__attribute__((target("sse4.2,pclmul"))) uint64_t Shift(uint64_t crc,
+                                                        uint64_t k) {
+  __m128i product = _mm_clmulepi64_si128(_mm_cvtsi64_si128(crc),
+                                         _mm_cvtsi64_si128(k), 0);
+  return _mm_crc32_u64(0, _mm_cvtsi128_si64(product));
+}
+
+template <size_t kBlock>
+__attribute__((target("sse4.2,pclmul"), always_inline)) inline uint64_t
+Interleave(uint64_t crc, const uint8_t*& p, size_t& n, uint64_t shift) {
+  while (n >= 3 * kBlock) {
+    uint64_t c1 = 0;
+    uint64_t c2 = 0;
+    for (const uint8_t* end = p + kBlock; p < end; p += 8) {
+      crc = _mm_crc32_u64(crc, Load64(p));
+      c1 = _mm_crc32_u64(c1, Load64(p + kBlock));
+      c2 = _mm_crc32_u64(c2, Load64(p + 2 * kBlock));
+    }
+    crc = Shift(crc, shift) ^ c1;
+    crc = Shift(crc, shift) ^ c2;
+    p += 2 * kBlock;
+    n -= 3 * kBlock;
+  }
+  return crc;
+}
+
+__attribute__((target("sse4.2,pclmul"))) uint32_t HardwareUpdate(
+    uint32_t crc32, const uint8_t* p, size_t n) {
+  uint64_t crc = crc32;
+  for (; n > 0 && (reinterpret_cast<uintptr_t>(p) & 7) != 0; --n, ++p) {
+    crc = _mm_crc32_u8(static_cast<uint32_t>(crc), *p);
+  }
+  crc = Interleave<kLongBlock>(crc, p, n, kLongShift);
+  crc = Interleave<kShortBlock>(crc, p, n, kShortShift);
+  for (; n >= 8; n -= 8, p += 8) {
+    crc = _mm_crc32_u64(crc, Load64(p));
+  }
+  for (; n > 0; --n, ++p) {
+    crc = _mm_crc32_u8(static_cast<uint32_t>(crc), *p);
+  }
+  return static_cast<uint32_t>(crc);
+}
+
+using UpdateFn = uint32_t (*)(uint32_t, const uint8_t*, size_t);
+
+UpdateFn Detect() {
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("sse4.2") && __builtin_cpu_supports("pclmul")) {
+    return HardwareUpdate;
+  }
+  return TableUpdate;
+}
+
+#else
+
+using UpdateFn = uint32_t (*)(uint32_t, const uint8_t*, size_t);
+
+UpdateFn Detect() { return TableUpdate; }
+
+#endif
+
+// Detected on first use, so callers in static initializers work too.
+std::atomic<UpdateFn> update{nullptr};
+
+UpdateFn Update() noexcept {
+  UpdateFn fn = update.load(std::memory_order_relaxed);
+  if (fn == nullptr) {
+    fn = Detect();
+    update.store(fn, std::memory_order_relaxed);
+  }
+  return fn;
+}
+
+}  // namespace
+
+uint32_t Crc32c(const void* data, size_t n, uint32_t crc) noexcept {
+  return ~Update()(~crc, static_cast<const uint8_t*>(data), n);
+}
+
+uint32_t Crc32c(const std::string_view* buf, size_t n, uint32_t crc) noexcept {
+  UpdateFn fn = Update();
+  crc = ~crc;
+  for (size_t i = 0; i < n; ++i) {
+    crc = fn(crc, reinterpret_cast<const uint8_t*>(buf[i].data()),
+             buf[i].size());
+  }
+  return ~crc;
+}
+
+uint32_t Crc32cCombine(uint32_t crc_a, uint32_t crc_b, size_t n) noexcept {
+  return MultModP(XPow(8 * static_cast<uint64_t>(n)), crc_a) ^ crc_b;
+}
+
+uint32_t Crc32c(Executor* executor, const void* data, size_t n) {
+  // Below this a chunk costs less to hash than to hand to a worker.
+  constexpr size_t kMinChunk = 256 << 10;
+
+  size_t chunks = std::min(executor->Size(), n / kMinChunk);
+  if (chunks <= 1) {
+    return Crc32c(data, n);
+  }
+  auto bytes = static_cast<const uint8_t*>(data);
+  size_t chunk = n / chunks;
+  std::vector<uint32_t> crcs(chunks);
+  for_each(executor, size_t{0}, chunks, [&](size_t i) {
+    size_t length = i + 1 == chunks ? n - i * chunk : chunk;
+    crcs[i] = Crc32c(bytes + i * chunk, length);
+  });
+
+  uint32_t crc = crcs[0];
+  for (size_t i = 1; i < chunks; ++i) {
+    size_t length = i + 1 == chunks ? n - i * chunk : chunk;
+    crc = Crc32cCombine(crc, crcs[i], length);
+  }
+  return crc;
+}
+
+bool Crc32cAccelerated() noexcept { return Update() != TableUpdate; }
+
+}  // namespace pedrolib
@@ -0,0 +1,440 @@
+#include "pedrolib/checksum/xxhash.h"
+#include <atomic>
+#include <cstring>
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+namespace pedrolib {
+
+namespace {
+
+constexpr uint64_t kPrime64_1 = 0x9e3779b185ebca87;
+constexpr uint64_t kPrime64_2 = 0xc2b2ae3d27d4eb4f;
+constexpr uint64_t kPrime64_3 = 0x165667b19e3779f9;
+constexpr uint64_t kPrime64_4 = 0x85ebca77c2b2ae63;
+constexpr uint64_t kPrime64_5 = 0x27d4eb2f165667c5;
+constexpr uint32_t kPrime32_1 = 0x9e3779b1;
+constexpr uint32_t kPrime32_2 = 0x85ebca77;
+constexpr uint32_t kPrime32_3 = 0xc2b2ae3d;
+constexpr uint64_t kPrimeMx1 = 0x165667919e3779f9;
+constexpr uint64_t kPrimeMx2 = 0x9fb21c651e98df25;
+
+uint64_t Read64(const uint8_t* p) {
+  uint64_t v;
+  std::memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+uint32_t Read32(const uint8_t* p) {
+  uint32_t v;
+  std::memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+void Write64(uint8_t* p, uint64_t v) { std::memcpy(p, &v, sizeof(v)); }
+
+uint64_t Rotl(uint64_t x, int r) { return (x << r) | (x >> (64 - r)); }
+
+// ---- XXH64 ----
+
+uint64_t Round(uint64_t acc, uint64_t input) {
+  acc += input * kPrime64_2;
+  acc = Rotl(acc, 31);
+  return acc * kPrime64_1;
+}
+
+uint64_t MergeRound(uint64_t acc, uint64_t v) {
+  acc ^= Round(0, v);
+  return acc * kPrime64_1 + kPrime64_4;
+}
+
+uint64_t Avalanche64(uint64_t h) {
+  h ^= h >> 33;
+  h *= kPrime64_2;
+  h ^= h >> 29;
+  h *= kPrime64_3;
+  h ^= h >> 32;
+  return h;
+}
+
+// Consumes 32-byte stripes; returns the bytes left over.
+size_t Stripes(uint64_t v[4], const uint8_t*& p, size_t n) {
+  for (; n >= 32; n -= 32, p += 32) {
+    v[0] = Round(v[0], Read64(p));
+    v[1] = Round(v[1], Read64(p + 8));
+    v[2] = Round(v[2], Read64(p + 16));
+    v[3] = Round(v[3], Read64(p + 24));
+  }
+  return n;
+}
+
+uint64_t Converge(const uint64_t v[4]) {
+  uint64_t h = Rotl(v[0], 1) + Rotl(v[1], 7) + Rotl(v[2], 12) + Rotl(v[3], 18);
+  for (int i = 0; i < 4; ++i) {
+    h = MergeRound(h, v[i]);
+  }
+  return h;
+}
+
+uint64_t Finalize64(uint64_t h, const uint8_t* p, size_t n) {
+  for (; n >= 8; n -= 8, p += 8) {
+    h ^= Round(0, Read64(p));
+    h = Rotl(h, 27) * kPrime64_1 + kPrime64_4;
+  }
+  if (n >= 4) {
+    h ^= Read32(p) * kPrime64_1;
+    h = Rotl(h, 23) * kPrime64_2 + kPrime64_3;
+    p += 4;
+    n -= 4;
+  }
+  for (; n > 0; --n, ++p) {
+    h ^= *p * kPrime64_5;
+    h = Rotl(h, 11) * kPrime64_1;
+  }
+  return Avalanche64(h);
+}
+
+void InitLanes(uint64_t v[4], uint64_t seed) {
+  v[0] = seed + kPrime64_1 + kPrime64_2;
+  v[1] = seed + kPrime64_2;
+  v[2] = seed;
+  v[3] = seed - kPrime64_1;
+}
+
+// ---- XXH3 ----
+
+constexpr size_t kSecretSize = 192;
+constexpr size_t kStripeLen = 64;
+constexpr size_t kSecretConsumeRate = 8;
+constexpr size_t kSecretLastAccStart = 7;
+constexpr size_t kSecretMergeAccsStart = 11;
+constexpr size_t kMidSizeMax = 240;
+constexpr size_t kMidSizeStartOffset = 3;
+constexpr size_t kMidSizeLastOffset = 17;
+constexpr size_t kSecretSizeMin = 136;
+
+alignas(64) constexpr uint8_t kSecret[kSecretSize] = {
+    0xb8, 0xfe, 0x6c, 0x39, 0x23, 0xa4, 0x4b, 0xbe, 0x7c, 0x01, 0x81, 0x2c,
+    0xf7, 0x21, 0xad, 0x1c, 0xde, 0xd4, 0x6d, 0xe9, 0x83, 0x90, 0x97, 0xdb,
+    0x72, 0x40, 0xa4, 0xa4, 0xb7, 0xb3, 0x67, 0x1f, 0xcb, 0x79, 0xe6, 0x4e,
+    0xcc, 0xc0, 0xe5, 0x78, 0x82, 0x5a, 0xd0, 0x7d, 0xcc, 0xff, 0x72, 0x21,
+    0xb8, 0x08, 0x46, 0x74, 0xf7, 0x43, 0x24, 0x8e, 0xe0, 0x35, 0x90, 0xe6,
+    0x81, 0x3a, 0x26, 0x4c, 0x3c, 0x28, 0x52, 0xbb, 0x91, 0xc3, 0x00, 0xcb,
+    0x88, 0xd0, 0x65, 0x8b, 0x1b, 0x53, 0x2e, 0xa3, 0x71, 0x64, 0x48, 0x97,
+    0xa2, 0x0d, 0xf9, 0x4e, 0x38, 0x19, 0xef, 0x46, 0xa9, 0xde, 0xac, 0xd8,
+    0xa8, 0xfa, 0x76, 0x3f, 0xe3, 0x9c, 0x34, 0x3f, 0xf9, 0xdc, 0xbb, 0xc7,
+    0xc7, 0x0b, 0x4f, 0x1d, 0x8a, 0x51, 0xe0, 0x4b, 0xcd, 0xb4, 0x59, 0x31,
+    0xc8, 0x9f, 0x7e, 0xc9, 0xd9, 0x78, 0x73, 0x64, 0xea, 0xc5, 0xac, 0x83,
+    0x34, 0xd3, 0xeb, 0xc3, 0xc5, 0x81, 0xa0, 0xff, 0xfa, 0x13, 0x63, 0xeb,
+    0x17, 0x0d, 0xdd, 0x51, 0xb7, 0xf0, 0xda, 0x49, 0xd3, 0x16, 0x55, 0x26,
+    0x29, 0xd4, 0x68, 0x9e, 0x2b, 0x16, 0xbe, 0x58, 0x7d, 0x47, 0xa1, 0xfc,
+    0x8f, 0xf8, 0xb8, 0xd1, 0x7a, 0xd0, 0x31, 0xce, 0x45, 0xcb, 0x3a, 0x8f,
+    0x95, 0x16, 0x04, 0x28, 0xaf, 0xd7, 0xfb, 0xca, 0xbb, 0x4b, 0x40, 0x7e,
+};
+
+uint64_t Mul128Fold64(uint64_t lhs, uint64_t rhs) {
+  __uint128_t product = static_cast<__uint128_t>(lhs) * rhs;
+  return static_cast<uint64_t>(product) ^
+         static_cast<uint64_t>(product >> 64);
+}
+
+uint64_t XorShift(uint64_t v, int shift) { return v ^ (v >> shift); }
+
+uint64_t Avalanche3(uint64_t h) {
+  h = XorShift(h, 37);
+  h *= kPrimeMx1;
+  return XorShift(h, 32);
+}
+
+uint64_t Rrmxmx(uint64_t h, uint64_t n) {
+  h ^= Rotl(h, 49) ^ Rotl(h, 24);
+  h *= kPrimeMx2;
+  h ^= (h >> 35) + n;
+  h *= kPrimeMx2;
+  return XorShift(h, 28);
+}
+
+uint64_t Len1To3(const uint8_t* p, size_t n, const uint8_t* secret,
+                 uint64_t seed) {
+  uint32_t combined = (uint32_t{p[0]} << 16) | (uint32_t{p[n >> 1]} << 24) |
+                      uint32_t{p[n - 1]} | (static_cast<uint32_t>(n) << 8);
+  uint64_t bitflip = (Read32(secret) ^ Read32(secret + 4)) + seed;
+  return Avalanche64(combined ^ bitflip);
+}
+
+uint64_t Len4To8(const uint8_t* p, size_t n, const uint8_t* secret,
+                 uint64_t seed) {
+  seed ^= uint64_t{__builtin_bswap32(static_cast<uint32_t>(seed))} << 32;
+  uint32_t input1 = Read32(p);
+  uint32_t input2 = Read32(p + n - 4);
+  uint64_t bitflip = (Read64(secret + 8) ^ Read64(secret + 16)) - seed;
+  uint64_t input64 = input2 + (uint64_t{input1} << 32);
+  return Rrmxmx(input64 ^ bitflip, n);
+}
+
+uint64_t Len9To16(const uint8_t* p, size_t n, const uint8_t* secret,
+                  uint64_t seed) {
+  uint64_t bitflip1 = (Read64(secret + 24) ^ Read64(secret + 32)) + seed;
+  uint64_t bitflip2 = (Read64(secret + 40) ^ Read64(secret + 48)) - seed;
+  uint64_t lo = Read64(p) ^ bitflip1;
+  uint64_t hi = Read64(p + n - 8) ^ bitflip2;
+  uint64_t acc = n + __builtin_bswap64(lo) + hi + Mul128Fold64(lo, hi);
+  return Avalanche3(acc);
+}
+
+uint64_t Mix16(const uint8_t* p, const uint8_t* secret, uint64_t seed) {
+  return Mul128Fold64(Read64(p) ^ (Read64(secret) + seed),
+                      Read64(p + 8) ^ (Read64(secret + 8) - seed));
+}
+
+uint64_t Len17To128(const uint8_t* p, size_t n, const uint8_t* secret,
+                    uint64_t seed) {
+  uint64_t acc = n * kPrime64_1;
+  if (n > 32) {
+    if (n > 64) {
+      if (n > 96) {
+        acc += Mix16(p + 48, secret + 96, seed);
+        acc += Mix16(p + n - 64, secret + 112, seed);
+      }
+      acc += Mix16(p + 32, secret + 64, seed);
+      acc += Mix16(p + n - 48, secret + 80, seed);
+    }
+    acc += Mix16(p + 16, secret + 32, seed);
+    acc += Mix16(p + n - 32, secret + 48, seed);
+  }
+  acc += Mix16(p, secret, seed);
+  acc += Mix16(p + n - 16, secret + 16, seed);
+  return Avalanche3(acc);
+}
+
+uint64_t Len129To240(const uint8_t* p, size_t n, const uint8_t* secret,
+                     uint64_t seed) {
+  uint64_t acc = n * kPrime64_1;
+  size_t rounds = n / 16;
+  for (size_t i = 0; i < 8; ++i) {
+    acc += Mix16(p + 16 * i, secret + 16 * i, seed);
+  }
+  uint64_t acc_end =
+      Mix16(p + n - 16, secret + kSecretSizeMin - kMidSizeLastOffset, seed);
+  acc = Avalanche3(acc);
+  for (size_t i = 8; i < rounds; ++i) {
+    acc_end +=
+        Mix16(p + 16 * i, secret + 16 * (i - 8) + kMidSizeStartOffset, seed);
+  }
+  return Avalanche3(acc + acc_end);
+}
+
+void ScalarAccumulate512(uint64_t* acc, const uint8_t* p,
+                         const uint8_t* secret) {
+  for (size_t i = 0; i < 8; ++i) {
+    uint64_t value = Read64(p + 8 * i);
+    uint64_t key = value ^ Read64(secret + 8 * i);
+    acc[i ^ 1] += value;
+    acc[i] += (key & 0xffffffff) * (key >> 32);
+  }
+}
+
+void ScalarScramble(uint64_t* acc, const uint8_t* secret) {
+  for (size_t i = 0; i < 8; ++i) {
+    uint64_t a = XorShift(acc[i], 47);
+    a ^= Read64(secret + 8 * i);
+    acc[i] = a * kPrime32_1;
+  }
+}
+
+uint64_t MergeAccs(const uint64_t* acc, const uint8_t* secret,
+                   uint64_t start) {
+  uint64_t result = start;
+  for (size_t i = 0; i < 4; ++i) {
+    result += Mul128Fold64(acc[2 * i] ^ Read64(secret + 16 * i),
+                           acc[2 * i + 1] ^ Read64(secret + 16 * i + 8));
+  }
+  return Avalanche3(result);
+}
+
+template <void (*kAccumulate)(uint64_t*, const uint8_t*, const uint8_t*),
+          void (*kScramble)(uint64_t*, const uint8_t*)>
+uint64_t HashLong(const uint8_t* p, size_t n, const uint8_t* secret) {
+  alignas(64) uint64_t acc[8] = {kPrime32_3, kPrime64_1, kPrime64_2,
+                                 kPrime64_3, kPrime64_4, kPrime32_2,
+                                 kPrime64_5, kPrime32_1};
+  constexpr size_t kStripesPerBlock =
+      (kSecretSize - kStripeLen) / kSecretConsumeRate;
+  constexpr size_t kBlockLen = kStripeLen * kStripesPerBlock;
+  size_t blocks = (n - 1) / kBlockLen;
+
+  for (size_t b = 0; b < blocks; ++b) {
+    for (size_t s = 0; s < kStripesPerBlock; ++s) {
+      kAccumulate(acc, p + b * kBlockLen + s * kStripeLen,
+                  secret + s * kSecretConsumeRate);
+    }
+    kScramble(acc, secret + kSecretSize - kStripeLen);
+  }
+
+  size_t stripes = ((n - 1) - kBlockLen * blocks) / kStripeLen;
+  for (size_t s = 0; s < stripes; ++s) {
+    kAccumulate(acc, p + blocks * kBlockLen + s * kStripeLen,
+                secret + s * kSecretConsumeRate);
+  }
+  kAccumulate(acc, p + n - kStripeLen,
+              secret + kSecretSize - kStripeLen - kSecretLastAccStart);
+  return MergeAccs(acc, secret + kSecretMergeAccsStart, n * kPrime64_1);
+}
+
+using HashLongFn = uint64_t (*)(const uint8_t*, size_t, const uint8_t*);
+
+#if defined(__x86_64__)
+
+__attribute__((target("avx2"))) inline void Avx2Accumulate512(
+    uint64_t* acc, const uint8_t* p, const uint8_t* secret) {
+  auto xacc = reinterpret_cast<__m256i*>(acc);
+  for (int i = 0; i < 2; ++i) {
+    __m256i data =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p) + i);
+    __m256i key =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(secret) + i);
+    __m256i data_key = _mm256_xor_si256(data, key);
+    __m256i product =
+        _mm256_mul_epu32(data_key, _mm256_srli_epi64(data_key, 32));
+    __m256i swapped = _mm256_shuffle_epi32(data, _MM_SHUFFLE(1, 0, 3, 2));
+    __m256i sum = _mm256_add_epi64(_mm256_load_si256(xacc + i), swapped);
+    _mm256_store_si256(xacc + i, _mm256_add_epi64(product, sum));
+  }
+}
+
+__attribute__((target("avx2"))) inline void Avx2Scramble(
+    uint64_t* acc, const uint8_t* secret) {
+  auto xacc = reinterpret_cast<__m256i*>(acc);
+  const __m256i prime = _mm256_set1_epi32(static_cast<int>(kPrime32_1));
+  for (int i = 0; i < 2; ++i) {
+    __m256i a = _mm256_load_si256(xacc + i);
+    a = _mm256_xor_si256(a, _mm256_srli_epi64(a, 47));
+    __m256i key =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(secret) + i);
+    __m256i data_key = _mm256_xor_si256(a, key);
+    __m256i hi = _mm256_shuffle_epi32(data_key, _MM_SHUFFLE(0, 3, 0, 1));
+    __m256i product_lo = _mm256_mul_epu32(data_key, prime);
+    __m256i product_hi = _mm256_mul_epu32(hi, prime);
+    _mm256_store_si256(
+        xacc + i,
+        _mm256_add_epi64(product_lo, _mm256_slli_epi64(product_hi, 32)));
+  }
+}
+
+__attribute__((target("avx2"))) uint64_t Avx2HashLong(const uint8_t* p,
+                                                     size_t n,
+                                                     const uint8_t* secret) {
+  return HashLong<Avx2Accumulate512, Avx2Scramble>(p, n, secret);
+}
+
+HashLongFn Detect() {
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2")) {
+    return Avx2HashLong;
+  }
+  return HashLong<ScalarAccumulate512, ScalarScramble>;
+}
+
+#else
+
+HashLongFn Detect() { return HashLong<ScalarAccumulate512, ScalarScramble>; }
+
+#endif
+
+std::atomic<HashLongFn> hash_long{nullptr};
+
+HashLongFn GetHashLong() noexcept {
+  HashLongFn fn = hash_long.load(std::memory_order_relaxed);
+  if (fn == nullptr) {
+    fn = Detect();
+    hash_long.store(fn, std::memory_order_relaxed);
+  }
+  return fn;
+}
+
+}  // namespace
+
+uint64_t Xxh64(const void* data, size_t n, uint64_t seed) noexcept {
+  auto p = static_cast<const uint8_t*>(data);
+  uint64_t h;
+  size_t rest = n;
+  if (n >= 32) {
+    uint64_t v[4];
+    InitLanes(v, seed);
+    rest = Stripes(v, p, n);
+    h = Converge(v);
+  } else {
+    h = seed + kPrime64_5;
+  }
+  return Finalize64(h + n, p, rest);
+}
+
+uint64_t Xxh3(const void* data, size_t n, uint64_t seed) noexcept {
+  auto p = static_cast<const uint8_t*>(data);
+  if (n <= 16) {
+    if (n > 8) {
+      return Len9To16(p, n, kSecret, seed);
+    }
+    if (n >= 4) {
+      return Len4To8(p, n, kSecret, seed);
+    }
+    if (n > 0) {
+      return Len1To3(p, n, kSecret, seed);
+    }
+    return Avalanche64(seed ^ (Read64(kSecret + 56) ^ Read64(kSecret + 64)));
+  }
+  if (n <= 128) {
+    return Len17To128(p, n, kSecret, seed);
+  }
+  if (n <= kMidSizeMax) {
+    return Len129To240(p, n, kSecret, seed);
+  }
+  if (seed == 0) {
+    return GetHashLong()(p, n, kSecret);
+  }
+  // Long inputs fold the seed into a derived secret.
+  alignas(64) uint8_t secret[kSecretSize];
+  for (size_t i = 0; i < kSecretSize / 16; ++i) {
+    Write64(secret + 16 * i, Read64(kSecret + 16 * i) + seed);
+    Write64(secret + 16 * i + 8, Read64(kSecret + 16 * i + 8) - seed);
+  }
+  return GetHashLong()(p, n, secret);
+}
+
+void Xxh64Hasher::Reset(uint64_t seed) noexcept {
+  seed_ = seed;
+  InitLanes(v_, seed);
+  buffered_ = 0;
+  length_ = 0;
+}
+
+void Xxh64Hasher::Update(const void* data, size_t n) noexcept {
+  auto p = static_cast<const uint8_t*>(data);
+  length_ += n;
+  if (buffered_ + n < sizeof(buffer_)) {
+    std::memcpy(buffer_ + buffered_, p, n);
+    buffered_ += static_cast<uint32_t>(n);
+    return;
+  }
+  if (buffered_ != 0) {
+    size_t fill = sizeof(buffer_) - buffered_;
+    std::memcpy(buffer_ + buffered_, p, fill);
+    const uint8_t* q = buffer_;
+    Stripes(v_, q, sizeof(buffer_));
+    p += fill;
+    n -= fill;
+    buffered_ = 0;
+  }
+  n = Stripes(v_, p, n);
+  std::memcpy(buffer_, p, n);
+  buffered_ = static_cast<uint32_t>(n);
+}
+
+uint64_t Xxh64Hasher::Value() const noexcept {
+  uint64_t h = length_ >= 32 ? Converge(v_) : seed_ + kPrime64_5;
+  return Finalize64(h + length_, buffer_, buffered_);
+}
+
+}  // namespace pedrolib
@@ -0,0 +1,162 @@
+#include "pedrolib/clock.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#include <x86intrin.h>
+#define PEDROLIB_HAS_TSC
+#endif
+
+namespace pedrolib {
+
+namespace {
+
+int64_t ClockGettime(clockid_t id) noexcept {
+  struct timespec ts {};
+  clock_gettime(id, &ts);
+  return ts.tv_sec * Duration::kNanoseconds + ts.tv_nsec;
+}
+
+struct TscCalibration {
+  int64_t base_nsecs;
+  uint64_t base_cycles;
+  uint64_t mult;
+};
+
+// Null while reading CLOCK_MONOTONIC. Each calibration is published whole
+// and never freed, since a reader may still hold a previous one.
+std::atomic<const TscCalibration*> tsc{nullptr};
+std::mutex source_mu;
+
+#ifdef PEDROLIB_HAS_TSC
+bool HasInvariantTsc() {
+  unsigned int eax, ebx, ecx, edx;
+  if (!__get_cpuid(0x80000000, &eax, &ebx, &ecx, &edx) || eax < 0x80000007) {
+    return false;
+  }
+  __get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx);
+  return edx & (1u << 8);
+}
+
+bool CalibrateTsc(TscCalibration* calibration) {
+  if (!HasInvariantTsc()) {
+    return false;
+  }
+
+  int64_t t0 = ClockGettime(CLOCK_MONOTONIC);
+  uint64_t c0 = __rdtsc();
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  int64_t t1 = ClockGettime(CLOCK_MONOTONIC);
+  uint64_t c1 = __rdtsc();
+  if (c1 <= c0 || t1 <= t0) {
+    return false;
+  }
+
+  calibration->mult =
+      (static_cast<unsigned __int128>(t1 - t0) << 32) / (c1 - c0);
+  calibration->base_cycles = __rdtsc();
+  calibration->base_nsecs = ClockGettime(CLOCK_MONOTONIC);
+  return true;
+}
+#endif
+
+struct CoarseTicker {
+  std::atomic<int64_t> wall{};
+  std::atomic<int64_t> monotonic{};
+
+  std::mutex mu;
+  std::condition_variable stop;
+  bool stopped{false};
+  std::thread thread;
+
+  void Tick() noexcept {
+    wall.store(Timestamp::Now().usecs, std::memory_order_relaxed);
+    monotonic.store(MonotonicClock::Now().usecs, std::memory_order_relaxed);
+  }
+
+  CoarseTicker() {
+    Tick();
+    thread = std::thread([this] {
+      auto interval = std::chrono::microseconds(CoarseClock::kResolutionUsecs);
+      std::unique_lock<std::mutex> lock(mu);
+      while (!stop.wait_for(lock, interval, [this] { return stopped; })) {
+        Tick();
+      }
+    });
+  }
+
+  // Stops refreshing; later reads return the last values.
+  void Stop() {
+    {
+      std::unique_lock<std::mutex> lock(mu);
+      stopped = true;
+    }
+    stop.notify_one();
+    thread.join();
+  }
+};
+
+// The ticker is never freed, so CoarseClock stays readable from other
+// static destructors after the thread has been joined at exit.
+CoarseTicker& GetCoarseTicker() {
+  static auto* ticker = [] {
+    auto* ticker = new CoarseTicker();
+    std::atexit([] { GetCoarseTicker().Stop(); });
+    return ticker;
+  }();
+  return *ticker;
+}
+
+}  // namespace
+
+int64_t MonotonicClock::Nanoseconds() noexcept {
+#ifdef PEDROLIB_HAS_TSC
+  if (const TscCalibration* c = tsc.load(std::memory_order_acquire)) {
+    uint64_t cycles = __rdtsc() - c->base_cycles;
+    auto nsecs = (static_cast<unsigned __int128>(cycles) * c->mult) >> 32;
+    return c->base_nsecs + static_cast<int64_t>(nsecs);
+  }
+#endif
+  return ClockGettime(CLOCK_MONOTONIC);
+}
+
+bool MonotonicClock::SetSource(Source s) {
+  std::unique_lock<std::mutex> lock(source_mu);
+  if (s == GetSource()) {
+    return true;
+  }
+  if (s == Source::kClockGettime) {
+    tsc.store(nullptr, std::memory_order_release);
+    return true;
+  }
+
+#ifdef PEDROLIB_HAS_TSC
+  auto calibration = std::make_unique<TscCalibration>();
+  if (CalibrateTsc(calibration.get())) {
+    tsc.store(calibration.release(), std::memory_order_release);
+    return true;
+  }
+#endif
+  return false;
+}
+
+MonotonicClock::Source MonotonicClock::GetSource() noexcept {
+  return tsc.load(std::memory_order_acquire) ? Source::kTsc
+                                             : Source::kClockGettime;
+}
+
+Timestamp CoarseClock::Now() noexcept {
+  return Timestamp{GetCoarseTicker().wall.load(std::memory_order_relaxed)};
+}
+
+Timestamp CoarseClock::Monotonic() noexcept {
+  return Timestamp{
+      GetCoarseTicker().monotonic.load(std::memory_order_relaxed)};
+}
+
+}  // namespace pedrolib
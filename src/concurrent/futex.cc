@@ -0,0 +1,39 @@
+#include "pedrolib/concurrent/futex.h"
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <ctime>
+
+namespace pedrolib {
+
+namespace {
+long Futex(std::atomic<uint32_t>* word, int op, uint32_t value,
+           const struct timespec* timeout) noexcept {
+  static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t));
+  return ::syscall(SYS_futex, reinterpret_cast<uint32_t*>(word), op, value,
+                   timeout, nullptr, 0);
+}
+}  // namespace
+
+void FutexWait(std::atomic<uint32_t>* word, uint32_t expected) noexcept {
+  Futex(word, FUTEX_WAIT_PRIVATE, expected, nullptr);
+}
+
+bool FutexWait(std::atomic<uint32_t>* word, uint32_t expected,
+               const Duration& timeout) noexcept {
+  int64_t usecs = std::max<int64_t>(timeout.Microseconds(), 0);
+  struct timespec ts {
+    .tv_sec = static_cast<time_t>(usecs / Duration::kMicroseconds),
+    .tv_nsec = static_cast<long>(usecs % Duration::kMicroseconds * 1000),
+  };
+  return Futex(word, FUTEX_WAIT_PRIVATE, expected, &ts) == 0 ||
+         errno != ETIMEDOUT;
+}
+
+void FutexWake(std::atomic<uint32_t>* word, int n) noexcept {
+  Futex(word, FUTEX_WAKE_PRIVATE, static_cast<uint32_t>(n), nullptr);
+}
+
+}  // namespace pedrolib
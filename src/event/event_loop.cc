@@ -0,0 +1,500 @@
+#include "pedrolib/event/event_loop.h"
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+#include <algorithm>
+#include <system_error>
+#include "pedrolib/clock.h"
+#include "pedrolib/logger/logger.h"
+
+namespace pedrolib {
+
+using detail::Channel;
+using detail::LoopExit;
+using detail::LoopTimer;
+using detail::LoopTimerEntry;
+
+namespace {
+
+// epoll data for the internal descriptors; channels are never at these
+// addresses.
+constexpr uint64_t kWakeupToken = 0;
+constexpr uint64_t kTimerToken = 1;
+
+constexpr size_t kInitialEvents = 128;
+constexpr size_t kMaxEvents = 64 * 1024;
+
+uint32_t ToEpoll(uint32_t mask, Trigger trigger) {
+  uint32_t events = 0;
+  if (mask & kReadable) {
+    events |= EPOLLIN | EPOLLRDHUP;
+  }
+  if (mask & kWritable) {
+    events |= EPOLLOUT;
+  }
+  if (trigger == Trigger::kEdge) {
+    events |= EPOLLET;
+  }
+  return events;
+}
+
+uint32_t FromEpoll(uint32_t events) {
+  uint32_t mask = 0;
+  if (events & (EPOLLIN | EPOLLPRI)) {
+    mask |= kReadable;
+  }
+  if (events & EPOLLOUT) {
+    mask |= kWritable;
+  }
+  if (events & (EPOLLHUP | EPOLLRDHUP)) {
+    mask |= kHangup;
+  }
+  if (events & EPOLLERR) {
+    mask |= kFailed;
+  }
+  return mask;
+}
+
+int CheckFd(int fd, const char* what) {
+  if (fd < 0) {
+    throw std::system_error(errno, std::generic_category(), what);
+  }
+  return fd;
+}
+
+// Never destroyed: a detached loop thread may still log during exit.
+Logger& GetLogger() {
+  static Logger* logger = [] {
+    auto logger = new Logger("pedrolib.event_loop");
+    logger->SetLevel(Logger::Level::kError);
+    return logger;
+  }();
+  return *logger;
+}
+
+// A throwing callback is logged and dropped rather than taking the loop
+// thread, and with it the process, down.
+template <typename F, typename... Args>
+void Invoke(F& f, Args... args) {
+  try {
+    f(args...);
+  } catch (const std::exception& e) {
+    PEDROLIB_LOG_ERROR(GetLogger(), "event loop callback threw: {}",
+                       e.what());
+  } catch (...) {
+    PEDROLIB_LOG_ERROR(GetLogger(), "event loop callback threw");
+  }
+}
+
+void Watch(int epoll_fd, int fd, uint64_t token) {
+  struct epoll_event event {};
+  event.events = EPOLLIN;
+  event.data.u64 = token;
+  if (::epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &event) < 0) {
+    throw std::system_error(errno, std::generic_category(), "epoll_ctl");
+  }
+}
+
+}  // namespace
+
+EventLoop::EventLoop() {
+  epoll_fd_ = CheckFd(::epoll_create1(EPOLL_CLOEXEC), "epoll_create1");
+  wakeup_fd_ =
+      CheckFd(::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC), "eventfd");
+  timer_fd_ = CheckFd(
+      ::timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC),
+      "timerfd_create");
+  Watch(epoll_fd_, wakeup_fd_, kWakeupToken);
+  Watch(epoll_fd_, timer_fd_, kTimerToken);
+  thread_ = std::thread([this] { loop(); });
+}
+
+EventLoop::~EventLoop() {
+  Close();
+  if (InLoop()) {
+    exit_->destroyed = true;
+    std::unique_lock<std::mutex> lock(mu_);
+    for (auto& [_, channel] : channels_) {
+      exit_->channels.push_back(channel);
+    }
+    exit_->channels.insert(exit_->channels.end(), removed_.begin(),
+                           removed_.end());
+    channels_.clear();
+    removed_.clear();
+    thread_.detach();
+  } else {
+    Join();
+  }
+  for (auto& [_, channel] : channels_) {
+    delete channel;
+  }
+  for (Channel* channel : removed_) {
+    delete channel;
+  }
+  ::close(timer_fd_);
+  ::close(wakeup_fd_);
+  ::close(epoll_fd_);
+}
+
+void EventLoop::wakeup() noexcept {
+  if (notified_.exchange(true, std::memory_order_acq_rel)) {
+    return;
+  }
+  uint64_t one = 1;
+  while (::write(wakeup_fd_, &one, sizeof(one)) < 0 && errno == EINTR) {
+  }
+}
+
+Error EventLoop::Register(const File& file, uint32_t mask, Trigger trigger,
+                          EventHandler handler) {
+  int fd = file.Descriptor();
+  auto channel = new Channel{fd, std::move(handler)};
+
+  std::unique_lock<std::mutex> lock(mu_);
+  if (channels_.count(fd) != 0) {
+    delete channel;
+    return Error(EEXIST);
+  }
+  struct epoll_event event {};
+  event.events = ToEpoll(mask, trigger);
+  event.data.ptr = channel;
+  if (::epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &event) < 0) {
+    delete channel;
+    return Error(errno);
+  }
+  channels_.emplace(fd, channel);
+  return Error::Success();
+}
+
+Error EventLoop::Modify(const File& file, uint32_t mask, Trigger trigger) {
+  int fd = file.Descriptor();
+  std::unique_lock<std::mutex> lock(mu_);
+  auto it = channels_.find(fd);
+  if (it == channels_.end()) {
+    return Error(ENOENT);
+  }
+  struct epoll_event event {};
+  event.events = ToEpoll(mask, trigger);
+  event.data.ptr = it->second;
+  if (::epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, fd, &event) < 0) {
+    return Error(errno);
+  }
+  return Error::Success();
+}
+
+Error EventLoop::Unregister(const File& file) {
+  int fd = file.Descriptor();
+  std::unique_lock<std::mutex> lock(mu_);
+  auto it = channels_.find(fd);
+  if (it == channels_.end()) {
+    return Error(ENOENT);
+  }
+  Channel* channel = it->second;
+  channels_.erase(it);
+
+  // Events already returned by epoll_wait may still point at the channel,
+  // so it is freed by the loop after the current batch.
+  channel->removed.store(true, std::memory_order_release);
+  removed_.push_back(channel);
+  if (::epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, fd, nullptr) < 0 &&
+      errno != EBADF) {
+    return Error(errno);
+  }
+  return Error::Success();
+}
+
+void EventLoop::Schedule(Callback cb) {
+  {
+    std::unique_lock<std::mutex> lock(mu_);
+    tasks_.push_back(std::move(cb));
+  }
+  wakeup();
+}
+
+void EventLoop::ScheduleBatch(Callback* cbs, size_t n, Priority) {
+  if (n == 0) {
+    return;
+  }
+  {
+    std::unique_lock<std::mutex> lock(mu_);
+    for (size_t i = 0; i < n; ++i) {
+      tasks_.push_back(std::move(cbs[i]));
+    }
+  }
+  wakeup();
+}
+
+void EventLoop::add_timer(uint64_t id, Timestamp expired) {
+  timers_.push_back({expired, id});
+  std::push_heap(timers_.begin(), timers_.end());
+  arm();
+}
+
+void EventLoop::arm() {
+  if (timers_.empty() || timers_.front().expired == armed_) {
+    return;
+  }
+  armed_ = timers_.front().expired;
+  int64_t usecs = (armed_ - MonotonicClock::Now()).usecs;
+  // A zero it_value disarms the timer, so overdue deadlines fire in 1us.
+  usecs = std::max<int64_t>(usecs, 1);
+
+  struct itimerspec spec {};
+  spec.it_value.tv_sec = usecs / 1000000;
+  spec.it_value.tv_nsec = (usecs % 1000000) * 1000;
+  ::timerfd_settime(timer_fd_, 0, &spec, nullptr);
+}
+
+void EventLoop::run_timers() {
+  // Read up front: a callback may destroy the loop.
+  LoopExit* exit = exit_;
+  armed_ = Timestamp{};
+  Timestamp now = MonotonicClock::Now();
+  while (!timers_.empty() && timers_.front().expired <= now) {
+    std::pop_heap(timers_.begin(), timers_.end());
+    LoopTimerEntry entry = timers_.back();
+    timers_.pop_back();
+
+    auto it = timer_callbacks_.find(entry.id);
+    if (it == timer_callbacks_.end()) {
+      // Canceled.
+      continue;
+    }
+    if (it->second.interval == Duration::Zero()) {
+      Callback callback = std::move(it->second.callback);
+      timer_callbacks_.erase(it);
+      Invoke(callback);
+      if (exit->destroyed) {
+        return;
+      }
+      continue;
+    }
+
+    // The callback may cancel its own timer, which erases the entry.
+    Callback callback = std::move(it->second.callback);
+    Invoke(callback);
+    if (exit->destroyed) {
+      return;
+    }
+    it = timer_callbacks_.find(entry.id);
+    if (it != timer_callbacks_.end()) {
+      it->second.callback = std::move(callback);
+      timers_.push_back({MonotonicClock::Now() + it->second.interval,
+                         entry.id});
+      std::push_heap(timers_.begin(), timers_.end());
+    }
+  }
+  arm();
+}
+
+uint64_t EventLoop::schedule(Duration delay, Duration interval,
+                             Callback cb) {
+  uint64_t id = timer_ids_.fetch_add(1, std::memory_order_relaxed);
+  Timestamp expired = MonotonicClock::Now() + delay;
+  auto add = [this, id, expired, interval, cb = std::move(cb)]() mutable {
+    timer_callbacks_.emplace(id, LoopTimer{interval, std::move(cb)});
+    add_timer(id, expired);
+  };
+  if (InLoop()) {
+    add();
+  } else {
+    Schedule(std::move(add));
+  }
+  return id;
+}
+
+uint64_t EventLoop::ScheduleAfter(Duration delay, Callback cb) {
+  return schedule(delay, Duration::Zero(), std::move(cb));
+}
+
+uint64_t EventLoop::ScheduleEvery(Duration delay, Duration interval,
+                                  Callback cb) {
+  return schedule(delay, interval, std::move(cb));
+}
+
+void EventLoop::ScheduleCancel(uint64_t id) {
+  auto cancel = [this, id] {
+    timer_callbacks_.erase(id);
+    // Canceled entries stay in the heap until they expire; rebuild it when
+    // they make up most of it.
+    if (timers_.size() > 2 * timer_callbacks_.size() + 64) {
+      timers_.erase(std::remove_if(timers_.begin(), timers_.end(),
+                                   [this](const LoopTimerEntry& entry) {
+                                     return timer_callbacks_.count(
+                                                entry.id) == 0;
+                                   }),
+                    timers_.end());
+      std::make_heap(timers_.begin(), timers_.end());
+    }
+  };
+  if (InLoop()) {
+    cancel();
+  } else {
+    Schedule(std::move(cancel));
+  }
+}
+
+void EventLoop::run_tasks() {
+  LoopExit* exit = exit_;
+  std::vector<Callback> tasks;
+  {
+    std::unique_lock<std::mutex> lock(mu_);
+    tasks.swap(tasks_);
+  }
+  for (auto& task : tasks) {
+    Invoke(task);
+    if (exit->destroyed) {
+      return;
+    }
+  }
+}
+
+void EventLoop::loop() {
+  LoopExit exit;
+  exit_ = &exit;
+  std::vector<struct epoll_event> events(kInitialEvents);
+  for (;;) {
+    int n = ::epoll_wait(epoll_fd_, events.data(),
+                         static_cast<int>(events.size()), -1);
+    if (n < 0 && errno != EINTR) {
+      throw std::system_error(errno, std::generic_category(), "epoll_wait");
+    }
+
+    for (int i = 0; i < n; ++i) {
+      const auto& event = events[i];
+      if (event.data.u64 == kWakeupToken) {
+        uint64_t count;
+        while (::read(wakeup_fd_, &count, sizeof(count)) > 0) {
+        }
+        // Cleared before the tasks are taken, so a task pushed after the
+        // swap always writes the eventfd again.
+        notified_.store(false, std::memory_order_release);
+      } else if (event.data.u64 == kTimerToken) {
+        uint64_t count;
+        while (::read(timer_fd_, &count, sizeof(count)) > 0) {
+        }
+        run_timers();
+      } else {
+        auto channel = static_cast<Channel*>(event.data.ptr);
+        if (!channel->removed.load(std::memory_order_acquire)) {
+          Invoke(channel->handler, FromEpoll(event.events));
+        }
+      }
+      if (exit.destroyed) {
+        return;
+      }
+    }
+    if (static_cast<size_t>(n) == events.size() &&
+        events.size() < kMaxEvents) {
+      events.resize(events.size() * 2);
+    }
+
+    // Checked before the tasks run: everything scheduled before Close
+    // still gets to run.
+    bool closed = closed_.load(std::memory_order_acquire);
+    run_tasks();
+    if (exit.destroyed) {
+      return;
+    }
+    // Channels unregistered from now on are not in the next batch, since
+    // epoll_ctl removed them before it starts.
+    std::vector<Channel*> removed;
+    {
+      std::unique_lock<std::mutex> lock(mu_);
+      removed.swap(removed_);
+    }
+    for (Channel* channel : removed) {
+      delete channel;
+    }
+    if (closed) {
+      return;
+    }
+  }
+}
+
+void EventLoop::Close() {
+  if (closed_.exchange(true, std::memory_order_acq_rel)) {
+    return;
+  }
+  uint64_t one = 1;
+  while (::write(wakeup_fd_, &one, sizeof(one)) < 0 && errno == EINTR) {
+  }
+}
+
+void EventLoop::Join() {
+  if (thread_.joinable() && !InLoop()) {
+    thread_.join();
+  }
+}
+
+EventLoopGroup::EventLoopGroup(size_t n) : loops_(std::max<size_t>(n, 1)) {
+  for (size_t i = 0; i < loops_.capacity(); ++i) {
+    loops_.emplace_back();
+  }
+}
+
+EventLoopGroup::~EventLoopGroup() {
+  Close();
+  Join();
+}
+
+Error EventLoopGroup::Register(const File& file, uint32_t mask,
+                               Trigger trigger, EventHandler handler,
+                               EventLoop** loop) {
+  EventLoop& next = Next();
+  Error err = next.Register(file, mask, trigger, std::move(handler));
+  if (!err.Empty()) {
+    return err;
+  }
+  {
+    std::unique_lock<std::mutex> lock(mu_);
+    assigned_[file.Descriptor()] = &next;
+  }
+  if (loop != nullptr) {
+    *loop = &next;
+  }
+  return Error::Success();
+}
+
+Error EventLoopGroup::Modify(const File& file, uint32_t mask,
+                             Trigger trigger) {
+  EventLoop* loop;
+  {
+    std::unique_lock<std::mutex> lock(mu_);
+    auto it = assigned_.find(file.Descriptor());
+    if (it == assigned_.end()) {
+      return Error(ENOENT);
+    }
+    loop = it->second;
+  }
+  return loop->Modify(file, mask, trigger);
+}
+
+Error EventLoopGroup::Unregister(const File& file) {
+  EventLoop* loop;
+  {
+    std::unique_lock<std::mutex> lock(mu_);
+    auto it = assigned_.find(file.Descriptor());
+    if (it == assigned_.end()) {
+      return Error(ENOENT);
+    }
+    loop = it->second;
+    assigned_.erase(it);
+  }
+  return loop->Unregister(file);
+}
+
+void EventLoopGroup::Close() {
+  for (auto& loop : loops_) {
+    loop.Close();
+  }
+}
+
+void EventLoopGroup::Join() {
+  for (auto& loop : loops_) {
+    loop.Join();
+  }
+}
+
+}  // namespace pedrolib
@@ -0,0 +1,168 @@
+#include "pedrolib/executor/serial_executor.h"
+#include <algorithm>
+#include "pedrolib/concurrent/backoff.h"
+#include "pedrolib/concurrent/futex.h"
+
+namespace pedrolib {
+
+SerialExecutor::SerialExecutor(Executor* parent, Priority priority)
+    : parent_(parent),
+      priority_(priority),
+      timers_(std::make_shared<Timers>()) {
+  tail_ = new Node;
+  head_.store(tail_, std::memory_order_relaxed);
+  timers_->strand = this;
+}
+
+SerialExecutor::~SerialExecutor() {
+  Close();
+  Join();
+  delete tail_;
+}
+
+void SerialExecutor::push(Node* node) noexcept {
+  Node* prev = head_.exchange(node, std::memory_order_acq_rel);
+  prev->next.store(node, std::memory_order_release);
+}
+
+// Only called by the draining worker, and only when pending_ says a task
+// has been pushed; its producer may still be linking it in.
+Callback SerialExecutor::pop() noexcept {
+  Node* next = tail_->next.load(std::memory_order_acquire);
+  while (next == nullptr) {
+    CpuRelax();
+    next = tail_->next.load(std::memory_order_acquire);
+  }
+  delete tail_;
+  tail_ = next;
+  return std::move(next->callback);
+}
+
+void SerialExecutor::drain() {
+  uint32_t n = 0;
+  do {
+    Callback callback = pop();
+    if (callback) {
+      callback();
+    }
+  } while (++n < kBatch &&
+           (pending_.load(std::memory_order_acquire) & ~kWaiting) != n);
+
+  uint32_t pending = pending_.load(std::memory_order_relaxed);
+  uint32_t left;
+  do {
+    left = pending - n;
+    if ((left & ~kWaiting) == 0) {
+      left = 0;
+    }
+  } while (!pending_.compare_exchange_weak(pending, left,
+                                           std::memory_order_acq_rel));
+
+  // Yield the worker between batches so one busy strand cannot hog it.
+  // Once the count is zero Join may destroy the strand, so only the
+  // address of pending_ is used after that.
+  if (left != 0) {
+    parent_->Schedule([this] { drain(); }, priority_);
+  } else if (pending & kWaiting) {
+    FutexWakeAll(&pending_);
+  }
+}
+
+void SerialExecutor::Schedule(Callback cb) {
+  if (closed_.load(std::memory_order_acquire)) {
+    return;
+  }
+  auto node = new Node;
+  node->callback = std::move(cb);
+  push(node);
+  if ((pending_.fetch_add(1, std::memory_order_acq_rel) & ~kWaiting) == 0) {
+    parent_->Schedule([this] { drain(); }, priority_);
+  }
+}
+
+void SerialExecutor::ScheduleBatch(Callback* cbs, size_t n, Priority) {
+  if (n == 0 || closed_.load(std::memory_order_acquire)) {
+    return;
+  }
+  for (size_t i = 0; i < n; ++i) {
+    auto node = new Node;
+    node->callback = std::move(cbs[i]);
+    push(node);
+  }
+  if ((pending_.fetch_add(static_cast<uint32_t>(n),
+                          std::memory_order_acq_rel) &
+       ~kWaiting) == 0) {
+    parent_->Schedule([this] { drain(); }, priority_);
+  }
+}
+
+uint64_t SerialExecutor::ScheduleAfter(Duration delay, Callback cb) {
+  return parent_->ScheduleAfter(
+      delay, [timers = timers_, cb = std::move(cb)]() mutable {
+        std::unique_lock<std::mutex> lock(timers->mu);
+        if (timers->strand != nullptr) {
+          timers->strand->Schedule(std::move(cb));
+        }
+      });
+}
+
+uint64_t SerialExecutor::ScheduleEvery(Duration delay, Duration interval,
+                                       Callback cb) {
+  uint64_t id = parent_->ScheduleEvery(
+      delay, interval, [timers = timers_, cb = std::move(cb)] {
+        std::unique_lock<std::mutex> lock(timers->mu);
+        if (timers->strand != nullptr) {
+          timers->strand->Schedule(cb);
+        }
+      });
+
+  std::unique_lock<std::mutex> lock(timers_->mu);
+  if (timers_->strand == nullptr) {
+    // Closed meanwhile.
+    lock.unlock();
+    parent_->ScheduleCancel(id);
+    return id;
+  }
+  timers_->periodic.push_back(id);
+  return id;
+}
+
+void SerialExecutor::ScheduleCancel(uint64_t id) {
+  {
+    std::unique_lock<std::mutex> lock(timers_->mu);
+    auto& periodic = timers_->periodic;
+    periodic.erase(std::remove(periodic.begin(), periodic.end(), id),
+                   periodic.end());
+  }
+  parent_->ScheduleCancel(id);
+}
+
+void SerialExecutor::Close() {
+  closed_.store(true, std::memory_order_release);
+
+  std::vector<uint64_t> periodic;
+  {
+    std::unique_lock<std::mutex> lock(timers_->mu);
+    timers_->strand = nullptr;
+    periodic.swap(timers_->periodic);
+  }
+  for (uint64_t id : periodic) {
+    parent_->ScheduleCancel(id);
+  }
+}
+
+void SerialExecutor::Join() {
+  for (;;) {
+    uint32_t n = pending_.load(std::memory_order_acquire);
+    if ((n & ~kWaiting) == 0) {
+      return;
+    }
+    n = pending_.fetch_or(kWaiting, std::memory_order_acq_rel) | kWaiting;
+    if ((n & ~kWaiting) == 0) {
+      return;
+    }
+    FutexWait(&pending_, n);
+  }
+}
+
+}  // namespace pedrolib
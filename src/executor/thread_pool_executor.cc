@@ -0,0 +1,452 @@
+#include "pedrolib/executor/thread_pool_executor.h"
+#include <algorithm>
+#include <stdexcept>
+
+namespace pedrolib {
+
+using detail::Lane;
+using detail::ReadyTask;
+using detail::TimerEntry;
+using detail::TimerSlot;
+
+namespace {
+
+constexpr uint64_t Pack(uint64_t generation, TimerSlot::Status status) {
+  return generation << 32 | status;
+}
+
+constexpr uint64_t Generation(uint64_t state) { return state >> 32; }
+
+constexpr auto Status(uint64_t state) {
+  return static_cast<TimerSlot::Status>(state & 0xffffffff);
+}
+
+constexpr uint32_t Index(uint64_t id) { return static_cast<uint32_t>(id); }
+
+}  // namespace
+
+std::string LaneStats::String() const {
+  return fmt::format(
+      "LaneStats[weight={}, scheduled={}, executed={}, pending={}, "
+      "queue_wait={}]",
+      weight, scheduled, executed, pending, queue_wait);
+}
+
+ThreadPoolExecutor::ThreadPoolExecutor(const Options& options)
+    : options_(options) {
+  options_.min_threads = std::max<size_t>(options_.min_threads, 1);
+  options_.max_threads =
+      std::max(options_.max_threads, options_.min_threads);
+
+  std::unique_lock<std::mutex> lock(mu_);
+  lanes_[static_cast<size_t>(Priority::kHigh)].weight = 16;
+  lanes_[static_cast<size_t>(Priority::kNormal)].weight = 4;
+  lanes_[static_cast<size_t>(Priority::kLow)].weight = 1;
+  for (size_t i = 0; i < options_.min_threads; ++i) {
+    spawn();
+  }
+}
+
+ThreadPoolExecutor::~ThreadPoolExecutor() {
+  Close();
+  join();
+  for (auto& chunk : chunks_) {
+    delete[] chunk.load(std::memory_order_relaxed);
+  }
+}
+
+uint32_t ThreadPoolExecutor::allocate() {
+  if (!free_.empty()) {
+    uint32_t index = free_.back();
+    free_.pop_back();
+    return index;
+  }
+
+  uint32_t index = slots_++;
+  if ((index & (kChunkSize - 1)) == 0) {
+    if ((index >> kChunkBits) >= kMaxChunks) {
+      throw std::length_error("too many pending timers");
+    }
+    chunks_[index >> kChunkBits].store(new TimerSlot[kChunkSize],
+                                       std::memory_order_release);
+  }
+  return index;
+}
+
+void ThreadPoolExecutor::release(uint32_t index, TimerSlot* slot) {
+  uint64_t state = slot->state.load(std::memory_order_relaxed);
+  slot->callback = nullptr;
+  slot->state.store(Pack(Generation(state) + 1, TimerSlot::kFree),
+                    std::memory_order_release);
+  free_.push_back(index);
+}
+
+void ThreadPoolExecutor::fire(std::unique_lock<std::mutex>& lock) {
+  std::pop_heap(timers_.begin(), timers_.end());
+  TimerEntry entry = timers_.back();
+  timers_.pop_back();
+
+  uint32_t index = Index(entry.id);
+  TimerSlot* s = slot(index);
+  uint64_t generation = entry.id >> 32;
+  uint64_t scheduled = Pack(generation, TimerSlot::kScheduled);
+
+  if (s->interval == Duration::Zero()) {
+    // Firing a one-shot task retires its id right away, which turns any
+    // later cancel into a no-op.
+    if (!s->state.compare_exchange_strong(
+            scheduled, Pack(generation + 1, TimerSlot::kFree),
+            std::memory_order_acq_rel)) {
+      canceled_.fetch_sub(1, std::memory_order_relaxed);
+      release(index, s);
+      return;
+    }
+    Callback callback = std::move(s->callback);
+    s->callback = nullptr;
+    free_.push_back(index);
+
+    lock.unlock();
+    if (callback) {
+      callback();
+    }
+    lock.lock();
+    return;
+  }
+
+  if (!s->state.compare_exchange_strong(
+          scheduled, Pack(generation, TimerSlot::kRunning),
+          std::memory_order_acq_rel)) {
+    canceled_.fetch_sub(1, std::memory_order_relaxed);
+    release(index, s);
+    return;
+  }
+
+  // Nobody else touches a running slot's callback, so it can run in place.
+  lock.unlock();
+  if (s->callback) {
+    s->callback();
+  }
+  lock.lock();
+
+  uint64_t running = Pack(generation, TimerSlot::kRunning);
+  if (s->state.compare_exchange_strong(running, scheduled,
+                                       std::memory_order_acq_rel)) {
+    timers_.push_back({MonotonicClock::Now() + s->interval, entry.id});
+    std::push_heap(timers_.begin(), timers_.end());
+  } else {
+    // Canceled while running.
+    release(index, s);
+  }
+}
+
+void ThreadPoolExecutor::purge() {
+  auto canceled = [this](const TimerEntry& entry) {
+    uint32_t index = Index(entry.id);
+    TimerSlot* s = slot(index);
+    if (Status(s->state.load(std::memory_order_acquire)) !=
+        TimerSlot::kCanceled) {
+      return false;
+    }
+    canceled_.fetch_sub(1, std::memory_order_relaxed);
+    release(index, s);
+    return true;
+  };
+  timers_.erase(std::remove_if(timers_.begin(), timers_.end(), canceled),
+                timers_.end());
+  std::make_heap(timers_.begin(), timers_.end());
+}
+
+Lane* ThreadPoolExecutor::pick() noexcept {
+  Lane* best = nullptr;
+  int64_t total = 0;
+  for (auto& lane : lanes_) {
+    if (lane.tasks.empty()) {
+      continue;
+    }
+    lane.current += lane.weight;
+    total += lane.weight;
+    if (best == nullptr || lane.current > best->current) {
+      best = &lane;
+    }
+  }
+  best->current -= total;
+  return best;
+}
+
+void ThreadPoolExecutor::spawn() {
+  // Reap workers that retired since the last spawn.
+  for (auto& thread : exited_) {
+    thread.join();
+  }
+  exited_.clear();
+
+  workers_.fetch_add(1, std::memory_order_relaxed);
+  auto self = threads_.emplace(threads_.end());
+  *self = std::thread([this, self] { worker(self); });
+}
+
+void ThreadPoolExecutor::grow(Timestamp now) {
+  if (idle_ != 0 || ready_ == 0 || shutdown_.load(std::memory_order_relaxed) ||
+      workers_.load(std::memory_order_relaxed) >= options_.max_threads) {
+    return;
+  }
+
+  Timestamp oldest = now;
+  for (auto& lane : lanes_) {
+    if (!lane.tasks.empty()) {
+      oldest = std::min(oldest, lane.tasks.front().enqueued);
+    }
+  }
+  if (now - oldest > options_.max_queue_delay) {
+    spawn();
+  }
+}
+
+void ThreadPoolExecutor::begin_blocking() {
+  std::unique_lock<std::mutex> lock(mu_);
+  blocking_++;
+  // Keep min_threads workers runnable while this one waits.
+  if (runnable() < options_.min_threads &&
+      workers_.load(std::memory_order_relaxed) < options_.max_threads &&
+      !shutdown_.load(std::memory_order_relaxed)) {
+    spawn();
+  }
+}
+
+void ThreadPoolExecutor::end_blocking() {
+  std::unique_lock<std::mutex> lock(mu_);
+  blocking_--;
+}
+
+size_t ThreadPoolExecutor::runnable() const noexcept {
+  size_t workers = workers_.load(std::memory_order_relaxed);
+  return workers > blocking_ ? workers - blocking_ : 0;
+}
+
+void ThreadPoolExecutor::retire(std::list<std::thread>::iterator self) {
+  exited_.splice(exited_.end(), threads_, self);
+  if (workers_.fetch_sub(1, std::memory_order_relaxed) == 1) {
+    stopped_.notify_all();
+  }
+}
+
+void ThreadPoolExecutor::worker(std::list<std::thread>::iterator self) {
+  current_ = this;
+  std::unique_lock<std::mutex> lock(mu_);
+  Timestamp idle_since = MonotonicClock::Now();
+  while (!shutdown_.load(std::memory_order_acquire)) {
+    // Canceled timers stay in the heap until they expire; drop them early
+    // once they make up half of it so their callbacks are freed promptly.
+    int64_t canceled = canceled_.load(std::memory_order_relaxed);
+    if (canceled > 0 && static_cast<size_t>(canceled) * 2 >= timers_.size()) {
+      purge();
+    }
+
+    Timestamp now = MonotonicClock::Now();
+    if (ready_ == 0) {
+      int64_t wait =
+          options_.keep_alive.usecs - (now - idle_since).Microseconds();
+      if (!timers_.empty()) {
+        Duration d = timers_.front().expired - now;
+        if (d <= Duration::Microseconds(100)) {
+          fire(lock);
+          idle_since = MonotonicClock::Now();
+          continue;
+        }
+        wait = std::min(wait, d.Microseconds());
+      }
+
+      if (wait <= 0 && runnable() > options_.min_threads) {
+        retire(self);
+        return;
+      }
+
+      if (wait <= 0) {
+        // Not allowed to retire; start another idle period.
+        idle_since = now;
+        wait = options_.keep_alive.usecs;
+      }
+      idle_++;
+      non_empty_.wait_for(lock, std::chrono::microseconds(wait));
+      idle_--;
+      continue;
+    }
+
+    if (!timers_.empty() &&
+        timers_.front().expired - now <= Duration::Microseconds(100)) {
+      fire(lock);
+      idle_since = MonotonicClock::Now();
+      continue;
+    }
+
+    Lane* lane = pick();
+    ReadyTask task = std::move(lane->tasks.front());
+    lane->tasks.pop_front();
+    lane->executed++;
+    ready_--;
+    lane->queue_wait.Record(now - task.enqueued);
+    grow(now);
+
+    Callback callback = std::move(task.callback);
+    lock.unlock();
+    if (callback) {
+      callback();
+    }
+    callback = nullptr;
+    lock.lock();
+    idle_since = MonotonicClock::Now();
+  }
+  retire(self);
+}
+
+uint64_t ThreadPoolExecutor::schedule(const Duration& delay,
+                                      const Duration& interval, Callback cb) {
+  uint32_t index = allocate();
+  TimerSlot* s = slot(index);
+  s->interval = interval;
+  s->callback = std::move(cb);
+
+  uint64_t generation =
+      Generation(s->state.load(std::memory_order_relaxed));
+  s->state.store(Pack(generation, TimerSlot::kScheduled),
+                 std::memory_order_release);
+
+  uint64_t id = generation << 32 | index;
+  bool wakeup = timers_.empty() ||
+                MonotonicClock::Now() + delay < timers_.front().expired;
+  timers_.push_back({MonotonicClock::Now() + delay, id});
+  std::push_heap(timers_.begin(), timers_.end());
+  if (wakeup) {
+    non_empty_.notify_one();
+  }
+  return id;
+}
+
+void ThreadPoolExecutor::Schedule(Callback cb, Priority priority) {
+  Timestamp now = MonotonicClock::Now();
+  std::unique_lock<std::mutex> lock(mu_);
+  Lane& lane = lanes_[static_cast<size_t>(priority)];
+  lane.tasks.push_back({std::move(cb), now});
+  lane.scheduled++;
+  ready_++;
+  if (idle_ != 0) {
+    non_empty_.notify_one();
+  } else {
+    grow(now);
+  }
+}
+
+void ThreadPoolExecutor::ScheduleBatch(Callback* cbs, size_t n,
+                                       Priority priority) {
+  if (n == 0) {
+    return;
+  }
+
+  Timestamp now = MonotonicClock::Now();
+  std::unique_lock<std::mutex> lock(mu_);
+  Lane& lane = lanes_[static_cast<size_t>(priority)];
+  for (size_t i = 0; i < n; ++i) {
+    lane.tasks.push_back({std::move(cbs[i]), now});
+  }
+  lane.scheduled += n;
+  ready_ += n;
+
+  if (n >= idle_) {
+    non_empty_.notify_all();
+    grow(now);
+    return;
+  }
+  for (size_t i = 0; i < n; ++i) {
+    non_empty_.notify_one();
+  }
+}
+
+void ThreadPoolExecutor::SetPriorityWeight(Priority priority,
+                                           uint32_t weight) {
+  std::unique_lock<std::mutex> lock(mu_);
+  lanes_[static_cast<size_t>(priority)].weight = std::max<uint32_t>(weight, 1);
+}
+
+LaneStats ThreadPoolExecutor::Stats(Priority priority) {
+  Lane& lane = lanes_[static_cast<size_t>(priority)];
+  LaneStats stats;
+  {
+    std::unique_lock<std::mutex> lock(mu_);
+    stats.weight = lane.weight;
+    stats.scheduled = lane.scheduled;
+    stats.executed = lane.executed;
+    stats.pending = lane.tasks.size();
+  }
+  stats.queue_wait = lane.queue_wait.Snapshot();
+  return stats;
+}
+
+uint64_t ThreadPoolExecutor::ScheduleAfter(Duration delay, Callback cb) {
+  std::unique_lock<std::mutex> lock(mu_);
+  return schedule(delay, Duration::Zero(), std::move(cb));
+}
+
+uint64_t ThreadPoolExecutor::ScheduleEvery(Duration delay, Duration interval,
+                                           Callback cb) {
+  std::unique_lock<std::mutex> lock(mu_);
+  return schedule(delay, interval, std::move(cb));
+}
+
+void ThreadPoolExecutor::ScheduleCancel(uint64_t id) {
+  uint32_t index = Index(id);
+  if ((index >> kChunkBits) >= kMaxChunks ||
+      chunks_[index >> kChunkBits].load(std::memory_order_acquire) ==
+          nullptr) {
+    return;
+  }
+
+  TimerSlot* s = slot(index);
+  uint64_t generation = id >> 32;
+  uint64_t state = s->state.load(std::memory_order_acquire);
+  for (;;) {
+    auto status = Status(state);
+    if (Generation(state) != generation ||
+        (status != TimerSlot::kScheduled && status != TimerSlot::kRunning)) {
+      return;
+    }
+    if (s->state.compare_exchange_weak(state,
+                                       Pack(generation, TimerSlot::kCanceled),
+                                       std::memory_order_acq_rel)) {
+      break;
+    }
+  }
+
+  // A running periodic task is released by the worker that runs it; a
+  // scheduled one waits in the heap until expiry or the next purge.
+  if (Status(state) == TimerSlot::kScheduled) {
+    canceled_.fetch_add(1, std::memory_order_relaxed);
+    non_empty_.notify_one();
+  }
+}
+
+void ThreadPoolExecutor::close() {
+  shutdown_.store(true, std::memory_order_release);
+  non_empty_.notify_all();
+}
+
+void ThreadPoolExecutor::Close() {
+  std::unique_lock<std::mutex> lock(mu_);
+  close();
+}
+
+void ThreadPoolExecutor::join() {
+  // Workers unlink themselves from threads_, so wait for all of them to
+  // do so rather than taking the list away from under them.
+  std::unique_lock<std::mutex> lock(mu_);
+  stopped_.wait(lock, [this] {
+    return workers_.load(std::memory_order_relaxed) == 0;
+  });
+  std::list<std::thread> threads;
+  threads.splice(threads.end(), exited_);
+  lock.unlock();
+  for (auto& thread : threads) {
+    thread.join();
+  }
+}
+
+}  // namespace pedrolib
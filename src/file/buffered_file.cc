@@ -0,0 +1,240 @@
+#include "pedrolib/file/buffered_file.h"
+#include <fcntl.h>
+#include <algorithm>
+#include <cstring>
+#include <new>
+#include <utility>
+#include "pedrolib/concurrent/futex.h"
+#include "pedrolib/executor/executor.h"
+
+namespace pedrolib {
+
+using detail::IoOptions;
+using detail::IoWindow;
+using detail::IoWindows;
+
+namespace {
+
+// Writes the buffers at offset, retrying short writes.
+Error WriteFully(File* file, uint64_t offset, std::string_view* buf,
+                 size_t n) {
+  while (n != 0) {
+    ssize_t w = file->Pwritev(offset, buf, n);
+    if (w < 0) {
+      return Error(errno);
+    }
+    offset += w;
+    auto left = static_cast<size_t>(w);
+    for (; n != 0 && left >= buf->size(); ++buf, --n) {
+      left -= buf->size();
+    }
+    if (n != 0) {
+      buf->remove_prefix(left);
+    }
+  }
+  return Error::Success();
+}
+
+// Runs io on executor, or inline without one, and marks window done.
+template <typename Io>
+void Run(Executor* executor, IoWindow& window, Io&& io) {
+  window.done.store(0, std::memory_order_relaxed);
+  auto task = [&window, io = std::forward<Io>(io)] {
+    io();
+    std::atomic<uint32_t>* done = &window.done;
+    if (done->exchange(IoWindow::kDone, std::memory_order_acq_rel) &
+        IoWindow::kWaiting) {
+      FutexWake(done, 1);
+    }
+  };
+  if (executor == nullptr) {
+    task();
+    return;
+  }
+  executor->Schedule(std::move(task));
+}
+
+}  // namespace
+
+void IoWindow::Wait() noexcept {
+  if (done.load(std::memory_order_acquire) & kDone) {
+    return;
+  }
+  while (!(done.fetch_or(kWaiting, std::memory_order_acq_rel) & kDone)) {
+    FutexWait(&done, kWaiting);
+  }
+}
+
+IoWindows::IoWindows(const IoOptions& options)
+    : count_(std::max<size_t>(options.windows, 1)) {
+  size_t alignment = std::max<size_t>(options.alignment, 64);
+  buffer_size_ = std::max<size_t>(options.buffer_size, 1);
+  buffer_size_ = (buffer_size_ + alignment - 1) / alignment * alignment;
+
+  auto memory = static_cast<char*>(
+      std::aligned_alloc(alignment, count_ * buffer_size_));
+  if (memory == nullptr) {
+    throw std::bad_alloc();
+  }
+  memory_.reset(memory);
+  windows_ = std::make_unique<IoWindow[]>(count_);
+  for (size_t i = 0; i < count_; ++i) {
+    windows_[i].data = memory + i * buffer_size_;
+  }
+}
+
+IoWindows::~IoWindows() {
+  for (size_t i = 0; i < count_; ++i) {
+    windows_[i].Wait();
+  }
+}
+
+BufferedFileReader::BufferedFileReader(File* file, Executor* executor,
+                                       uint64_t offset,
+                                       const Options& options)
+    : file_(file),
+      executor_(executor),
+      windows_(options),
+      next_offset_(offset) {
+  ::posix_fadvise(file_->Descriptor(), static_cast<off_t>(offset), 0,
+                  POSIX_FADV_SEQUENTIAL);
+  for (size_t i = 0; i < windows_.Count(); ++i) {
+    issue();
+  }
+}
+
+BufferedFileReader::~BufferedFileReader() = default;
+
+void BufferedFileReader::issue() {
+  IoWindow& window = windows_[issued_++];
+  window.offset = next_offset_;
+  window.size = windows_.BufferSize();
+  next_offset_ += window.size;
+  Run(executor_, window, [file = file_, &window] {
+    window.result = file->Pread(window.offset, window.data, window.size);
+    window.error = window.result < 0 ? Error(errno) : Error::Success();
+  });
+}
+
+std::optional<std::string_view> BufferedFileReader::Next() {
+  if (!remaining_.empty()) {
+    return std::exchange(remaining_, {});
+  }
+  if (held_) {
+    held_ = false;
+    if (!stopped_) {
+      issue();
+    }
+  }
+  if (stopped_ || consumed_ == issued_) {
+    eof_ = error_.Empty();
+    return std::nullopt;
+  }
+
+  IoWindow& window = windows_[consumed_++];
+  window.Wait();
+  if (window.result < 0) {
+    error_ = window.error;
+    stopped_ = true;
+    return std::nullopt;
+  }
+  // Later windows may have read past a file that grew meanwhile; stop at
+  // the first short read so the data stays contiguous.
+  if (static_cast<size_t>(window.result) < window.size) {
+    stopped_ = true;
+  }
+  if (window.result == 0) {
+    eof_ = true;
+    return std::nullopt;
+  }
+  held_ = true;
+  return std::string_view(window.data, window.result);
+}
+
+ssize_t BufferedFileReader::Read(void* buf, size_t n) {
+  auto out = static_cast<char*>(buf);
+  size_t copied = 0;
+  while (copied < n) {
+    if (remaining_.empty()) {
+      auto next = Next();
+      if (!next) {
+        break;
+      }
+      remaining_ = *next;
+    }
+    size_t m = std::min(n - copied, remaining_.size());
+    memcpy(out + copied, remaining_.data(), m);
+    remaining_.remove_prefix(m);
+    copied += m;
+  }
+  if (copied == 0 && !error_.Empty()) {
+    return -1;
+  }
+  return static_cast<ssize_t>(copied);
+}
+
+BufferedFileWriter::BufferedFileWriter(File* file, Executor* executor,
+                                       uint64_t offset,
+                                       const Options& options)
+    : file_(file), executor_(executor), windows_(options), offset_(offset) {}
+
+BufferedFileWriter::~BufferedFileWriter() { Flush(); }
+
+void BufferedFileWriter::collect(IoWindow& window) noexcept {
+  window.Wait();
+  if (error_.Empty()) {
+    error_ = window.error;
+  }
+}
+
+void BufferedFileWriter::submit() {
+  IoWindow& window = windows_[current_++];
+  window.offset = offset_;
+  window.size = used_;
+  offset_ += used_;
+  used_ = 0;
+  Run(executor_, window, [file = file_, &window] {
+    std::string_view buf(window.data, window.size);
+    window.error = WriteFully(file, window.offset, &buf, 1);
+  });
+  collect(windows_[current_]);
+}
+
+Error BufferedFileWriter::Write(const void* data, size_t n) {
+  if (!error_.Empty()) {
+    return error_;
+  }
+  auto p = static_cast<const char*>(data);
+  size_t capacity = windows_.BufferSize();
+  if (n >= capacity) {
+    // The buffered bytes and data in one call, without copying data.
+    std::string_view buf[] = {{windows_[current_].data, used_}, {p, n}};
+    error_ = WriteFully(file_, offset_, buf, 2);
+    offset_ += used_ + n;
+    used_ = 0;
+    return error_;
+  }
+  while (n != 0) {
+    size_t m = std::min(n, capacity - used_);
+    memcpy(windows_[current_].data + used_, p, m);
+    used_ += m;
+    p += m;
+    n -= m;
+    if (used_ == capacity) {
+      submit();
+    }
+  }
+  return error_;
+}
+
+Error BufferedFileWriter::Flush() {
+  if (used_ != 0 && error_.Empty()) {
+    submit();
+  }
+  for (size_t i = 0; i < windows_.Count(); ++i) {
+    collect(windows_[i]);
+  }
+  return error_;
+}
+
+}  // namespace pedrolib
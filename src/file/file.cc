@@ -1,9 +1,13 @@
 #include "pedrolib/file/file.h"
 #include <fcntl.h>
+#include <poll.h>
 #include <sys/mman.h>
+#include <sys/sendfile.h>
+#include <sys/stat.h>
 #include <sys/uio.h>
 #include <unistd.h>
 #include <vector>
+#include "pedrolib/buffer/array_buffer.h"
 #include "pedrolib/logger/logger.h"
 
 namespace pedrolib {
@@ -12,6 +16,113 @@ struct DefaultDeleter {
   void operator()(struct iovec* ptr) const noexcept { std::free(ptr); }
 };
 
+namespace {
+
+enum class FileKind { kRegular, kPipe, kOther };
+
+FileKind GetFileKind(int fd) {
+  struct stat st {};
+  if (::fstat(fd, &st) < 0) {
+    return FileKind::kOther;
+  }
+  if (S_ISREG(st.st_mode)) {
+    return FileKind::kRegular;
+  }
+  if (S_ISFIFO(st.st_mode)) {
+    return FileKind::kPipe;
+  }
+  return FileKind::kOther;
+}
+
+bool WaitWritable(int fd) {
+  struct pollfd pfd {
+    .fd = fd, .events = POLLOUT, .revents = 0,
+  };
+  return ::poll(&pfd, 1, -1) >= 0;
+}
+
+bool IsUnsupported(int err) {
+  return err == EINVAL || err == ENOSYS || err == EXDEV ||
+         err == EOPNOTSUPP || err == EBADF;
+}
+
+// Moves bytes from the kernel in transfer loops. Returns the number of bytes
+// transferred, -1 when the transfer failed without progress, or -2 when the
+// method is not supported for the given descriptors and the caller should
+// try the next one.
+template <typename Op>
+ssize_t Transfer(size_t n, Op&& op) {
+  size_t transferred = 0;
+  while (transferred < n) {
+    ssize_t w = op(n - transferred);
+    if (w > 0) {
+      transferred += w;
+      continue;
+    }
+    if (w == 0) {
+      break;
+    }
+    if (errno == EINTR) {
+      continue;
+    }
+    if (transferred == 0 && IsUnsupported(errno)) {
+      return -2;
+    }
+    if (transferred == 0) {
+      return -1;
+    }
+    break;
+  }
+  return static_cast<ssize_t>(transferred);
+}
+
+// offset must be set: bytes left in the pipe when the target fails are put
+// back by rewinding it, which a socket or pipe source cannot do.
+ssize_t SpliceThroughPipe(int in, loff_t* offset, int out, size_t n) {
+  int pipes[2];
+  if (::pipe2(pipes, O_CLOEXEC) < 0) {
+    return -2;
+  }
+  File reader(pipes[0]), writer(pipes[1]);
+
+  bool stopped = false;
+  return Transfer(n, [&](size_t remain) -> ssize_t {
+    if (stopped) {
+      return 0;
+    }
+    ssize_t r = ::splice(in, offset, writer.Descriptor(), nullptr, remain,
+                         SPLICE_F_MOVE | SPLICE_F_MORE);
+    if (r <= 0) {
+      return r;
+    }
+
+    // Everything moved into the pipe must reach the target; what does not
+    // is given back by rewinding the offset, and the pipe, now holding
+    // stale bytes, is not used again.
+    ssize_t pending = r;
+    while (pending > 0) {
+      ssize_t w = ::splice(reader.Descriptor(), nullptr, out, nullptr,
+                           pending, SPLICE_F_MOVE | SPLICE_F_MORE);
+      if (w > 0) {
+        pending -= w;
+        continue;
+      }
+      if (w < 0 && errno == EINTR) {
+        continue;
+      }
+      if (w < 0 && errno == EAGAIN && WaitWritable(out)) {
+        continue;
+      }
+      *offset -= pending;
+      stopped = true;
+      return r - pending > 0 ? r - pending : -1;
+    }
+    return r;
+  });
+}
+
+}  // namespace
+
 ssize_t File::Read(void* buf, size_t size) noexcept {
   return ::read(fd_, buf, size);
 }
@@ -217,4 +328,81 @@ Error File::Reserve(uint64_t n) {
   return Error::kOk;
 }
 
+ssize_t File::TransferTo(File& target, uint64_t offset, size_t n) {
+  FileKind in = GetFileKind(fd_);
+  FileKind out = GetFileKind(target.fd_);
+  auto off = static_cast<loff_t>(offset);
+  loff_t* in_offset = in == FileKind::kRegular ? &off : nullptr;
+
+  ssize_t w = -2;
+  if (in == FileKind::kRegular && out == FileKind::kRegular) {
+    w = Transfer(n, [&](size_t remain) {
+      return ::copy_file_range(fd_, in_offset, target.fd_, nullptr, remain,
+                               0);
+    });
+  }
+  if (w == -2 && in == FileKind::kRegular) {
+    w = Transfer(n, [&](size_t remain) {
+      return ::sendfile64(target.fd_, fd_, in_offset, remain);
+    });
+  }
+  if (w == -2 && (in == FileKind::kPipe || out == FileKind::kPipe)) {
+    w = Transfer(n, [&](size_t remain) {
+      return ::splice(fd_, in_offset, target.fd_, nullptr, remain,
+                      SPLICE_F_MOVE | SPLICE_F_MORE);
+    });
+  }
+  if (w == -2 && in_offset != nullptr) {
+    w = SpliceThroughPipe(fd_, in_offset, target.fd_, n);
+  }
+  if (w != -2) {
+    return w;
+  }
+
+  off = static_cast<loff_t>(offset);
+  const size_t kMaxBufferBytes = 65536;
+  ArrayBuffer buffer(std::min(n, kMaxBufferBytes));
+  bool stopped = false;
+  w = Transfer(n, [&](size_t remain) -> ssize_t {
+    if (stopped) {
+      return 0;
+    }
+    size_t m = std::min(remain, buffer.WritableBytes());
+    ssize_t r = in_offset ? Pread(*in_offset, buffer.WriteIndex(), m)
+                          : Read(buffer.WriteIndex(), m);
+    if (r <= 0) {
+      return r;
+    }
+    buffer.Append(r);
+
+    while (buffer.ReadableBytes()) {
+      ssize_t x = buffer.Retrieve(&target);
+      if (x < 0 && errno == EINTR) {
+        continue;
+      }
+      if (x < 0 && errno == EAGAIN && WaitWritable(target.fd_)) {
+        continue;
+      }
+      if (x <= 0) {
+        break;
+      }
+    }
+
+    // Bytes are only left over when the target failed, so the transfer
+    // stops here. A seekable source resumes from the first byte not
+    // written. A socket or pipe cannot take the tail back; it is lost along
+    // with the failed target, and the count returned excludes it.
+    ssize_t written = r - static_cast<ssize_t>(buffer.ReadableBytes());
+    if (buffer.ReadableBytes() != 0) {
+      stopped = true;
+    }
+    buffer.Reset();
+    if (in_offset) {
+      *in_offset += written;
+    }
+    return written > 0 ? written : -1;
+  });
+  return w == -2 ? -1 : w;
+}
+
 }  // namespace pedrolib
\ No newline at end of file
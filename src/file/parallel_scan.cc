@@ -0,0 +1,185 @@
+#include "pedrolib/file/parallel_scan.h"
+#include <sys/mman.h>
+#include <unistd.h>
+#include <atomic>
+#include <string>
+#include "pedrolib/buffer/search.h"
+#include "pedrolib/executor/executor.h"
+
+namespace pedrolib {
+
+namespace {
+
+// Read size while looking for the end of a record past the chunk.
+constexpr size_t kExtendBytes = 64 << 10;
+
+// Reads until n bytes or the end of the file; returns the bytes read, or
+// -1 on an error.
+ssize_t ReadFully(File& file, uint64_t offset, char* buf, size_t n) {
+  size_t done = 0;
+  while (done < n) {
+    ssize_t r = file.Pread(offset + done, buf + done, n - done);
+    if (r < 0) {
+      return -1;
+    }
+    if (r == 0) {
+      break;
+    }
+    done += r;
+  }
+  return static_cast<ssize_t>(done);
+}
+
+class ChunkScanner {
+  File& file_;
+  const ScanOptions& options_;
+  const std::function<void(const ScanChunk&)>& fn_;
+  uint64_t size_;
+  const char* mapped_;
+  std::atomic<int> error_{0};
+
+  void fail(int code) noexcept {
+    int expected = 0;
+    error_.compare_exchange_strong(expected, code);
+  }
+
+  void mapped(size_t index, uint64_t start, uint64_t end) const;
+  void read(size_t index, uint64_t start, uint64_t end);
+
+ public:
+  ChunkScanner(File& file, const ScanOptions& options,
+               const std::function<void(const ScanChunk&)>& fn, uint64_t size,
+               const char* mapped)
+      : file_(file), options_(options), fn_(fn), size_(size),
+        mapped_(mapped) {}
+
+  void Scan(size_t index) {
+    if (error_.load(std::memory_order_relaxed) != 0) {
+      return;
+    }
+    uint64_t start = index * options_.chunk_size;
+    uint64_t end = std::min(start + options_.chunk_size, size_);
+    if (mapped_ != nullptr) {
+      mapped(index, start, end);
+    } else {
+      read(index, start, end);
+    }
+  }
+
+  [[nodiscard]] Error GetError() const noexcept {
+    return Error(error_.load(std::memory_order_relaxed));
+  }
+};
+
+void ChunkScanner::mapped(size_t index, uint64_t start, uint64_t end) const {
+  const char* file_end = mapped_ + size_;
+  uint64_t begin = start;
+  if (options_.delimiter) {
+    char delimiter = *options_.delimiter;
+    if (start != 0) {
+      begin = FindByte(mapped_ + start - 1, file_end, delimiter) - mapped_ + 1;
+      if (begin >= end) {
+        return;
+      }
+    }
+    if (end != size_) {
+      end = std::min<uint64_t>(
+          FindByte(mapped_ + end - 1, file_end, delimiter) - mapped_ + 1,
+          size_);
+    }
+  }
+  static const uint64_t kPageSize = ::sysconf(_SC_PAGESIZE);
+  uint64_t page = begin / kPageSize * kPageSize;
+  ::madvise(const_cast<char*>(mapped_) + page, end - page, MADV_WILLNEED);
+  fn_(ScanChunk{index, begin, std::string_view(mapped_ + begin, end - begin)});
+}
+
+void ChunkScanner::read(size_t index, uint64_t start, uint64_t end) {
+  // One byte before the range tells whether a record starts at start.
+  uint64_t from = start != 0 && options_.delimiter ? start - 1 : start;
+  std::string buf(end - from, '\0');
+  ssize_t r = ReadFully(file_, from, buf.data(), buf.size());
+  if (r < 0) {
+    fail(errno);
+    return;
+  }
+  buf.resize(r);
+
+  size_t begin = 0;
+  if (options_.delimiter) {
+    char delimiter = *options_.delimiter;
+    if (from != start) {
+      const char* p = FindByte(buf.data(), buf.data() + buf.size(), delimiter);
+      begin = p - buf.data() + 1;
+      if (begin >= buf.size()) {
+        return;
+      }
+    }
+    // Extends past the range to the end of the last record.
+    uint64_t offset = from + buf.size();
+    while (!buf.empty() && buf.back() != delimiter && offset < size_) {
+      size_t old = buf.size();
+      buf.resize(old + kExtendBytes);
+      r = ReadFully(file_, offset, buf.data() + old, kExtendBytes);
+      if (r < 0) {
+        fail(errno);
+        return;
+      }
+      const char* tail = buf.data() + old;
+      const char* p = FindByte(tail, tail + r, delimiter);
+      buf.resize(p == tail + r ? old + r : p - buf.data() + 1);
+      offset += r;
+      if (r == 0) {
+        break;
+      }
+    }
+  }
+  if (begin == buf.size()) {
+    return;
+  }
+  fn_(ScanChunk{index, from + begin,
+                std::string_view(buf.data() + begin, buf.size() - begin)});
+}
+
+}  // namespace
+
+Error ParallelScan(File& file, Executor* executor, const ScanOptions& options,
+                   const std::function<void(const ScanChunk&)>& fn) {
+  int64_t size = file.GetSize();
+  if (size < 0) {
+    return file.GetError();
+  }
+  ScanOptions normalized = options;
+  normalized.chunk_size = std::max<size_t>(options.chunk_size, 1);
+  size_t chunks = (size + normalized.chunk_size - 1) / normalized.chunk_size;
+  if (chunks == 0) {
+    return Error::Success();
+  }
+
+  const char* mapped = nullptr;
+  if (options.map) {
+    void* p = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE,
+                     file.Descriptor(), 0);
+    if (p == MAP_FAILED) {
+      return Error(errno);
+    }
+    mapped = static_cast<const char*>(p);
+  }
+
+  ChunkScanner scanner(file, normalized, fn, size, mapped);
+  if (executor == nullptr) {
+    for (size_t i = 0; i < chunks; ++i) {
+      scanner.Scan(i);
+    }
+  } else {
+    for_each(executor, size_t{0}, chunks,
+             [&scanner](size_t i) { scanner.Scan(i); });
+  }
+
+  if (mapped != nullptr) {
+    ::munmap(const_cast<char*>(mapped), size);
+  }
+  return scanner.GetError();
+}
+
+}  // namespace pedrolib
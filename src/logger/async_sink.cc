@@ -0,0 +1,223 @@
+#include "pedrolib/logger/async_sink.h"
+#include <cstring>
+#include "pedrolib/concurrent/backoff.h"
+
+namespace pedrolib {
+
+namespace {
+constexpr size_t kMaxBatch = 64;
+constexpr size_t kMaxPrefix = 128;
+
+bool WriteFully(File& file, std::string_view* buf, size_t n) {
+  while (n > 0) {
+    ssize_t w = file.Writev(buf, n);
+    if (w < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return false;
+    }
+
+    auto left = static_cast<size_t>(w);
+    while (n > 0 && left >= buf->size()) {
+      left -= buf->size();
+      ++buf;
+      --n;
+    }
+    if (n > 0) {
+      buf->remove_prefix(left);
+    }
+  }
+  return true;
+}
+
+size_t RoundUpPowerOfTwo(size_t n) {
+  size_t x = 1;
+  while (x < n) {
+    x <<= 1;
+  }
+  return x;
+}
+}  // namespace
+
+AsyncLogSink::AsyncLogSink(File file, const Options& options)
+    : file_(std::move(file)), options_(options) {
+  size_t capacity = RoundUpPowerOfTwo(std::max<size_t>(options.capacity, 2));
+  stride_ = (sizeof(Slot) + options.record_bytes + 63) / 64 * 64;
+  mask_ = capacity - 1;
+
+  auto ptr = static_cast<char*>(std::aligned_alloc(64, capacity * stride_));
+  slots_.reset(ptr);
+  for (size_t i = 0; i < capacity; ++i) {
+    auto s = new (ptr + i * stride_) Slot{};
+    s->sequence.store(i, std::memory_order_relaxed);
+  }
+
+  flusher_ = std::thread([this] { flusher(); });
+}
+
+AsyncLogSink::~AsyncLogSink() {
+  {
+    std::unique_lock<std::mutex> lock(mu_);
+    closed_ = true;
+  }
+  non_empty_.notify_one();
+  flusher_.join();
+}
+
+AsyncLogSink::Slot* AsyncLogSink::acquire(uint64_t* pos) noexcept {
+  uint64_t p = tail_.load(std::memory_order_relaxed);
+  for (;;) {
+    Slot* s = slot(p);
+    uint64_t seq = s->sequence.load(std::memory_order_acquire);
+    auto diff = static_cast<int64_t>(seq - p);
+    if (diff == 0) {
+      if (tail_.compare_exchange_weak(p, p + 1, std::memory_order_relaxed)) {
+        *pos = p;
+        return s;
+      }
+      continue;
+    }
+
+    if (diff > 0) {
+      p = tail_.load(std::memory_order_relaxed);
+      continue;
+    }
+
+    switch (options_.overflow) {
+      case OverflowPolicy::kBlock:
+        wakeup();
+        std::this_thread::yield();
+        p = tail_.load(std::memory_order_relaxed);
+        continue;
+      case OverflowPolicy::kCount:
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+        return nullptr;
+      case OverflowPolicy::kDrop:
+        return nullptr;
+    }
+  }
+}
+
+size_t AsyncLogSink::copy_name(Slot* s,
+                               std::string_view name) const noexcept {
+  size_t n = std::min(name.size(), (stride_ - sizeof(Slot)) / 4);
+  std::memcpy(s->data(), name.data(), n);
+  return n;
+}
+
+size_t AsyncLogSink::write_error(char* out, size_t cap, const char* what,
+                                 const char* fmt) noexcept {
+  try {
+    auto r = fmt::format_to_n(out, cap, "<{}: {}>", what, fmt);
+    return std::min(r.size, cap);
+  } catch (...) {
+    return 0;
+  }
+}
+
+void AsyncLogSink::publish(Slot* s, uint64_t pos, int64_t usecs,
+                           const char* level, size_t name_size,
+                           size_t size) noexcept {
+  s->usecs = usecs;
+  s->level = level;
+  s->name_size = static_cast<uint32_t>(name_size);
+  s->data()[name_size + size] = '\n';
+  s->size = static_cast<uint32_t>(size + 1);
+  s->sequence.store(pos + 1, std::memory_order_release);
+
+  uint64_t used = pos - head_.load(std::memory_order_relaxed);
+  if (used > mask_ / 2) {
+    wakeup();
+  }
+}
+
+void AsyncLogSink::wakeup() noexcept {
+  if (!wakeup_.exchange(true, std::memory_order_acq_rel)) {
+    non_empty_.notify_one();
+  }
+}
+
+size_t AsyncLogSink::drain() {
+  char prefix[kMaxBatch][kMaxPrefix];
+  std::string_view iov[kMaxBatch * 2 + 1];
+  std::string dropped;
+
+  uint64_t head = head_.load(std::memory_order_relaxed);
+  size_t n = 0, m = 0;
+  for (; n < kMaxBatch; ++n) {
+    Slot* s = slot(head + n);
+    if (s->sequence.load(std::memory_order_acquire) != head + n + 1) {
+      break;
+    }
+    std::string_view name(s->data(), s->name_size);
+    auto r = fmt::format_to_n(prefix[n], kMaxPrefix, "[{}] [{}] [{}] ",
+                              Timestamp{s->usecs}, name, s->level);
+    iov[m++] = std::string_view(prefix[n], std::min(r.size, kMaxPrefix));
+    iov[m++] = std::string_view(s->data() + s->name_size, s->size);
+  }
+
+  uint64_t lost = dropped_.exchange(0, std::memory_order_relaxed);
+  if (lost) {
+    dropped = fmt::format("[{}] [pedrolib] [WARN] {} log records dropped\n",
+                          Timestamp::Now(), lost);
+    iov[m++] = dropped;
+  }
+
+  if (m == 0) {
+    return 0;
+  }
+
+  WriteFully(file_, iov, m);
+  for (size_t i = 0; i < n; ++i) {
+    slot(head + i)->sequence.store(head + i + mask_ + 1,
+                                   std::memory_order_release);
+  }
+  head_.store(head + n, std::memory_order_release);
+  return n;
+}
+
+void AsyncLogSink::flusher() {
+  Backoff backoff;
+  for (;;) {
+    size_t n = drain();
+    if (n > 0) {
+      backoff.Reset();
+    }
+
+    std::unique_lock<std::mutex> lock(mu_);
+    uint64_t head = head_.load(std::memory_order_relaxed);
+    if (head >= flush_target_) {
+      flushed_.notify_all();
+    }
+    if (n == kMaxBatch) {
+      continue;
+    }
+    if (closed_ && head == tail_.load(std::memory_order_acquire)) {
+      return;
+    }
+    if (n == 0 && head >= flush_target_ && !closed_) {
+      wakeup_.store(false, std::memory_order_release);
+      non_empty_.wait_for(lock, std::chrono::microseconds(
+                                    options_.flush_interval.Microseconds()));
+      continue;
+    }
+    if (n == 0) {
+      // A producer claimed the next slot but has not published it yet.
+      lock.unlock();
+      backoff.Pause();
+    }
+  }
+}
+
+void AsyncLogSink::Flush() {
+  std::unique_lock<std::mutex> lock(mu_);
+  uint64_t target = tail_.load(std::memory_order_acquire);
+  flush_target_ = std::max(flush_target_, target);
+  non_empty_.notify_one();
+  while (head_.load(std::memory_order_acquire) < target) {
+    flushed_.wait(lock);
+  }
+}
+
+}  // namespace pedrolib
@@ -0,0 +1,682 @@
+#include "pedrolib/logger/binary_sink.h"
+#include <fmt/args.h>
+#include <fmt/format.h>
+#include <algorithm>
+#include <unordered_map>
+#include "pedrolib/buffer/array_buffer.h"
+
+namespace pedrolib {
+
+struct BinaryLogSink::ThreadBuffer {
+  explicit ThreadBuffer(size_t capacity)
+      : data(new char[capacity]), mask(capacity - 1) {}
+
+  std::unique_ptr<char[]> data;
+  size_t mask;
+  alignas(64) std::atomic<uint64_t> head{};
+  alignas(64) std::atomic<uint64_t> tail{};
+  uint64_t cached_head{};
+  std::atomic_bool closed{false};
+};
+
+namespace {
+
+constexpr uint32_t kPadding = UINT32_MAX;
+constexpr char kMagic[4] = {'P', 'D', 'L', 'G'};
+constexpr uint32_t kVersion = 1;
+
+enum class Frame : uint8_t {
+  kFormat = 1,
+  kRecord = 2,
+  kDropped = 3,
+};
+
+// Level and argument types are literals or static arrays, so their addresses
+// identify them. Format strings and logger names may be built at run time in
+// reused storage and are told apart by content.
+struct FormatKey {
+  const char* level;
+  std::string fmt;
+  const void* types;
+
+  bool operator==(const FormatKey& other) const noexcept {
+    return level == other.level && fmt == other.fmt && types == other.types;
+  }
+};
+
+struct FormatKeyHash {
+  size_t operator()(const FormatKey& key) const noexcept {
+    std::hash<const void*> hash;
+    size_t h = hash(key.level);
+    h = h * 31 + std::hash<std::string>()(key.fmt);
+    h = h * 31 + hash(key.types);
+    return h;
+  }
+};
+
+// The per-thread cache is keyed by address instead, so a hit costs a string
+// comparison rather than hashing the format.
+struct FormatAddress {
+  const char* level;
+  const char* fmt;
+  const void* types;
+
+  bool operator==(const FormatAddress& other) const noexcept {
+    return level == other.level && fmt == other.fmt && types == other.types;
+  }
+};
+
+struct FormatAddressHash {
+  size_t operator()(const FormatAddress& key) const noexcept {
+    std::hash<const void*> hash;
+    size_t h = hash(key.level);
+    h = h * 31 + hash(key.fmt);
+    h = h * 31 + hash(key.types);
+    return h;
+  }
+};
+
+// Nearly every format is used by a single logger, so the names sharing a
+// key are searched linearly.
+using FormatNames = std::vector<std::pair<std::string, uint32_t>>;
+
+const uint32_t* FindName(const FormatNames& names, std::string_view name) {
+  for (auto& [n, id] : names) {
+    if (n == name) {
+      return &id;
+    }
+  }
+  return nullptr;
+}
+
+struct FormatRegistry {
+  std::mutex mu;
+  std::unordered_map<FormatKey, FormatNames, FormatKeyHash> ids;
+  std::vector<BinaryLogFormat> formats;
+};
+
+// An entry holds the text last seen at its address and is replaced when that
+// storage is reused for another format.
+struct CachedFormat {
+  std::string fmt;
+  FormatNames names;
+};
+
+using FormatCache =
+    std::unordered_map<FormatAddress, CachedFormat, FormatAddressHash>;
+
+// Formats built at run time may each have a new address; the cache is dropped
+// rather than grown past this.
+constexpr size_t kMaxCachedFormats = 1024;
+
+FormatRegistry& GetFormatRegistry() {
+  static auto* registry = new FormatRegistry();
+  return *registry;
+}
+
+struct ThreadBuffers {
+  uint64_t last_id{};
+  BinaryLogSink::ThreadBuffer* last{};
+  std::unordered_map<uint64_t, std::shared_ptr<BinaryLogSink::ThreadBuffer>>
+      buffers;
+
+  ~ThreadBuffers() {
+    for (auto& [_, buffer] : buffers) {
+      buffer->closed.store(true, std::memory_order_release);
+    }
+  }
+};
+
+thread_local ThreadBuffers tls_buffers;
+
+std::atomic<uint64_t> sink_ids{1};
+
+size_t RoundUpPowerOfTwo(size_t n) {
+  size_t x = 1;
+  while (x < n) {
+    x <<= 1;
+  }
+  return x;
+}
+
+size_t AlignRecord(size_t n) {
+  return (n + 7) & ~static_cast<size_t>(7);
+}
+
+template <typename T>
+void Put(std::string* out, T value) {
+  out->append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+void PutString(std::string* out, std::string_view value) {
+  Put(out, static_cast<uint32_t>(value.size()));
+  out->append(value);
+}
+
+struct Reader {
+  const char* p;
+  const char* end;
+
+  template <typename T>
+  bool Get(T* value) {
+    if (static_cast<size_t>(end - p) < sizeof(T)) {
+      return false;
+    }
+    std::memcpy(value, p, sizeof(T));
+    p += sizeof(T);
+    return true;
+  }
+
+  bool GetString(std::string_view* value) {
+    uint32_t n;
+    if (!Get(&n) || static_cast<size_t>(end - p) < n) {
+      return false;
+    }
+    *value = std::string_view(p, n);
+    p += n;
+    return true;
+  }
+};
+
+bool WriteFully(File* file, std::string_view data) {
+  while (!data.empty()) {
+    ssize_t w = file->Write(data.data(), data.size());
+    if (w < 0 && errno == EINTR) {
+      continue;
+    }
+    if (w <= 0) {
+      return false;
+    }
+    data.remove_prefix(w);
+  }
+  return true;
+}
+
+void FormatDropped(std::string* out, int64_t usecs, uint64_t count) {
+  fmt::format_to(std::back_inserter(*out),
+                 "[{}] [pedrolib] [WARN] {} log records dropped\n",
+                 Timestamp{usecs}, count);
+}
+
+void FormatRecord(std::string* out, const BinaryLogFormat& format,
+                  int64_t usecs, std::string_view payload) {
+  using detail::ArgType;
+
+  fmt::format_to(std::back_inserter(*out), "[{}] [{}] [{}] ",
+                 Timestamp{usecs}, format.name, format.level);
+
+  fmt::dynamic_format_arg_store<fmt::format_context> store;
+  Reader reader{payload.data(), payload.data() + payload.size()};
+  bool ok = true;
+  for (ArgType type : format.types) {
+    switch (type) {
+      case ArgType::kBool: {
+        bool x{};
+        ok = ok && reader.Get(&x);
+        store.push_back(x);
+        break;
+      }
+      case ArgType::kChar: {
+        char x{};
+        ok = ok && reader.Get(&x);
+        store.push_back(x);
+        break;
+      }
+      case ArgType::kInt64: {
+        int64_t x{};
+        ok = ok && reader.Get(&x);
+        store.push_back(x);
+        break;
+      }
+      case ArgType::kUInt64: {
+        uint64_t x{};
+        ok = ok && reader.Get(&x);
+        store.push_back(x);
+        break;
+      }
+      case ArgType::kDouble: {
+        double x{};
+        ok = ok && reader.Get(&x);
+        store.push_back(x);
+        break;
+      }
+      case ArgType::kPointer: {
+        uint64_t x{};
+        ok = ok && reader.Get(&x);
+        store.push_back(reinterpret_cast<const void*>(x));
+        break;
+      }
+      case ArgType::kString: {
+        std::string_view x;
+        ok = ok && reader.GetString(&x);
+        store.push_back(x);
+        break;
+      }
+    }
+  }
+
+  if (!ok) {
+    out->append("<truncated record>\n");
+    return;
+  }
+
+  try {
+    fmt::vformat_to(std::back_inserter(*out), format.fmt, store);
+  } catch (const fmt::format_error& e) {
+    fmt::format_to(std::back_inserter(*out), "<{}: {}>", e.what(),
+                   format.fmt);
+  }
+  out->push_back('\n');
+}
+
+}  // namespace
+
+BinaryLogSink::BinaryLogSink(File file, const Options& options)
+    : id_(sink_ids.fetch_add(1, std::memory_order_relaxed)),
+      file_(std::move(file)),
+      options_(options) {
+  options_.buffer_bytes = RoundUpPowerOfTwo(
+      std::max<size_t>(options.buffer_bytes, 2 * kRecordHeader));
+  flusher_ = std::thread([this] { flusher(); });
+}
+
+BinaryLogSink::~BinaryLogSink() {
+  {
+    std::unique_lock<std::mutex> lock(mu_);
+    closed_ = true;
+  }
+  wakeup();
+  flusher_.join();
+}
+
+uint32_t BinaryLogSink::lookup(std::string_view name, const char* level,
+                               const char* fmt, const detail::ArgType* types,
+                               size_t nargs) {
+  thread_local FormatCache cache;
+
+  FormatAddress address{level, fmt, types};
+  auto it = cache.find(address);
+  bool current = it != cache.end() && it->second.fmt == fmt;
+  if (current) {
+    if (const uint32_t* id = FindName(it->second.names, name)) {
+      return *id;
+    }
+  }
+
+  uint32_t id;
+  {
+    auto& registry = GetFormatRegistry();
+    std::unique_lock<std::mutex> lock(registry.mu);
+    auto& names = registry.ids[FormatKey{level, fmt, types}];
+    if (const uint32_t* found = FindName(names, name)) {
+      id = *found;
+    } else {
+      id = static_cast<uint32_t>(registry.formats.size());
+      names.emplace_back(name, id);
+      registry.formats.push_back(BinaryLogFormat{
+          .name = std::string(name),
+          .level = level,
+          .fmt = fmt,
+          .types = std::vector<detail::ArgType>(types, types + nargs),
+      });
+    }
+  }
+
+  CachedFormat* entry = current ? &it->second : nullptr;
+  if (entry == nullptr) {
+    if (it == cache.end() && cache.size() >= kMaxCachedFormats) {
+      cache.clear();
+    }
+    entry = &cache[address];
+    entry->fmt = fmt;
+    entry->names.clear();
+  }
+  entry->names.emplace_back(name, id);
+  return id;
+}
+
+BinaryLogSink::ThreadBuffer* BinaryLogSink::buffer() {
+  if (tls_buffers.last_id == id_) {
+    return tls_buffers.last;
+  }
+
+  auto& buf = tls_buffers.buffers[id_];
+  if (buf == nullptr) {
+    buf = std::make_shared<ThreadBuffer>(options_.buffer_bytes);
+    std::unique_lock<std::mutex> lock(mu_);
+    buffers_.push_back(buf);
+  }
+  tls_buffers.last_id = id_;
+  tls_buffers.last = buf.get();
+  return buf.get();
+}
+
+char* BinaryLogSink::reserve(ThreadBuffer* buffer, size_t n) {
+  n = AlignRecord(n);
+  size_t capacity = buffer->mask + 1;
+  if (n > capacity / 2) {
+    dropped_.fetch_add(1, std::memory_order_relaxed);
+    return nullptr;
+  }
+
+  for (;;) {
+    uint64_t tail = buffer->tail.load(std::memory_order_relaxed);
+    size_t offset = tail & buffer->mask;
+    size_t contiguous = capacity - offset;
+    size_t need = n <= contiguous ? n : contiguous + n;
+
+    if (tail + need - buffer->cached_head > capacity) {
+      buffer->cached_head = buffer->head.load(std::memory_order_acquire);
+    }
+    if (tail + need - buffer->cached_head > capacity) {
+      switch (options_.overflow) {
+        case OverflowPolicy::kBlock:
+          wakeup();
+          std::this_thread::yield();
+          continue;
+        case OverflowPolicy::kCount:
+          dropped_.fetch_add(1, std::memory_order_relaxed);
+          return nullptr;
+        case OverflowPolicy::kDrop:
+          return nullptr;
+      }
+    }
+
+    char* p = buffer->data.get() + offset;
+    if (n > contiguous) {
+      auto size = static_cast<uint32_t>(contiguous);
+      std::memcpy(p, &size, sizeof(size));
+      std::memcpy(p + 4, &kPadding, sizeof(kPadding));
+      buffer->tail.store(tail + contiguous, std::memory_order_release);
+      p = buffer->data.get();
+    }
+    return p;
+  }
+}
+
+void BinaryLogSink::commit(ThreadBuffer* buffer, size_t n) {
+  uint64_t tail = buffer->tail.load(std::memory_order_relaxed);
+  buffer->tail.store(tail + AlignRecord(n), std::memory_order_release);
+
+  // Pairs with the fence in flusher(): either the flusher sees the new tail
+  // before sleeping or this thread sees it sleeping.
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (sleeping_.load(std::memory_order_relaxed)) {
+    wakeup();
+  }
+}
+
+void BinaryLogSink::wakeup() noexcept {
+  if (sleeping_.exchange(0, std::memory_order_acq_rel)) {
+    FutexWake(&sleeping_, 1);
+  }
+}
+
+bool BinaryLogSink::pending() {
+  std::unique_lock<std::mutex> lock(mu_);
+  if (closed_ || flushing_ || dropped_.load(std::memory_order_relaxed)) {
+    return true;
+  }
+  for (auto& buffer : buffers_) {
+    if (buffer->head.load(std::memory_order_relaxed) !=
+        buffer->tail.load(std::memory_order_acquire)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void BinaryLogSink::flusher() {
+  struct Pending {
+    int64_t usecs;
+    uint32_t id;
+    std::string_view payload;
+  };
+
+  std::string out;
+  std::vector<BinaryLogFormat> formats;
+  std::vector<Pending> records;
+  std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+  std::vector<uint64_t> heads;
+
+  if (options_.mode == Mode::kBinary) {
+    out.append(kMagic, sizeof(kMagic));
+    Put(&out, kVersion);
+  }
+
+  for (;;) {
+    bool closed;
+    {
+      std::unique_lock<std::mutex> lock(mu_);
+      buffers = buffers_;
+      closed = closed_;
+    }
+
+    records.clear();
+    heads.clear();
+    for (auto& buffer : buffers) {
+      uint64_t head = buffer->head.load(std::memory_order_relaxed);
+      uint64_t tail = buffer->tail.load(std::memory_order_acquire);
+      while (head < tail) {
+        const char* p = buffer->data.get() + (head & buffer->mask);
+        uint32_t size, id;
+        int64_t usecs;
+        std::memcpy(&size, p, sizeof(size));
+        std::memcpy(&id, p + 4, sizeof(id));
+        if (id != kPadding) {
+          std::memcpy(&usecs, p + 8, sizeof(usecs));
+          records.push_back(Pending{
+              .usecs = usecs,
+              .id = id,
+              .payload = std::string_view(p + kRecordHeader,
+                                          size - kRecordHeader),
+          });
+        }
+        head += id == kPadding ? size : AlignRecord(size);
+      }
+      heads.push_back(head);
+    }
+
+    std::stable_sort(records.begin(), records.end(),
+                     [](const Pending& x, const Pending& y) {
+                       return x.usecs < y.usecs;
+                     });
+
+    size_t known = formats.size();
+    {
+      auto& registry = GetFormatRegistry();
+      std::unique_lock<std::mutex> lock(registry.mu);
+      formats.insert(formats.end(), registry.formats.begin() + known,
+                     registry.formats.end());
+    }
+
+    uint64_t lost = dropped_.exchange(0, std::memory_order_relaxed);
+    if (options_.mode == Mode::kBinary) {
+      for (size_t i = known; i < formats.size(); ++i) {
+        Put(&out, Frame::kFormat);
+        Put(&out, static_cast<uint32_t>(i));
+        Put(&out, static_cast<uint8_t>(formats[i].types.size()));
+        for (auto type : formats[i].types) {
+          Put(&out, type);
+        }
+        PutString(&out, formats[i].name);
+        PutString(&out, formats[i].level);
+        PutString(&out, formats[i].fmt);
+      }
+      for (auto& record : records) {
+        Put(&out, Frame::kRecord);
+        Put(&out, record.id);
+        Put(&out, record.usecs);
+        PutString(&out, record.payload);
+      }
+      if (lost) {
+        Put(&out, Frame::kDropped);
+        Put(&out, lost);
+        Put(&out, Timestamp::Now().usecs);
+      }
+    } else {
+      for (auto& record : records) {
+        FormatRecord(&out, formats[record.id], record.usecs, record.payload);
+      }
+      if (lost) {
+        FormatDropped(&out, Timestamp::Now().usecs, lost);
+      }
+    }
+
+    if (!out.empty()) {
+      WriteFully(&file_, out);
+      out.clear();
+    }
+
+    for (size_t i = 0; i < buffers.size(); ++i) {
+      buffers[i]->head.store(heads[i], std::memory_order_release);
+    }
+
+    std::unique_lock<std::mutex> lock(mu_);
+    buffers_.erase(
+        std::remove_if(buffers_.begin(), buffers_.end(),
+                       [](const std::shared_ptr<ThreadBuffer>& buffer) {
+                         return buffer->closed.load(std::memory_order_acquire) &&
+                                buffer->head.load(std::memory_order_relaxed) ==
+                                    buffer->tail.load(std::memory_order_acquire);
+                       }),
+        buffers_.end());
+
+    ++rounds_;
+    flushed_.notify_all();
+    if (closed) {
+      return;
+    }
+    if (!records.empty() || flushing_) {
+      continue;
+    }
+    lock.unlock();
+
+    sleeping_.store(1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (!pending()) {
+      FutexWait(&sleeping_, 1);
+    }
+    sleeping_.store(0, std::memory_order_relaxed);
+  }
+}
+
+void BinaryLogSink::Flush() {
+  std::unique_lock<std::mutex> lock(mu_);
+  uint64_t target = rounds_ + 2;
+  ++flushing_;
+  wakeup();
+  while (rounds_ < target) {
+    flushed_.wait(lock);
+  }
+  --flushing_;
+}
+
+Error BinaryLogDecoder::Decode(File* input, File* output) {
+  ArrayBuffer buffer(65536);
+  std::string out;
+  bool header = false;
+
+  for (;;) {
+    buffer.EnsureWritable(65536, false);
+    ssize_t r = buffer.Append(input);
+    if (r < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return input->GetError();
+    }
+
+    Reader reader{buffer.ReadIndex(), buffer.ReadIndex() + buffer.ReadableBytes()};
+    for (;;) {
+      Reader frame = reader;
+      Frame kind;
+      if (!frame.Get(&kind)) {
+        break;
+      }
+
+      // Every run of a sink starts with a header, so a log appended to
+      // across runs has one at each run's first frame. Format ids restart.
+      if (static_cast<char>(kind) == kMagic[0]) {
+        char magic[sizeof(kMagic)];
+        uint32_t version;
+        frame = reader;
+        if (!frame.Get(&magic) || !frame.Get(&version)) {
+          break;
+        }
+        if (std::memcmp(magic, kMagic, sizeof(kMagic)) != 0 ||
+            version != kVersion) {
+          return Error{EINVAL};
+        }
+        formats_.clear();
+        header = true;
+        reader = frame;
+        continue;
+      }
+
+      if (!header) {
+        return Error{EINVAL};
+      }
+      if (kind == Frame::kFormat) {
+        uint32_t id;
+        uint8_t nargs;
+        BinaryLogFormat format;
+        if (!frame.Get(&id) || !frame.Get(&nargs)) {
+          break;
+        }
+        format.types.resize(nargs);
+        bool ok = true;
+        for (auto& type : format.types) {
+          ok = ok && frame.Get(&type);
+        }
+        std::string_view name, level, fmt;
+        if (!ok || !frame.GetString(&name) || !frame.GetString(&level) ||
+            !frame.GetString(&fmt)) {
+          break;
+        }
+        format.name = name;
+        format.level = level;
+        format.fmt = fmt;
+        if (formats_.size() <= id) {
+          formats_.resize(id + 1);
+        }
+        formats_[id] = std::move(format);
+      } else if (kind == Frame::kRecord) {
+        uint32_t id;
+        int64_t usecs;
+        std::string_view payload;
+        if (!frame.Get(&id) || !frame.Get(&usecs) ||
+            !frame.GetString(&payload)) {
+          break;
+        }
+        if (id >= formats_.size()) {
+          return Error{EINVAL};
+        }
+        FormatRecord(&out, formats_[id], usecs, payload);
+      } else if (kind == Frame::kDropped) {
+        uint64_t count;
+        int64_t usecs;
+        if (!frame.Get(&count) || !frame.Get(&usecs)) {
+          break;
+        }
+        FormatDropped(&out, usecs, count);
+      } else {
+        return Error{EINVAL};
+      }
+      reader = frame;
+    }
+
+    buffer.Retrieve(reader.p - buffer.ReadIndex());
+    if (!WriteFully(output, out)) {
+      return output->GetError();
+    }
+    out.clear();
+
+    if (r == 0) {
+      return buffer.ReadableBytes() || !header ? Error{EINVAL}
+                                               : Error::Success();
+    }
+  }
+}
+
+}  // namespace pedrolib
@@ -0,0 +1,43 @@
+#include "pedrolib/memory/arena.h"
+#include <algorithm>
+#include <cstdlib>
+#include <new>
+
+namespace pedrolib {
+
+Arena::~Arena() {
+  while (blocks_ != nullptr) {
+    Block* prev = blocks_->prev;
+    blocks_->~Block();
+    std::free(blocks_);
+    blocks_ = prev;
+  }
+}
+
+void* Arena::allocate(size_t reserve, size_t align) {
+  std::lock_guard<std::mutex> lock(mu_);
+  bool dedicated = reserve > block_size_ / 4;
+  Block* block = current_.load(std::memory_order_relaxed);
+  if (!dedicated && block != nullptr) {
+    // Another thread may have started a block while this one waited.
+    size_t offset = block->used.fetch_add(reserve, std::memory_order_relaxed);
+    if (offset + reserve <= block->size) {
+      return aligned(block->Data() + offset, align);
+    }
+  }
+
+  size_t size = dedicated ? reserve : std::max(block_size_, reserve);
+  void* memory = std::malloc(sizeof(Block) + size);
+  if (memory == nullptr) {
+    throw std::bad_alloc();
+  }
+  block = new (memory) Block{blocks_, size, {reserve}};
+  blocks_ = block;
+  memory_usage_.fetch_add(sizeof(Block) + size, std::memory_order_relaxed);
+  if (!dedicated) {
+    current_.store(block, std::memory_order_release);
+  }
+  return aligned(block->Data(), align);
+}
+
+}  // namespace pedrolib
@@ -0,0 +1,189 @@
+#include "pedrolib/memory/epoch.h"
+#include <thread>
+#include <unordered_map>
+
+namespace pedrolib {
+
+struct EpochDomain::ThreadRecords {
+  std::unordered_map<uint64_t, std::shared_ptr<Record>> records;
+
+  ~ThreadRecords();
+};
+
+namespace {
+
+// Trivially destructible, so it can still be read from the destructors of
+// thread_locals that outlive tls_records.
+thread_local bool tls_records_destroyed = false;
+
+thread_local EpochDomain::ThreadRecords tls_records;
+
+std::atomic<uint64_t> domain_ids{1};
+
+void FreeBag(EpochDomain::Bag& bag) {
+  for (auto& retired : bag.retired) {
+    retired.Free();
+  }
+  bag.retired.clear();
+}
+
+}  // namespace
+
+EpochDomain::ThreadRecords::~ThreadRecords() {
+  tls_records_destroyed = true;
+  // The records may be adopted by other threads from here on, so the cache
+  // must not hand them out either.
+  cache_ = {};
+  for (auto& [_, record] : records) {
+    record->exited.store(true, std::memory_order_release);
+  }
+}
+
+EpochDomain::EpochDomain() : id_(domain_ids.fetch_add(1)) {}
+
+EpochDomain::~EpochDomain() {
+  for (auto& record : owned_) {
+    for (auto& bag : record->bags) {
+      FreeBag(bag);
+    }
+  }
+}
+
+EpochDomain& EpochDomain::Default() {
+  static auto* domain = new EpochDomain();
+  return *domain;
+}
+
+std::shared_ptr<EpochDomain::Record> EpochDomain::borrow() {
+  for (Record* r = records_.load(std::memory_order_acquire); r != nullptr;
+       r = r->next) {
+    bool exited = true;
+    if (r->exited.compare_exchange_strong(exited, false,
+                                          std::memory_order_acq_rel)) {
+      std::unique_lock<std::mutex> lock(mu_);
+      for (auto& record : owned_) {
+        if (record.get() == r) {
+          return record;
+        }
+      }
+    }
+  }
+
+  auto record = std::make_shared<Record>();
+  {
+    std::unique_lock<std::mutex> lock(mu_);
+    owned_.push_back(record);
+  }
+  Record* head = records_.load(std::memory_order_relaxed);
+  do {
+    record->next = head;
+  } while (!records_.compare_exchange_weak(head, record.get(),
+                                           std::memory_order_release,
+                                           std::memory_order_relaxed));
+  return record;
+}
+
+EpochDomain::Record* EpochDomain::adopt() {
+  auto record = borrow();
+  tls_records.records[id_] = record;
+  return record.get();
+}
+
+EpochDomain::Record* EpochDomain::lookup() {
+  if (tls_records_destroyed) {
+    return nullptr;
+  }
+  Record* record;
+  auto it = tls_records.records.find(id_);
+  if (it != tls_records.records.end()) {
+    record = it->second.get();
+  } else {
+    record = adopt();
+  }
+  cache_.id = id_;
+  cache_.record = record;
+  return record;
+}
+
+bool EpochDomain::TryAdvance() noexcept {
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  uint64_t epoch = epoch_.load(std::memory_order_relaxed);
+  for (Record* r = records_.load(std::memory_order_acquire); r != nullptr;
+       r = r->next) {
+    uint64_t local = r->local.load(std::memory_order_relaxed);
+    if ((local & 1) && (local >> 1) != epoch) {
+      return false;
+    }
+  }
+  std::atomic_thread_fence(std::memory_order_acquire);
+  return epoch_.compare_exchange_strong(epoch, epoch + 1,
+                                        std::memory_order_release,
+                                        std::memory_order_relaxed);
+}
+
+void EpochDomain::Collect(Record* record, uint64_t epoch) {
+  for (auto& bag : record->bags) {
+    if (!bag.retired.empty() && bag.epoch + 2 <= epoch) {
+      FreeBag(bag);
+    }
+  }
+}
+
+void EpochDomain::CollectExited(uint64_t epoch) {
+  // Claim records of exited threads the same way a new thread would, so
+  // the garbage they left behind does not wait for a new owner.
+  for (Record* r = records_.load(std::memory_order_acquire); r != nullptr;
+       r = r->next) {
+    bool exited = true;
+    if (r->exited.compare_exchange_strong(exited, false,
+                                          std::memory_order_acq_rel)) {
+      Collect(r, epoch);
+      r->exited.store(true, std::memory_order_release);
+    }
+  }
+}
+
+void EpochDomain::Retire(Record* record, Retired retired) {
+  if (record == nullptr) {
+    // Retired during thread exit: left in a borrowed record for the next
+    // collection of exited records.
+    auto borrowed = borrow();
+    Retire(borrowed.get(), retired);
+    borrowed->exited.store(true, std::memory_order_release);
+    return;
+  }
+  uint64_t epoch = epoch_.load(std::memory_order_seq_cst);
+  Bag& bag = record->bags[epoch % 3];
+  if (bag.epoch != epoch) {
+    // The bag was filled at least three epochs ago.
+    FreeBag(bag);
+    bag.epoch = epoch;
+  }
+  bag.retired.push_back(retired);
+
+  if (++record->retires < kAdvanceInterval) {
+    return;
+  }
+  record->retires = 0;
+  TryAdvance();
+  epoch = epoch_.load(std::memory_order_acquire);
+  Collect(record, epoch);
+  CollectExited(epoch);
+}
+
+void EpochDomain::Synchronize() {
+  uint64_t target = epoch_.load(std::memory_order_seq_cst) + 2;
+  while (epoch_.load(std::memory_order_acquire) < target) {
+    if (!TryAdvance()) {
+      std::this_thread::yield();
+    }
+  }
+
+  uint64_t epoch = epoch_.load(std::memory_order_acquire);
+  if (Record* r = record()) {
+    Collect(r, epoch);
+  }
+  CollectExited(epoch);
+}
+
+}  // namespace pedrolib
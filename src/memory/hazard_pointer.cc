@@ -0,0 +1,220 @@
+#include "pedrolib/memory/hazard_pointer.h"
+#include <algorithm>
+#include <unordered_map>
+
+namespace pedrolib {
+
+struct HazardPointerDomain::ThreadRecords {
+  std::unordered_map<uint64_t, std::shared_ptr<Record>> records;
+
+  ~ThreadRecords();
+};
+
+namespace {
+
+// Trivially destructible, so it can still be read from the destructors of
+// thread_locals that outlive tls_records.
+thread_local bool tls_records_destroyed = false;
+
+thread_local HazardPointerDomain::ThreadRecords tls_records;
+
+std::atomic<uint64_t> domain_ids{1};
+
+}  // namespace
+
+HazardPointerDomain::ThreadRecords::~ThreadRecords() {
+  tls_records_destroyed = true;
+  // The records may be adopted by other threads from here on, so the cache
+  // must not hand them out either.
+  cache_ = {};
+  for (auto& [_, record] : records) {
+    record->exited.store(true, std::memory_order_release);
+  }
+}
+
+HazardPointerDomain::HazardPointerDomain() : id_(domain_ids.fetch_add(1)) {}
+
+HazardPointerDomain::~HazardPointerDomain() {
+  for (auto& record : owned_records_) {
+    for (auto& retired : record->retired) {
+      retired.Free();
+    }
+    record->retired.clear();
+    record->slots.clear();
+  }
+}
+
+HazardPointerDomain& HazardPointerDomain::Default() {
+  static auto* domain = new HazardPointerDomain();
+  return *domain;
+}
+
+std::shared_ptr<HazardPointerDomain::Record> HazardPointerDomain::borrow() {
+  for (Record* r = records_.load(std::memory_order_acquire); r != nullptr;
+       r = r->next) {
+    bool exited = true;
+    if (r->exited.compare_exchange_strong(exited, false,
+                                          std::memory_order_acq_rel)) {
+      std::unique_lock<std::mutex> lock(mu_);
+      for (auto& record : owned_records_) {
+        if (record.get() == r) {
+          return record;
+        }
+      }
+    }
+  }
+
+  auto record = std::make_shared<Record>();
+  {
+    std::unique_lock<std::mutex> lock(mu_);
+    owned_records_.push_back(record);
+  }
+  Record* head = records_.load(std::memory_order_relaxed);
+  do {
+    record->next = head;
+  } while (!records_.compare_exchange_weak(head, record.get(),
+                                           std::memory_order_release,
+                                           std::memory_order_relaxed));
+  return record;
+}
+
+HazardPointerDomain::Record* HazardPointerDomain::adopt() {
+  auto record = borrow();
+  tls_records.records[id_] = record;
+  return record.get();
+}
+
+HazardPointerDomain::Record* HazardPointerDomain::lookup() {
+  if (tls_records_destroyed) {
+    return nullptr;
+  }
+  Record* record;
+  auto it = tls_records.records.find(id_);
+  if (it != tls_records.records.end()) {
+    record = it->second.get();
+  } else {
+    record = adopt();
+  }
+  cache_.id = id_;
+  cache_.record = record;
+  return record;
+}
+
+HazardPointerDomain::Slot* HazardPointerDomain::AcquireSlot() {
+  Record* r = record();
+  if (r != nullptr && !r->slots.empty()) {
+    Slot* slot = r->slots.back();
+    r->slots.pop_back();
+    return slot;
+  }
+
+  for (Slot* s = slots_.load(std::memory_order_acquire); s != nullptr;
+       s = s->next) {
+    bool active = false;
+    if (!s->active.load(std::memory_order_relaxed) &&
+        s->active.compare_exchange_strong(active, true,
+                                          std::memory_order_acquire)) {
+      return s;
+    }
+  }
+
+  auto slot = std::make_unique<Slot>();
+  slot->active.store(true, std::memory_order_relaxed);
+  Slot* s = slot.get();
+  {
+    std::unique_lock<std::mutex> lock(mu_);
+    owned_slots_.push_back(std::move(slot));
+  }
+  Slot* head = slots_.load(std::memory_order_relaxed);
+  do {
+    s->next = head;
+  } while (!slots_.compare_exchange_weak(head, s, std::memory_order_release,
+                                         std::memory_order_relaxed));
+  slot_count_.fetch_add(1, std::memory_order_relaxed);
+  return s;
+}
+
+void HazardPointerDomain::ReleaseSlot(Slot* slot) noexcept {
+  slot->ptr.store(nullptr, std::memory_order_release);
+  // Once this thread's records are gone its record may belong to another
+  // thread, so a hazard pointer destroyed that late returns the slot to the
+  // shared list instead of the record's cache.
+  Record* r = record();
+  if (r != nullptr && r->slots.size() < kCachedSlots) {
+    r->slots.push_back(slot);
+    return;
+  }
+  slot->active.store(false, std::memory_order_release);
+}
+
+void HazardPointerDomain::CollectHazards(std::vector<const void*>& hazards) {
+  // Pairs with the fence in Protect: a reader either sees the node unlinked
+  // or has its hazard visible here.
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  hazards.clear();
+  for (Slot* s = slots_.load(std::memory_order_acquire); s != nullptr;
+       s = s->next) {
+    const void* p = s->ptr.load(std::memory_order_acquire);
+    if (p != nullptr) {
+      hazards.push_back(p);
+    }
+  }
+  std::sort(hazards.begin(), hazards.end());
+}
+
+void HazardPointerDomain::Scan(Record* record,
+                               std::vector<const void*>& hazards) {
+  auto& retired = record->retired;
+  auto kept = std::partition(retired.begin(), retired.end(),
+                             [&](const Retired& r) {
+                               return std::binary_search(
+                                   hazards.begin(), hazards.end(), r.ptr);
+                             });
+  for (auto it = kept; it != retired.end(); ++it) {
+    it->Free();
+  }
+  retired.erase(kept, retired.end());
+}
+
+void HazardPointerDomain::Retire(Record* record, Retired retired) {
+  if (record == nullptr) {
+    // Retired during thread exit: left in a borrowed record for the next
+    // scan of exited records.
+    auto borrowed = borrow();
+    Retire(borrowed.get(), retired);
+    borrowed->exited.store(true, std::memory_order_release);
+    return;
+  }
+  record->retired.push_back(retired);
+  size_t threshold = std::max(
+      kScanThreshold, 2 * slot_count_.load(std::memory_order_relaxed));
+  if (record->retired.size() >= threshold) {
+    Reclaim();
+  }
+}
+
+void HazardPointerDomain::Reclaim() {
+  std::vector<const void*> hazards;
+  CollectHazards(hazards);
+  if (Record* r = record()) {
+    Scan(r, hazards);
+  }
+
+  // Claim records of exited threads the same way a new thread would, so
+  // the garbage and slots they left behind do not wait for a new owner.
+  for (Record* r = records_.load(std::memory_order_acquire); r != nullptr;
+       r = r->next) {
+    bool exited = true;
+    if (r->exited.compare_exchange_strong(exited, false,
+                                          std::memory_order_acq_rel)) {
+      Scan(r, hazards);
+      for (Slot* slot : r->slots) {
+        slot->active.store(false, std::memory_order_release);
+      }
+      r->slots.clear();
+      r->exited.store(true, std::memory_order_release);
+    }
+  }
+}
+
+}  // namespace pedrolib
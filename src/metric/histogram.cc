@@ -0,0 +1,163 @@
+#include "pedrolib/metric/histogram.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <unordered_map>
+
+namespace pedrolib {
+
+Histogram::Shard::Shard(size_t buckets)
+    : counts(new std::atomic<uint64_t>[buckets]()), buckets(buckets) {}
+
+void Histogram::Shard::Reset() noexcept {
+  for (size_t i = 0; i < buckets; ++i) {
+    counts[i].store(0, std::memory_order_relaxed);
+  }
+  sum.store(0, std::memory_order_relaxed);
+  min.store(std::numeric_limits<int64_t>::max(), std::memory_order_relaxed);
+  max.store(std::numeric_limits<int64_t>::min(), std::memory_order_relaxed);
+}
+
+namespace {
+
+struct ThreadShards {
+  std::unordered_map<uint64_t, std::shared_ptr<Histogram::Shard>> shards;
+
+  ~ThreadShards() {
+    for (auto& [_, shard] : shards) {
+      shard->exited.store(true, std::memory_order_release);
+    }
+  }
+};
+
+thread_local ThreadShards tls_shards;
+
+std::atomic<uint64_t> histogram_ids{1};
+
+int SubBucketBits(int significant_digits) {
+  significant_digits = std::clamp(significant_digits, 1, 5);
+  auto largest = static_cast<int64_t>(2 * std::pow(10, significant_digits));
+  int bits = 1;
+  while ((int64_t{1} << bits) < largest) {
+    ++bits;
+  }
+  return bits;
+}
+
+}  // namespace
+
+Histogram::Histogram(int64_t max_value, int significant_digits)
+    : id_(histogram_ids.fetch_add(1, std::memory_order_relaxed)),
+      max_value_(std::max<int64_t>(max_value, 1)),
+      sub_bucket_bits_(SubBucketBits(significant_digits)),
+      buckets_(0) {
+  buckets_ = BucketIndex(max_value_) + 1;
+}
+
+Histogram::~Histogram() = default;
+
+int64_t Histogram::BucketValue(int sub_bucket_bits, size_t index) noexcept {
+  int p = sub_bucket_bits;
+  if (index < (size_t{1} << p)) {
+    return static_cast<int64_t>(index);
+  }
+
+  size_t half = size_t{1} << (p - 1);
+  size_t k = index - (size_t{1} << p);
+  int shift = static_cast<int>(k / half) + 1;
+  auto sub = static_cast<int64_t>(k % half + half);
+  return ((sub + 1) << shift) - 1;
+}
+
+Histogram::Shard* Histogram::adopt() {
+  std::unique_lock<std::mutex> lock(mu_);
+  for (auto& shard : shards_) {
+    bool exited = true;
+    if (shard->exited.compare_exchange_strong(exited, false,
+                                              std::memory_order_acq_rel)) {
+      tls_shards.shards[id_] = shard;
+      return shard.get();
+    }
+  }
+  auto shard = std::make_shared<Shard>(buckets_);
+  shards_.push_back(shard);
+  tls_shards.shards[id_] = shard;
+  return shard.get();
+}
+
+Histogram::Shard* Histogram::lookup() {
+  Shard* shard;
+  auto it = tls_shards.shards.find(id_);
+  if (it != tls_shards.shards.end()) {
+    shard = it->second.get();
+  } else {
+    shard = adopt();
+  }
+  cache_.id = id_;
+  cache_.shard = shard;
+  return shard;
+}
+
+void Histogram::Reset() {
+  std::unique_lock<std::mutex> lock(mu_);
+  for (auto& shard : shards_) {
+    shard->Reset();
+  }
+}
+
+HistogramSnapshot Histogram::Snapshot() const {
+  HistogramSnapshot snapshot;
+  snapshot.sub_bucket_bits_ = sub_bucket_bits_;
+  snapshot.counts_.resize(buckets_);
+  snapshot.min_ = std::numeric_limits<int64_t>::max();
+  snapshot.max_ = std::numeric_limits<int64_t>::min();
+
+  std::unique_lock<std::mutex> lock(mu_);
+  for (auto& shard : shards_) {
+    for (size_t i = 0; i < buckets_; ++i) {
+      uint64_t n = shard->counts[i].load(std::memory_order_relaxed);
+      snapshot.counts_[i] += n;
+      snapshot.count_ += n;
+    }
+    snapshot.sum_ += shard->sum.load(std::memory_order_relaxed);
+    snapshot.min_ =
+        std::min(snapshot.min_, shard->min.load(std::memory_order_relaxed));
+    snapshot.max_ =
+        std::max(snapshot.max_, shard->max.load(std::memory_order_relaxed));
+  }
+
+  if (snapshot.count_ == 0) {
+    snapshot.min_ = snapshot.max_ = 0;
+  }
+  return snapshot;
+}
+
+int64_t HistogramSnapshot::Percentile(double percentile) const noexcept {
+  if (count_ == 0) {
+    return 0;
+  }
+
+  percentile = std::clamp(percentile, 0.0, 100.0);
+  auto target = static_cast<uint64_t>(std::ceil(percentile / 100 * count_));
+  target = std::max<uint64_t>(target, 1);
+
+  uint64_t seen = 0;
+  for (size_t i = 0; i < counts_.size(); ++i) {
+    seen += counts_[i];
+    if (seen >= target) {
+      return std::clamp(Histogram::BucketValue(sub_bucket_bits_, i), min_,
+                        max_);
+    }
+  }
+  return max_;
+}
+
+std::string HistogramSnapshot::String() const {
+  return fmt::format(
+      "Histogram[count={}, min={}, mean={:.2f}, p50={}, p90={}, p99={}, "
+      "p999={}, max={}]",
+      count_, min_, Mean(), Percentile(50), Percentile(90), Percentile(99),
+      Percentile(99.9), max_);
+}
+
+}  // namespace pedrolib
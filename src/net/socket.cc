@@ -0,0 +1,310 @@
+#include "pedrolib/net/socket.h"
+#include <linux/errqueue.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#include <vector>
+
+#ifndef SO_ZEROCOPY
+#define SO_ZEROCOPY 60
+#endif
+
+#ifndef MSG_ZEROCOPY
+#define MSG_ZEROCOPY 0x4000000
+#endif
+
+#ifndef SO_EE_CODE_ZEROCOPY_COPIED
+#define SO_EE_CODE_ZEROCOPY_COPIED 1
+#endif
+
+namespace pedrolib {
+
+namespace {
+
+// Batches live on the stack; larger ones are cut short, which callers of
+// sendmmsg/recvmmsg must handle anyway.
+constexpr size_t kMaxBatch = 256;
+
+Error SetOption(int fd, int level, int name, int value) {
+  if (::setsockopt(fd, level, name, &value, sizeof(value)) < 0) {
+    return Error(errno);
+  }
+  return Error::Success();
+}
+
+Error Check(int r) { return r < 0 ? Error(errno) : Error::Success(); }
+
+// Compares send sequence numbers, which wrap around.
+bool SeqBefore(uint32_t x, uint32_t y) {
+  return static_cast<int32_t>(x - y) < 0;
+}
+
+bool IsRecvErr(const struct cmsghdr* cm) {
+  return (cm->cmsg_level == SOL_IP && cm->cmsg_type == IP_RECVERR) ||
+         (cm->cmsg_level == SOL_IPV6 && cm->cmsg_type == IPV6_RECVERR);
+}
+
+}  // namespace
+
+Socket Socket::Create(int family, Type type) {
+  int kind = type == Type::kStream ? SOCK_STREAM : SOCK_DGRAM;
+  return Socket(::socket(family, kind | SOCK_NONBLOCK | SOCK_CLOEXEC, 0));
+}
+
+Socket Socket::CreateListener(const SocketAddress& address, Type type,
+                              bool reuse_port) {
+  Socket socket = Create(address.Family(), type);
+  if (!socket.Valid()) {
+    return socket;
+  }
+  if (address.Family() != AF_UNIX) {
+    if (!socket.SetReuseAddress(true).Empty() ||
+        (reuse_port && !socket.SetReusePort(true).Empty())) {
+      return Socket();
+    }
+  }
+  if (!socket.Bind(address).Empty()) {
+    return Socket();
+  }
+  if (type == Type::kStream && !socket.Listen().Empty()) {
+    return Socket();
+  }
+  return socket;
+}
+
+Error Socket::Bind(const SocketAddress& address) {
+  return Check(::bind(fd_, address.Data(), address.Length()));
+}
+
+Error Socket::Listen(int backlog) { return Check(::listen(fd_, backlog)); }
+
+Error Socket::Connect(const SocketAddress& address) {
+  int r;
+  do {
+    r = ::connect(fd_, address.Data(), address.Length());
+  } while (r < 0 && errno == EINTR);
+  return Check(r);
+}
+
+Error Socket::ConnectResult() const {
+  int err = 0;
+  socklen_t length = sizeof(err);
+  if (::getsockopt(fd_, SOL_SOCKET, SO_ERROR, &err, &length) < 0) {
+    return Error(errno);
+  }
+  return Error(err);
+}
+
+Socket Socket::Accept(SocketAddress* peer) {
+  struct sockaddr* addr = peer ? peer->Data() : nullptr;
+  socklen_t* length = peer ? peer->MutableLength() : nullptr;
+  int fd;
+  do {
+    fd = ::accept4(fd_, addr, length, SOCK_NONBLOCK | SOCK_CLOEXEC);
+  } while (fd < 0 && errno == EINTR);
+  return Socket(fd);
+}
+
+Error Socket::ShutdownWrite() { return Check(::shutdown(fd_, SHUT_WR)); }
+
+std::optional<SocketAddress> Socket::LocalAddress() const {
+  SocketAddress address;
+  if (::getsockname(fd_, address.Data(), address.MutableLength()) < 0) {
+    return std::nullopt;
+  }
+  return address;
+}
+
+std::optional<SocketAddress> Socket::PeerAddress() const {
+  SocketAddress address;
+  if (::getpeername(fd_, address.Data(), address.MutableLength()) < 0) {
+    return std::nullopt;
+  }
+  return address;
+}
+
+Error Socket::SetNoDelay(bool on) {
+  return SetOption(fd_, IPPROTO_TCP, TCP_NODELAY, on);
+}
+
+Error Socket::SetReuseAddress(bool on) {
+  return SetOption(fd_, SOL_SOCKET, SO_REUSEADDR, on);
+}
+
+Error Socket::SetReusePort(bool on) {
+  return SetOption(fd_, SOL_SOCKET, SO_REUSEPORT, on);
+}
+
+Error Socket::SetKeepAlive(bool on) {
+  return SetOption(fd_, SOL_SOCKET, SO_KEEPALIVE, on);
+}
+
+Error Socket::SetSendBufferSize(int bytes) {
+  return SetOption(fd_, SOL_SOCKET, SO_SNDBUF, bytes);
+}
+
+Error Socket::SetReceiveBufferSize(int bytes) {
+  return SetOption(fd_, SOL_SOCKET, SO_RCVBUF, bytes);
+}
+
+ssize_t Socket::Write(const void* buf, size_t n) noexcept {
+  return ::send(fd_, buf, n, MSG_NOSIGNAL);
+}
+
+ssize_t Socket::Writev(std::string_view* buf, size_t n) noexcept {
+  struct iovec stack[kMaxBatch];
+  std::vector<struct iovec> heap;
+  struct iovec* io = stack;
+  if (n > kMaxBatch) {
+    heap.resize(n);
+    io = heap.data();
+  }
+  for (size_t i = 0; i < n; ++i) {
+    io[i].iov_base = const_cast<char*>(buf[i].data());
+    io[i].iov_len = buf[i].size();
+  }
+  struct msghdr msg {};
+  msg.msg_iov = io;
+  msg.msg_iovlen = n;
+  return ::sendmsg(fd_, &msg, MSG_NOSIGNAL);
+}
+
+ssize_t Socket::SendTo(const void* buf, size_t n,
+                       const SocketAddress& address) {
+  return ::sendto(fd_, buf, n, MSG_NOSIGNAL, address.Data(),
+                  address.Length());
+}
+
+ssize_t Socket::ReceiveFrom(void* buf, size_t n, SocketAddress* address) {
+  if (address == nullptr) {
+    return ::recvfrom(fd_, buf, n, 0, nullptr, nullptr);
+  }
+  return ::recvfrom(fd_, buf, n, 0, address->Data(),
+                    address->MutableLength());
+}
+
+int Socket::SendBatch(const Datagram* datagrams, size_t n) {
+  n = std::min(n, kMaxBatch);
+  struct mmsghdr msgs[kMaxBatch];
+  struct iovec io[kMaxBatch];
+  for (size_t i = 0; i < n; ++i) {
+    io[i].iov_base = datagrams[i].data;
+    io[i].iov_len = datagrams[i].size;
+    msgs[i] = {};
+    msgs[i].msg_hdr.msg_iov = &io[i];
+    msgs[i].msg_hdr.msg_iovlen = 1;
+    if (datagrams[i].address != nullptr) {
+      msgs[i].msg_hdr.msg_name = datagrams[i].address->Data();
+      msgs[i].msg_hdr.msg_namelen = datagrams[i].address->Length();
+    }
+  }
+  int r;
+  do {
+    r = ::sendmmsg(fd_, msgs, static_cast<unsigned>(n), MSG_NOSIGNAL);
+  } while (r < 0 && errno == EINTR);
+  return r;
+}
+
+int Socket::ReceiveBatch(Datagram* datagrams, size_t n) {
+  n = std::min(n, kMaxBatch);
+  struct mmsghdr msgs[kMaxBatch];
+  struct iovec io[kMaxBatch];
+  for (size_t i = 0; i < n; ++i) {
+    io[i].iov_base = datagrams[i].data;
+    io[i].iov_len = datagrams[i].size;
+    msgs[i] = {};
+    msgs[i].msg_hdr.msg_iov = &io[i];
+    msgs[i].msg_hdr.msg_iovlen = 1;
+    if (datagrams[i].address != nullptr) {
+      msgs[i].msg_hdr.msg_name = datagrams[i].address->Data();
+      msgs[i].msg_hdr.msg_namelen = *datagrams[i].address->MutableLength();
+    }
+  }
+  int r;
+  do {
+    r = ::recvmmsg(fd_, msgs, static_cast<unsigned>(n), MSG_DONTWAIT,
+                   nullptr);
+  } while (r < 0 && errno == EINTR);
+  for (int i = 0; i < r; ++i) {
+    datagrams[i].size = msgs[i].msg_len;
+    if (datagrams[i].address != nullptr) {
+      *datagrams[i].address->MutableLength() = msgs[i].msg_hdr.msg_namelen;
+    }
+  }
+  return r;
+}
+
+Error Socket::EnableZeroCopy() {
+  return SetOption(fd_, SOL_SOCKET, SO_ZEROCOPY, 1);
+}
+
+ssize_t Socket::SendZeroCopy(const void* buf, size_t n, uint32_t* id) {
+  ssize_t w = ::send(fd_, buf, n, MSG_NOSIGNAL | MSG_ZEROCOPY);
+  if (w < 0) {
+    return w;
+  }
+  // The kernel numbers every successful MSG_ZEROCOPY send, starting at 0.
+  if (id != nullptr) {
+    *id = zerocopy_sent_;
+  }
+  zerocopy_sent_++;
+  return w;
+}
+
+void Socket::completeZeroCopy(uint32_t begin, uint32_t end) {
+  zerocopy_ranges_.emplace_back(begin, end);
+  // Advance only through ranges that touch the completed prefix; the rest
+  // wait for the sends before them.
+  uint32_t& completed = zerocopy_.completed;
+  for (bool advanced = true; advanced;) {
+    advanced = false;
+    for (auto it = zerocopy_ranges_.begin(); it != zerocopy_ranges_.end();) {
+      if (SeqBefore(completed, it->first)) {
+        ++it;
+        continue;
+      }
+      if (SeqBefore(completed, it->second)) {
+        completed = it->second;
+        advanced = true;
+      }
+      it = zerocopy_ranges_.erase(it);
+    }
+  }
+}
+
+Socket::ZeroCopyStats Socket::ReapZeroCopy() {
+  for (;;) {
+    char control[128];
+    struct msghdr msg {};
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+    if (::recvmsg(fd_, &msg, MSG_ERRQUEUE | MSG_DONTWAIT) < 0) {
+      break;
+    }
+    for (struct cmsghdr* cm = CMSG_FIRSTHDR(&msg); cm != nullptr;
+         cm = CMSG_NXTHDR(&msg, cm)) {
+      if (!IsRecvErr(cm)) {
+        continue;
+      }
+      auto err = reinterpret_cast<struct sock_extended_err*>(CMSG_DATA(cm));
+      if (err->ee_errno != 0 || err->ee_origin != SO_EE_ORIGIN_ZEROCOPY) {
+        continue;
+      }
+      // Each notification covers the inclusive range [ee_info, ee_data].
+      completeZeroCopy(err->ee_info, err->ee_data + 1);
+      if (err->ee_code & SO_EE_CODE_ZEROCOPY_COPIED) {
+        zerocopy_.copied += err->ee_data - err->ee_info + 1;
+      }
+    }
+  }
+  return zerocopy_;
+}
+
+std::string Socket::String() const {
+  auto local = LocalAddress();
+  return fmt::format("Socket[fd={}, local={}]", fd_,
+                     local ? local->String() : "none");
+}
+
+}  // namespace pedrolib
@@ -0,0 +1,108 @@
+#include "pedrolib/net/socket_address.h"
+#include <arpa/inet.h>
+#include <algorithm>
+
+namespace pedrolib {
+
+std::optional<SocketAddress> SocketAddress::Parse(std::string_view ip,
+                                                  uint16_t port) {
+  char buf[INET6_ADDRSTRLEN];
+  if (ip.size() >= sizeof(buf)) {
+    return std::nullopt;
+  }
+  std::memcpy(buf, ip.data(), ip.size());
+  buf[ip.size()] = '\0';
+
+  struct sockaddr_in in {};
+  if (::inet_pton(AF_INET, buf, &in.sin_addr) == 1) {
+    in.sin_family = AF_INET;
+    in.sin_port = htons(port);
+    return SocketAddress(reinterpret_cast<struct sockaddr*>(&in),
+                         sizeof(in));
+  }
+
+  struct sockaddr_in6 in6 {};
+  if (::inet_pton(AF_INET6, buf, &in6.sin6_addr) == 1) {
+    in6.sin6_family = AF_INET6;
+    in6.sin6_port = htons(port);
+    return SocketAddress(reinterpret_cast<struct sockaddr*>(&in6),
+                         sizeof(in6));
+  }
+  return std::nullopt;
+}
+
+SocketAddress SocketAddress::Loopback(uint16_t port) {
+  struct sockaddr_in in {};
+  in.sin_family = AF_INET;
+  in.sin_port = htons(port);
+  in.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  return {reinterpret_cast<struct sockaddr*>(&in), sizeof(in)};
+}
+
+SocketAddress SocketAddress::Any(uint16_t port) {
+  struct sockaddr_in in {};
+  in.sin_family = AF_INET;
+  in.sin_port = htons(port);
+  in.sin_addr.s_addr = htonl(INADDR_ANY);
+  return {reinterpret_cast<struct sockaddr*>(&in), sizeof(in)};
+}
+
+SocketAddress SocketAddress::Unix(std::string_view path) {
+  struct sockaddr_un un {};
+  un.sun_family = AF_UNIX;
+  size_t n = std::min(path.size(), sizeof(un.sun_path) - 1);
+  std::memcpy(un.sun_path, path.data(), n);
+  // Pathnames include their terminating '\0'; abstract names do not.
+  size_t terminator = !path.empty() && path[0] != '\0';
+  auto length = static_cast<socklen_t>(
+      offsetof(struct sockaddr_un, sun_path) + n + terminator);
+  return {reinterpret_cast<struct sockaddr*>(&un), length};
+}
+
+uint16_t SocketAddress::Port() const noexcept {
+  switch (Family()) {
+    case AF_INET:
+      return ntohs(
+          reinterpret_cast<const sockaddr_in*>(&storage_)->sin_port);
+    case AF_INET6:
+      return ntohs(
+          reinterpret_cast<const sockaddr_in6*>(&storage_)->sin6_port);
+    default:
+      return 0;
+  }
+}
+
+std::string SocketAddress::String() const {
+  char buf[INET6_ADDRSTRLEN]{};
+  switch (Family()) {
+    case AF_INET:
+      ::inet_ntop(AF_INET,
+                  &reinterpret_cast<const sockaddr_in*>(&storage_)->sin_addr,
+                  buf, sizeof(buf));
+      return fmt::format("{}:{}", buf, Port());
+    case AF_INET6:
+      ::inet_ntop(
+          AF_INET6,
+          &reinterpret_cast<const sockaddr_in6*>(&storage_)->sin6_addr, buf,
+          sizeof(buf));
+      return fmt::format("[{}]:{}", buf, Port());
+    case AF_UNIX: {
+      auto un = reinterpret_cast<const sockaddr_un*>(&storage_);
+      size_t n = length_ - offsetof(struct sockaddr_un, sun_path);
+      if (n == 0) {
+        return "unix:";
+      }
+      // Abstract names start with '\0' and are shown with '@'.
+      if (un->sun_path[0] == '\0') {
+        return fmt::format("unix:@{}",
+                           std::string_view(un->sun_path + 1, n - 1));
+      }
+      return fmt::format(
+          "unix:{}", std::string_view(un->sun_path, strnlen(un->sun_path, n)));
+    }
+    default:
+      return "unknown";
+  }
+}
+
+}  // namespace pedrolib
@@ -1,18 +1,73 @@
 #include "pedrolib/timestamp.h"
-#include <fmt/chrono.h>
 #include <sys/time.h>
+#include <algorithm>
+#include <cstring>
+#include <ctime>
+#include <limits>
 
 namespace pedrolib {
 
+namespace {
+
+struct FormatCache {
+  int64_t secs{std::numeric_limits<int64_t>::min()};
+  char prefix[Timestamp::kFormatSize - 6];
+};
+
+char* FormatDigits(char* p, int64_t value, int width) noexcept {
+  for (int i = width - 1; i >= 0; --i) {
+    p[i] = static_cast<char>('0' + value % 10);
+    value /= 10;
+  }
+  return p + width;
+}
+
+}  // namespace
+
 Timestamp Timestamp::Now() {
   struct timeval tv {};
   gettimeofday(&tv, nullptr);
 
   return Timestamp{tv.tv_sec * Duration::kMicroseconds + tv.tv_usec};
 }
+
+char* Timestamp::FormatTo(char* buf) const noexcept {
+  thread_local FormatCache cache;
+
+  int64_t secs = usecs / Duration::kMicroseconds;
+  int64_t us = usecs % Duration::kMicroseconds;
+  if (us < 0) {
+    secs -= 1;
+    us += Duration::kMicroseconds;
+  }
+
+  if (secs != cache.secs) {
+    time_t t = secs;
+    struct tm tm {};
+    localtime_r(&t, &tm);
+
+    char* p = cache.prefix;
+    p = FormatDigits(p, std::clamp(tm.tm_year + 1900, 0, 9999), 4);
+    *p++ = '-';
+    p = FormatDigits(p, tm.tm_mon + 1, 2);
+    *p++ = '-';
+    p = FormatDigits(p, tm.tm_mday, 2);
+    *p++ = '-';
+    p = FormatDigits(p, tm.tm_hour, 2);
+    *p++ = ':';
+    p = FormatDigits(p, tm.tm_min, 2);
+    *p++ = ':';
+    p = FormatDigits(p, tm.tm_sec, 2);
+    *p = ':';
+    cache.secs = secs;
+  }
+
+  std::memcpy(buf, cache.prefix, sizeof(cache.prefix));
+  return FormatDigits(buf + sizeof(cache.prefix), us, 6);
+}
+
 std::string Timestamp::String() const noexcept {
-  time_t t = usecs / Duration::kMicroseconds;
-  uint64_t us = usecs % Duration::kMicroseconds;
-  return fmt::format("{:%Y-%m-%d-%H:%M:%S}:{:06}", fmt::localtime(t), us);
+  char buf[kFormatSize];
+  return std::string(buf, FormatTo(buf));
 }
-}  // namespace pedrolib
\ No newline at end of file
+}  // namespace pedrolib
@@ -0,0 +1,17 @@
+#ifndef PEDROLIB_TEST_CHECK_H
+#define PEDROLIB_TEST_CHECK_H
+
+#include <cstdlib>
+#include <iostream>
+
+// Aborts the test binary with the failing expression and its location.
+#define CHECK(cond)                                                  \
+  do {                                                               \
+    if (!(cond)) {                                                   \
+      std::cerr << __FILE__ << ":" << __LINE__ << ": " << #cond      \
+                << " failed" << std::endl;                           \
+      std::exit(1);                                                  \
+    }                                                                \
+  } while (0)
+
+#endif  // PEDROLIB_TEST_CHECK_H
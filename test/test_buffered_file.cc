@@ -0,0 +1,151 @@
+#include <pedrolib/executor/thread_pool_executor.h>
+#include <pedrolib/file/buffered_file.h>
+#include "check.h"
+#include <fcntl.h>
+#include <unistd.h>
+#include <iostream>
+#include <random>
+#include <string>
+
+using pedrolib::BufferedFileReader;
+using pedrolib::BufferedFileWriter;
+using pedrolib::Executor;
+using pedrolib::File;
+using pedrolib::ThreadPoolExecutor;
+
+File Temp() {
+  char name[] = "/tmp/pedrolib-test-XXXXXX";
+  File file(::mkstemp(name));
+  ::unlink(name);
+  return file;
+}
+
+std::string ReadBack(File& file) {
+  std::string content(file.GetSize(), '\0');
+  CHECK(file.Pread(0, content.data(), content.size()) ==
+        static_cast<ssize_t>(content.size()));
+  return content;
+}
+
+// Small buffers and odd write sizes so every path runs: partial fills,
+// full flushes in the background and writes larger than a buffer.
+void TestWriter(Executor* executor) {
+  BufferedFileWriter::Options options;
+  options.buffer_size = 4096;
+  options.windows = 3;
+
+  std::mt19937 rng(5);
+  std::string expected(100, 'h');
+  File file = Temp();
+  CHECK(file.Write(expected.data(), expected.size()) == 100);
+  {
+    BufferedFileWriter writer(&file, executor, 100, options);
+    for (int i = 0; i < 500; ++i) {
+      size_t n = i % 50 == 0 ? 10000 + rng() % 5000 : rng() % 700;
+      std::string chunk(n, static_cast<char>('a' + i % 26));
+      CHECK(writer.Write(chunk).Empty());
+      expected += chunk;
+    }
+    CHECK(writer.Offset() == expected.size());
+    CHECK(writer.Flush().Empty());
+    CHECK(ReadBack(file) == expected);
+    CHECK(writer.Write("tail").Empty());
+  }
+  CHECK(ReadBack(file) == expected + "tail");
+}
+
+void TestReader(Executor* executor) {
+  BufferedFileReader::Options options;
+  options.buffer_size = 4096;
+  options.windows = 3;
+
+  std::mt19937 rng(6);
+  std::string content(50000, '\0');
+  for (auto& c : content) {
+    c = static_cast<char>(rng());
+  }
+  File file = Temp();
+  CHECK(file.Write(content.data(), content.size()) ==
+        static_cast<ssize_t>(content.size()));
+
+  BufferedFileReader views(&file, executor, 0, options);
+  std::string read;
+  while (auto view = views.Next()) {
+    CHECK(view->size() <= 4096);
+    read += *view;
+  }
+  CHECK(views.Eof());
+  CHECK(views.GetError().Empty());
+  CHECK(read == content);
+
+  // Copies of uneven sizes, starting past the first window.
+  BufferedFileReader copies(&file, executor, 5000, options);
+  read.clear();
+  char buf[3000];
+  ssize_t r;
+  while ((r = copies.Read(buf, rng() % sizeof(buf) + 1)) > 0) {
+    read.append(buf, r);
+  }
+  CHECK(r == 0);
+  CHECK(read == content.substr(5000));
+
+  // An exact multiple of the buffer size ends on an empty read.
+  File even = Temp();
+  CHECK(even.Write(content.data(), 8192) == 8192);
+  BufferedFileReader exact(&even, executor, 0, options);
+  CHECK(exact.Next()->size() == 4096);
+  CHECK(exact.Next()->size() == 4096);
+  CHECK(!exact.Next());
+  CHECK(exact.Eof());
+}
+
+void TestErrors(Executor* executor) {
+  int fds[2];
+  CHECK(::pipe2(fds, O_CLOEXEC) == 0);
+  File reader(fds[0]);
+  File writer(fds[1]);
+
+  // Pipes cannot be read or written at an offset.
+  BufferedFileReader pread(&reader, executor);
+  CHECK(!pread.Next());
+  CHECK(pread.GetError() == pedrolib::Error(ESPIPE));
+  CHECK(!pread.Eof());
+  char c;
+  CHECK(pread.Read(&c, 1) == -1);
+
+  BufferedFileWriter pwrite(&writer, executor);
+  std::string big(1 << 21, 'x');
+  CHECK(pwrite.Write(big) == pedrolib::Error(ESPIPE));
+  CHECK(pwrite.Flush() == pedrolib::Error(ESPIPE));
+}
+
+// Readers destroyed right after their windows complete, so the owner often
+// wakes and frees the windows while the io task is still finishing.
+void TestShortLived(Executor* executor) {
+  BufferedFileReader::Options options;
+  options.buffer_size = 4096;
+  options.windows = 4;
+
+  File file = Temp();
+  std::string content(10000, 's');
+  CHECK(file.Write(content.data(), content.size()) == 10000);
+  for (int i = 0; i < 200; ++i) {
+    BufferedFileReader reader(&file, executor, 0, options);
+    CHECK(reader.Next()->size() == 4096);
+  }
+}
+
+int main() {
+  ThreadPoolExecutor executor(2);
+  for (Executor* e : {static_cast<Executor*>(&executor),
+                      static_cast<Executor*>(nullptr)}) {
+    TestWriter(e);
+    TestReader(e);
+    TestErrors(e);
+    TestShortLived(e);
+  }
+  executor.Close();
+  executor.Join();
+  std::cout << "ok" << std::endl;
+  return 0;
+}
@@ -0,0 +1,118 @@
+#include <pedrolib/checksum/crc32c.h>
+#include <pedrolib/checksum/xxhash.h>
+#include <pedrolib/executor/thread_pool_executor.h>
+#include "check.h"
+#include <iostream>
+#include <random>
+#include <string>
+
+using pedrolib::ArrayBuffer;
+using pedrolib::Crc32cHasher;
+using pedrolib::ThreadPoolExecutor;
+using pedrolib::Xxh64Hasher;
+
+// Bit-at-a-time reference.
+uint32_t SlowCrc32c(const std::string_view& data) {
+  uint32_t crc = ~0u;
+  for (unsigned char c : data) {
+    crc ^= c;
+    for (int k = 0; k < 8; ++k) {
+      crc = crc & 1 ? (crc >> 1) ^ 0x82f63b78 : crc >> 1;
+    }
+  }
+  return ~crc;
+}
+
+std::string Random(size_t n, uint32_t seed) {
+  std::mt19937 rng(seed);
+  std::string data(n, '\0');
+  for (auto& c : data) {
+    c = static_cast<char>(rng());
+  }
+  return data;
+}
+
+void TestCrc32c() {
+  CHECK(pedrolib::Crc32c("123456789", 9) == 0xe3069283);
+  CHECK(pedrolib::Crc32c("", 0) == 0);
+
+  // Lengths and offsets cover the unaligned head and all three block paths.
+  std::mt19937 rng(7);
+  std::string data = Random(100000, 1);
+  for (int round = 0; round < 500; ++round) {
+    size_t offset = rng() % 64;
+    size_t length = round < 250 ? rng() % 1024 : rng() % (data.size() - 64);
+    std::string_view view(data.data() + offset, length);
+    uint32_t crc = pedrolib::Crc32c(view.data(), view.size());
+    CHECK(crc == SlowCrc32c(view));
+
+    size_t split = length == 0 ? 0 : rng() % length;
+    uint32_t a = pedrolib::Crc32c(view.data(), split);
+    uint32_t b = pedrolib::Crc32c(view.data() + split, length - split);
+    CHECK(pedrolib::Crc32c(view.data() + split, length - split, a) == crc);
+    CHECK(pedrolib::Crc32cCombine(a, b, length - split) == crc);
+
+    std::string_view parts[] = {view.substr(0, split), view.substr(split)};
+    CHECK(pedrolib::Crc32c(parts, 2) == crc);
+  }
+}
+
+void TestHashers() {
+  std::string data = Random(5000, 2);
+  ArrayBuffer buffer;
+  buffer.Append(data.data() + 1000, 3000);
+
+  Crc32cHasher crc;
+  crc.Update(data.data(), 1000);
+  crc.Update(&buffer);
+  crc.Combine(pedrolib::Crc32c(data.data() + 4000, 1000), 1000);
+  CHECK(crc.Value() == pedrolib::Crc32c(data.data(), data.size()));
+  CHECK(crc.Length() == data.size());
+  CHECK(buffer.ReadableBytes() == 3000);
+
+  // Uneven updates straddle the 32-byte stripe buffer.
+  for (uint64_t seed : {uint64_t{0}, uint64_t{42}}) {
+    Xxh64Hasher xxh(seed);
+    size_t offset = 0;
+    for (size_t step = 1; offset < data.size(); step = step * 3 % 97 + 1) {
+      size_t n = std::min(step, data.size() - offset);
+      xxh.Update(data.data() + offset, n);
+      offset += n;
+    }
+    CHECK(xxh.Value() == pedrolib::Xxh64(data.data(), data.size(), seed));
+    CHECK(xxh.Length() == data.size());
+  }
+}
+
+void TestXxHash() {
+  std::string big;
+  for (int i = 0; i < 1000; ++i) {
+    big += static_cast<char>(i * 7 + i / 3);
+  }
+  CHECK(pedrolib::Xxh64("", 0) == 0xef46db3751d8e999);
+  CHECK(pedrolib::Xxh64("123456789", 9) == 0x8cb841db40e6ae83);
+  CHECK(pedrolib::Xxh3("", 0) == 0x2d06800538d394c2);
+  CHECK(pedrolib::Xxh3("123456789", 9) == 0x72dcb18b67a17dff);
+  CHECK(pedrolib::Xxh3(big.data(), big.size()) == 0xcdcf7dd99d536816);
+  CHECK(pedrolib::Xxh3(big.data(), big.size(), 42) == 0xb5b72309318fc93c);
+}
+
+void TestParallel() {
+  ThreadPoolExecutor executor(4);
+  std::string data = Random((4 << 20) + 13, 3);
+  CHECK(pedrolib::Crc32c(&executor, data.data(), data.size()) ==
+        pedrolib::Crc32c(data.data(), data.size()));
+  CHECK(pedrolib::Crc32c(&executor, data.data(), 100) ==
+        pedrolib::Crc32c(data.data(), 100));
+  executor.Close();
+  executor.Join();
+}
+
+int main() {
+  TestCrc32c();
+  TestHashers();
+  TestXxHash();
+  TestParallel();
+  std::cout << "ok" << std::endl;
+  return 0;
+}
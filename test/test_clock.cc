@@ -0,0 +1,76 @@
+#include <pedrolib/clock.h>
+#include "check.h"
+#include <time.h>
+#include <atomic>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+using pedrolib::CoarseClock;
+using pedrolib::Duration;
+using pedrolib::MonotonicClock;
+using pedrolib::Timestamp;
+
+int64_t ClockGettime() {
+  struct timespec ts {};
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * Duration::kNanoseconds + ts.tv_nsec;
+}
+
+// Readers keep comparing the clock with CLOCK_MONOTONIC while the source is
+// switched and the TSC recalibrated underneath them.
+void TestSwitchSource() {
+  const int64_t kToleranceNsecs = 5 * 1000 * 1000;
+
+  std::atomic_bool stop{false};
+  std::vector<std::thread> readers;
+  for (int i = 0; i < 4; ++i) {
+    readers.emplace_back([&] {
+      while (!stop.load(std::memory_order_relaxed)) {
+        int64_t before = ClockGettime();
+        int64_t now = MonotonicClock::Nanoseconds();
+        int64_t after = ClockGettime();
+        CHECK(now >= before - kToleranceNsecs);
+        CHECK(now <= after + kToleranceNsecs);
+      }
+    });
+  }
+
+  for (int i = 0; i < 5; ++i) {
+    if (!MonotonicClock::SetSource(MonotonicClock::Source::kTsc)) {
+      CHECK(MonotonicClock::GetSource() ==
+            MonotonicClock::Source::kClockGettime);
+      break;
+    }
+    CHECK(MonotonicClock::GetSource() == MonotonicClock::Source::kTsc);
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    CHECK(MonotonicClock::SetSource(MonotonicClock::Source::kClockGettime));
+    CHECK(MonotonicClock::GetSource() ==
+          MonotonicClock::Source::kClockGettime);
+  }
+
+  stop = true;
+  for (auto& reader : readers) {
+    reader.join();
+  }
+}
+
+void TestCoarseClock() {
+  const Duration kTolerance = Duration::Milliseconds(20);
+
+  Timestamp wall = CoarseClock::Now();
+  Timestamp monotonic = CoarseClock::Monotonic();
+  CHECK(Timestamp::Now() - wall < kTolerance);
+  CHECK(MonotonicClock::Now() - monotonic < kTolerance);
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  CHECK(CoarseClock::Now() > wall);
+  CHECK(CoarseClock::Monotonic() > monotonic);
+}
+
+int main() {
+  TestSwitchSource();
+  TestCoarseClock();
+  std::cout << "ok" << std::endl;
+  return 0;
+}
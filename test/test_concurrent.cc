@@ -0,0 +1,132 @@
+#include <pedrolib/concurrent/barrier.h>
+#include <pedrolib/concurrent/latch.h>
+#include <pedrolib/concurrent/semaphore.h>
+#include "check.h"
+#include <iostream>
+#include <thread>
+#include <vector>
+
+using pedrolib::Barrier;
+using pedrolib::Duration;
+using pedrolib::Latch;
+using pedrolib::MonotonicClock;
+using pedrolib::Semaphore;
+
+void TestLatch() {
+  Latch latch(4);
+  std::atomic_int done{};
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 4; ++i) {
+    threads.emplace_back([&] {
+      done++;
+      latch.CountDown();
+    });
+  }
+  latch.Await();
+  CHECK(done == 4);
+  CHECK(latch.Count() == 0);
+  CHECK(latch.Await(Duration::Zero()));
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  Latch never(1);
+  auto start = MonotonicClock::Now();
+  CHECK(!never.Await(Duration::Milliseconds(50)));
+  CHECK(MonotonicClock::Now() - start >= Duration::Milliseconds(50));
+}
+
+void TestBarrier() {
+  const int kThreads = 4;
+  const int kPhases = 200;
+
+  int phases = 0;
+  std::atomic_int arrived{};
+  std::atomic_int completed_by{};
+  Barrier barrier(kThreads, [&] {
+    CHECK(arrived == kThreads * (phases + 1));
+    phases++;
+  });
+
+  std::vector<std::thread> threads;
+  for (int i = 0; i < kThreads; ++i) {
+    threads.emplace_back([&] {
+      for (int j = 0; j < kPhases; ++j) {
+        arrived++;
+        if (barrier.ArriveAndWait()) {
+          completed_by++;
+        }
+        CHECK(phases > j);
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  CHECK(phases == kPhases);
+  CHECK(completed_by == kPhases);
+}
+
+void TestSemaphore() {
+  Semaphore semaphore(2);
+  std::atomic_int inside{};
+  std::atomic_int peak{};
+
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 8; ++i) {
+    threads.emplace_back([&] {
+      for (int j = 0; j < 1000; ++j) {
+        semaphore.Acquire();
+        int n = ++inside;
+        int p = peak.load();
+        while (n > p && !peak.compare_exchange_weak(p, n)) {
+        }
+        --inside;
+        semaphore.Release();
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  CHECK(peak <= 2);
+  CHECK(semaphore.Available() == 2);
+
+  CHECK(semaphore.TryAcquire());
+  CHECK(semaphore.TryAcquire());
+  CHECK(!semaphore.TryAcquire());
+  CHECK(!semaphore.TryAcquire(Duration::Milliseconds(10)));
+  std::thread releaser([&] { semaphore.Release(); });
+  CHECK(semaphore.TryAcquire(Duration::Seconds(5)));
+  releaser.join();
+}
+
+// The primitive lives on the waiter's stack and is destroyed as soon as the
+// waiter returns, racing the releasing thread's wake-up.
+void TestDestroyAfterRelease() {
+  for (int i = 0; i < 2000; ++i) {
+    std::thread releaser;
+    {
+      Latch latch(1);
+      releaser = std::thread([&] { latch.CountDown(); });
+      latch.Await();
+    }
+    releaser.join();
+
+    {
+      Semaphore semaphore(0);
+      releaser = std::thread([&] { semaphore.Release(); });
+      semaphore.Acquire();
+    }
+    releaser.join();
+  }
+}
+
+int main() {
+  TestLatch();
+  TestBarrier();
+  TestSemaphore();
+  TestDestroyAfterRelease();
+  std::cout << "ok" << std::endl;
+  return 0;
+}
@@ -0,0 +1,250 @@
+#include <fcntl.h>
+#include <pedrolib/concurrent/latch.h>
+#include <pedrolib/event/event_loop.h>
+#include "check.h"
+#include <unistd.h>
+#include <atomic>
+#include <iostream>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+using pedrolib::Duration;
+using pedrolib::EventLoop;
+using pedrolib::EventLoopGroup;
+using pedrolib::File;
+using pedrolib::Latch;
+using pedrolib::Trigger;
+
+struct Pipe {
+  File reader;
+  File writer;
+
+  Pipe() {
+    int fds[2];
+    CHECK(::pipe2(fds, O_NONBLOCK | O_CLOEXEC) == 0);
+    reader = File(fds[0]);
+    writer = File(fds[1]);
+  }
+};
+
+void TestReadable() {
+  const int kMessages = 1000;
+
+  EventLoop loop;
+  Pipe pipe;
+  Latch latch(kMessages);
+  bool in_loop = true;
+  CHECK(loop.Register(pipe.reader, pedrolib::kReadable, Trigger::kEdge,
+                      [&](uint32_t events) {
+                        in_loop &= loop.InLoop();
+                        CHECK(events & pedrolib::kReadable);
+                        // Edge-triggered: drain until EAGAIN.
+                        char buf[64];
+                        ssize_t r;
+                        while ((r = pipe.reader.Read(buf, sizeof(buf))) > 0) {
+                          for (ssize_t i = 0; i < r; ++i) {
+                            latch.CountDown();
+                          }
+                        }
+                      })
+            .Empty());
+  CHECK(loop.Register(pipe.reader, pedrolib::kReadable, Trigger::kLevel,
+                      [](uint32_t) {}) == pedrolib::Error(EEXIST));
+
+  for (int i = 0; i < kMessages; ++i) {
+    CHECK(pipe.writer.Write("x", 1) == 1);
+  }
+  latch.Await();
+  CHECK(in_loop);
+  CHECK(loop.Unregister(pipe.reader).Empty());
+  CHECK(loop.Unregister(pipe.reader) == pedrolib::Error(ENOENT));
+}
+
+void TestTasksAndTimers() {
+  EventLoop loop;
+
+  std::vector<int> order;
+  Latch done(1);
+  loop.ScheduleAfter(Duration::Milliseconds(20), [&] {
+    order.push_back(2);
+    done.CountDown();
+  });
+  loop.ScheduleAfter(Duration::Milliseconds(5), [&] { order.push_back(1); });
+  uint64_t canceled = loop.ScheduleAfter(Duration::Milliseconds(10),
+                                         [&] { order.push_back(-1); });
+  loop.ScheduleCancel(canceled);
+  // EventLoop has a single queue; the priority overload falls back to it.
+  loop.Schedule([&] { order.push_back(0); }, pedrolib::Priority::kLow);
+  done.Await();
+  CHECK((order == std::vector<int>{0, 1, 2}));
+
+  std::atomic<int> ticks{0};
+  Latch ticked(3);
+  uint64_t id = loop.ScheduleEvery(Duration::Milliseconds(1),
+                                   Duration::Milliseconds(1), [&] {
+                                     if (++ticks <= 3) {
+                                       ticked.CountDown();
+                                     }
+                                   });
+  ticked.Await();
+  loop.ScheduleCancel(id);
+  // The cancel runs on the loop, so no tick starts after this task.
+  Latch flushed(1);
+  loop.Schedule([&] { flushed.CountDown(); });
+  flushed.Await();
+  int seen = ticks;
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  CHECK(ticks == seen);
+
+  // Tasks scheduled before Close still run.
+  std::atomic<int> ran{0};
+  for (int i = 0; i < 100; ++i) {
+    loop.Schedule([&] { ran++; });
+  }
+  loop.Close();
+  loop.Join();
+  CHECK(ran == 100);
+}
+
+void TestGroup() {
+  const size_t kPipes = 8;
+
+  EventLoopGroup group(2);
+  std::vector<Pipe> pipes(kPipes);
+  std::vector<EventLoop*> loops(kPipes);
+  Latch latch(kPipes);
+  std::atomic<int> wrong_loop{0};
+  for (size_t i = 0; i < kPipes; ++i) {
+    CHECK(group
+              .Register(pipes[i].reader, pedrolib::kReadable, Trigger::kLevel,
+                        [&, i](uint32_t) {
+                          char c;
+                          if (pipes[i].reader.Read(&c, 1) == 1) {
+                            wrong_loop += !loops[i]->InLoop();
+                            latch.CountDown();
+                          }
+                        },
+                        &loops[i])
+              .Empty());
+  }
+  CHECK(loops[0] != loops[1]);
+  CHECK(loops[0] == loops[2]);
+
+  for (auto& pipe : pipes) {
+    CHECK(pipe.writer.Write("x", 1) == 1);
+  }
+  latch.Await();
+  CHECK(wrong_loop == 0);
+  for (auto& pipe : pipes) {
+    CHECK(group.Unregister(pipe.reader).Empty());
+  }
+}
+
+// A throwing handler, timer or task is dropped and the loop keeps going.
+void TestThrowingCallbacks() {
+  EventLoop loop;
+  Pipe pipe;
+  CHECK(loop.Register(pipe.reader, pedrolib::kReadable, Trigger::kEdge,
+                      [&](uint32_t) {
+                        char c;
+                        while (pipe.reader.Read(&c, 1) > 0) {
+                        }
+                        throw std::runtime_error("handler");
+                      })
+            .Empty());
+  CHECK(pipe.writer.Write("x", 1) == 1);
+  loop.ScheduleAfter(Duration::Milliseconds(1),
+                     [] { throw std::runtime_error("timer"); });
+  loop.Schedule([] { throw 42; });
+
+  Latch survived(1);
+  loop.ScheduleAfter(Duration::Milliseconds(10), [&] { survived.CountDown(); });
+  CHECK(survived.Await(Duration::Seconds(5)));
+}
+
+// Two descriptors are ready in one batch. The first handler holds the loop
+// while another thread unregisters the second, whose handler must not run
+// once Unregister has returned.
+void TestUnregisterFromOtherThread() {
+  EventLoop loop;
+  Pipe pipes[2];
+  Latch ready(1);
+  Latch started(1);
+  Latch unregistered(1);
+  std::atomic<int> first{-1};
+  std::atomic<int> calls[2]{};
+
+  // Both are registered while the loop is busy, so its next wait returns
+  // them together.
+  loop.Schedule([&] { ready.Await(); });
+  for (int i = 0; i < 2; ++i) {
+    CHECK(pipes[i].writer.Write("x", 1) == 1);
+    CHECK(loop.Register(pipes[i].reader, pedrolib::kReadable, Trigger::kLevel,
+                        [&, i](uint32_t) {
+                          calls[i].fetch_add(1);
+                          char c;
+                          while (pipes[i].reader.Read(&c, 1) > 0) {
+                          }
+                          int expected = -1;
+                          if (first.compare_exchange_strong(expected, i)) {
+                            started.CountDown();
+                            unregistered.Await();
+                          }
+                        })
+              .Empty());
+  }
+  ready.CountDown();
+
+  CHECK(started.Await(Duration::Seconds(5)));
+  int other = 1 - first.load();
+  CHECK(loop.Unregister(pipes[other].reader).Empty());
+  unregistered.CountDown();
+
+  Latch synced(1);
+  loop.Schedule([&] { synced.CountDown(); });
+  CHECK(synced.Await(Duration::Seconds(5)));
+  CHECK(calls[other].load() == 0);
+
+  // Unregistered after the loop has stopped: freed by the destructor.
+  loop.Close();
+  loop.Join();
+  CHECK(loop.Unregister(pipes[first.load()].reader).Empty());
+}
+
+// A loop may be destroyed by its own task, timer or handler.
+void TestDestroyInLoop() {
+  for (int i = 0; i < 3; ++i) {
+    auto loop = new EventLoop;
+    Pipe pipe;
+    Latch done(1);
+    auto destroy = [&done, loop] {
+      delete loop;
+      done.CountDown();
+    };
+    if (i == 0) {
+      loop->Schedule(destroy);
+    } else if (i == 1) {
+      loop->ScheduleAfter(Duration::Milliseconds(1), destroy);
+    } else {
+      CHECK(loop->Register(pipe.reader, pedrolib::kReadable, Trigger::kLevel,
+                           [destroy](uint32_t) { destroy(); })
+                .Empty());
+      CHECK(pipe.writer.Write("x", 1) == 1);
+    }
+    CHECK(done.Await(Duration::Seconds(5)));
+  }
+  // Let the detached threads finish before the process exits.
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+}
+
+int main() {
+  TestReadable();
+  TestTasksAndTimers();
+  TestGroup();
+  TestThrowingCallbacks();
+  TestUnregisterFromOtherThread();
+  TestDestroyInLoop();
+  std::cout << "ok" << std::endl;
+  return 0;
+}
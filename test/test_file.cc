@@ -0,0 +1,173 @@
+#include <pedrolib/file/file.h>
+#include "check.h"
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <cerrno>
+#include <iostream>
+#include <string>
+#include <thread>
+
+using pedrolib::File;
+
+File Temp(int flags = 0) {
+  char name[] = "/tmp/pedrolib-test-XXXXXX";
+  File file(::mkostemp(name, flags));
+  ::unlink(name);
+  return file;
+}
+
+std::string Pattern(size_t n) {
+  std::string s(n, '\0');
+  for (size_t i = 0; i < n; ++i) {
+    s[i] = static_cast<char>('a' + i * 7 % 26);
+  }
+  return s;
+}
+
+std::string ReadBack(File& file) {
+  std::string content(file.GetSize(), '\0');
+  CHECK(file.Pread(0, content.data(), content.size()) ==
+        static_cast<ssize_t>(content.size()));
+  return content;
+}
+
+// Writes at most 700 bytes per call and fails every fourth call, so the
+// fallback path sees both short writes and errors after partial progress.
+class FlakyFile : public File {
+  int calls_{};
+
+ public:
+  explicit FlakyFile(File file) : File(std::move(file)) {}
+
+  [[nodiscard]] int Calls() const noexcept { return calls_; }
+
+  ssize_t Write(const void* buf, size_t n) noexcept override {
+    if (++calls_ % 4 == 0) {
+      errno = EIO;
+      return -1;
+    }
+    return File::Write(buf, std::min<size_t>(n, 700));
+  }
+};
+
+const std::string kSource = Pattern(300000);
+
+File Source() {
+  File source = Temp();
+  CHECK(source.Write(kSource.data(), kSource.size()) ==
+        static_cast<ssize_t>(kSource.size()));
+  return source;
+}
+
+// copy_file_range between two regular files.
+void TestFileToFile() {
+  File source = Source();
+  File target = Temp();
+  CHECK(source.TransferTo(target, 1000, 200000) == 200000);
+  CHECK(ReadBack(target) == kSource.substr(1000, 200000));
+
+  CHECK(source.TransferTo(target, kSource.size() - 10, 100) == 10);
+  CHECK(ReadBack(target) == kSource.substr(1000, 200000) +
+                                kSource.substr(kSource.size() - 10));
+}
+
+// sendfile into a pipe, then splice out of it.
+void TestPipes() {
+  File source = Source();
+  int fds[2];
+  CHECK(::pipe(fds) == 0);
+  File reader(fds[0]), writer(fds[1]);
+
+  std::string received;
+  std::thread consumer([&] {
+    File target = Temp();
+    size_t total = 0;
+    while (total < 150000) {
+      ssize_t w = reader.TransferTo(target, 0, 150000 - total);
+      CHECK(w > 0);
+      total += w;
+    }
+    received = ReadBack(target);
+  });
+  CHECK(source.TransferTo(writer, 5, 150000) == 150000);
+  consumer.join();
+  CHECK(received == kSource.substr(5, 150000));
+}
+
+// A socket has no direct kernel path to a file and cannot be rewound, so
+// its bytes go through the read/write fallback.
+void TestSocket() {
+  int fds[2];
+  CHECK(::socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == 0);
+  File in(fds[0]), out(fds[1]);
+  CHECK(out.Write(kSource.data(), 50000) == 50000);
+  out.Close();
+
+  File target = Temp();
+  size_t total = 0;
+  ssize_t w;
+  while ((w = in.TransferTo(target, 0, 60000)) > 0) {
+    total += w;
+  }
+  CHECK(total == 50000);
+  CHECK(ReadBack(target) == kSource.substr(0, 50000));
+}
+
+// No kernel method accepts an O_APPEND target, so the read/write fallback
+// runs. After every short or failed write the returned count must match
+// what reached the target, so resuming from it reproduces the source.
+void TestFallbackPartialWrites() {
+  File source = Source();
+  FlakyFile target(Temp(O_APPEND));
+
+  size_t offset = 0;
+  while (offset < kSource.size()) {
+    ssize_t w = source.TransferTo(target, offset, kSource.size() - offset);
+    if (w < 0) {
+      CHECK(errno == EIO);
+      continue;
+    }
+    CHECK(w > 0);
+    offset += w;
+    CHECK(target.GetSize() == static_cast<int64_t>(offset));
+  }
+  CHECK(target.Calls() > static_cast<int>(kSource.size() / 700));
+  CHECK(ReadBack(target) == kSource);
+}
+
+// From a socket, bytes a failed write leaves behind cannot be reread. Each
+// call still reports exactly what reached the target and stops at the
+// failure instead of reading on.
+void TestFallbackSocketSource() {
+  int fds[2];
+  CHECK(::socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == 0);
+  File in(fds[0]), out(fds[1]);
+  CHECK(out.Write(kSource.data(), 50000) == 50000);
+  out.Close();
+
+  FlakyFile target(Temp(O_APPEND));
+  int64_t total = 0;
+  for (;;) {
+    ssize_t w = in.TransferTo(target, 0, 60000);
+    if (w == 0) {
+      break;
+    }
+    if (w > 0) {
+      total += w;
+    }
+    CHECK(target.GetSize() == total);
+  }
+  CHECK(total > 0);
+  CHECK(total < 50000);
+}
+
+int main() {
+  TestFileToFile();
+  TestPipes();
+  TestSocket();
+  TestFallbackPartialWrites();
+  TestFallbackSocketSource();
+  std::cout << "ok" << std::endl;
+  return 0;
+}
@@ -0,0 +1,114 @@
+#include <pedrolib/metric/histogram.h>
+#include "check.h"
+#include <cmath>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+using pedrolib::Histogram;
+
+// Values below 2^bits have a bucket each.
+int SubBucketBits(const Histogram& histogram) {
+  int bits = 1;
+  while (histogram.BucketIndex((int64_t{1} << bits) + 1) ==
+         (size_t{1} << bits) + 1) {
+    ++bits;
+  }
+  return bits;
+}
+
+// BucketValue is the largest value of its bucket, so it and the value after
+// it must land on adjacent buckets.
+void TestBucketEdges() {
+  Histogram histogram(1 << 30, 2);
+  int bits = SubBucketBits(histogram);
+
+  size_t last = histogram.BucketIndex(1 << 30);
+  for (size_t i = 0; i < last; ++i) {
+    int64_t edge = Histogram::BucketValue(bits, i);
+    CHECK(histogram.BucketIndex(edge) == i);
+    CHECK(histogram.BucketIndex(edge + 1) == i + 1);
+  }
+}
+
+// Values recorded at both sides of every bucket edge from several threads
+// merge into one snapshot with exact counts and percentiles that sit on
+// bucket edges within the requested precision.
+void TestMergeAtEdges() {
+  const int kThreads = 4;
+
+  Histogram histogram(1 << 20, 2);
+  int bits = SubBucketBits(histogram);
+  size_t buckets = histogram.BucketIndex(1 << 20);
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kThreads; ++t) {
+    threads.emplace_back([&, t] {
+      for (size_t i = t; i < buckets; i += kThreads) {
+        int64_t edge = Histogram::BucketValue(bits, i);
+        histogram.Record(edge);
+        histogram.Record(edge + 1);
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  auto snapshot = histogram.Snapshot();
+  CHECK(snapshot.Count() == 2 * buckets);
+  CHECK(snapshot.Min() == 0);
+  CHECK(snapshot.Max() == Histogram::BucketValue(bits, buckets - 1) + 1);
+  CHECK(snapshot.Percentile(0) == 0);
+  CHECK(snapshot.Percentile(100) == snapshot.Max());
+
+  // Bucket 0 holds only 0 and bucket i the value after edge i-1 and edge i,
+  // so the (2i+1)-th smallest value is the edge of bucket i.
+  for (size_t i = 0; i < buckets; ++i) {
+    double percentile = 100.0 * (2 * i + 0.5) / snapshot.Count();
+    CHECK(snapshot.Percentile(percentile) ==
+          Histogram::BucketValue(bits, i));
+  }
+
+  for (double p : {50.0, 90.0, 99.0, 99.9}) {
+    int64_t value = snapshot.Percentile(p);
+    auto rank = static_cast<size_t>(std::ceil(p / 100 * snapshot.Count()));
+    int64_t exact = rank % 2 ? Histogram::BucketValue(bits, rank / 2)
+                             : Histogram::BucketValue(bits, rank / 2 - 1) + 1;
+    CHECK(value >= exact);
+    CHECK(value - exact <= exact / 100 + 1);
+  }
+}
+
+// A thread that exits leaves its shard behind for the next thread; its
+// counts stay in the snapshot and Reset clears every shard.
+void TestExitedShards() {
+  Histogram histogram;
+  for (int i = 0; i < 3; ++i) {
+    std::thread([&] {
+      for (int j = 1; j <= 100; ++j) {
+        histogram.Record(j);
+      }
+    }).join();
+  }
+
+  auto snapshot = histogram.Snapshot();
+  CHECK(snapshot.Count() == 300);
+  CHECK(snapshot.Min() == 1);
+  CHECK(snapshot.Max() == 100);
+  CHECK(snapshot.Mean() == 50.5);
+  CHECK(snapshot.Percentile(50) == 50);
+
+  histogram.Reset();
+  CHECK(histogram.Snapshot().Count() == 0);
+  histogram.Record(pedrolib::Duration::Milliseconds(3));
+  CHECK(histogram.Snapshot().Max() == 3000);
+}
+
+int main() {
+  TestBucketEdges();
+  TestMergeAtEdges();
+  TestExitedShards();
+  std::cout << "ok" << std::endl;
+  return 0;
+}
@@ -0,0 +1,286 @@
+#include <pedrolib/logger/async_sink.h>
+#include <pedrolib/logger/binary_sink.h>
+#include <pedrolib/logger/logger.h>
+#include "check.h"
+#include <unistd.h>
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using pedrolib::AsyncLogSink;
+using pedrolib::BinaryLogDecoder;
+using pedrolib::BinaryLogSink;
+using pedrolib::File;
+using pedrolib::Logger;
+
+struct Throwing {};
+
+template <>
+struct fmt::formatter<Throwing> : fmt::formatter<int> {
+  template <typename Context>
+  auto format(const Throwing&, Context& ctx) const -> decltype(ctx.out()) {
+    throw std::runtime_error("throwing formatter");
+  }
+};
+
+File Temp() {
+  char name[] = "/tmp/pedrolib-test-XXXXXX";
+  File file(::mkstemp(name));
+  ::unlink(name);
+  return file;
+}
+
+std::vector<std::string> ReadLines(File& file) {
+  std::string content(file.GetSize(), '\0');
+  CHECK(file.Pread(0, content.data(), content.size()) ==
+        static_cast<ssize_t>(content.size()));
+
+  std::vector<std::string> lines;
+  std::istringstream in(content);
+  for (std::string line; std::getline(in, line);) {
+    lines.push_back(line);
+  }
+  return lines;
+}
+
+// Records of one producer appear in order, and the name is copied so a
+// logger may go away before its records are written.
+void TestOrdering() {
+  const int kProducers = 4;
+  const int kRecords = 20000;
+
+  File file = Temp();
+  AsyncLogSink::Options options;
+  options.capacity = 256;
+  AsyncLogSink sink(File(::dup(file.Descriptor())), options);
+
+  std::vector<std::thread> producers;
+  for (int i = 0; i < kProducers; ++i) {
+    producers.emplace_back([&, i] {
+      for (int j = 0; j < kRecords; ++j) {
+        std::string name = "producer-" + std::to_string(i);
+        sink.Append(name, "INFO", "{} {}", i, j);
+        name.assign(name.size(), 'x');
+      }
+    });
+  }
+  for (auto& producer : producers) {
+    producer.join();
+  }
+  sink.Flush();
+
+  auto lines = ReadLines(file);
+  CHECK(lines.size() == kProducers * kRecords);
+  std::vector<int> next(kProducers);
+  for (const auto& line : lines) {
+    int i, j;
+    auto pos = line.find("[INFO] ");
+    CHECK(pos != std::string::npos);
+    CHECK(std::sscanf(line.c_str() + pos + 7, "%d %d", &i, &j) == 2);
+    CHECK(line.find("[producer-" + std::to_string(i) + "]") !=
+          std::string::npos);
+    CHECK(next[i]++ == j);
+  }
+}
+
+// The flusher is stuck on a full pipe, so the ring overflows. Every record
+// is either written or reported by the dropped-records warning.
+void TestOverflow() {
+  const int kRecords = 5000;
+
+  int fds[2];
+  CHECK(::pipe(fds) == 0);
+  File reader(fds[0]);
+
+  std::string content;
+  std::thread consumer;
+  {
+    AsyncLogSink::Options options;
+    options.capacity = 16;
+    options.overflow = AsyncLogSink::OverflowPolicy::kCount;
+    AsyncLogSink sink(File(fds[1]), options);
+    for (int i = 0; i < kRecords; ++i) {
+      sink.Append("overflow", "INFO", "{:0>200}", i);
+    }
+
+    consumer = std::thread([&] {
+      char buf[4096];
+      ssize_t r;
+      while ((r = reader.Read(buf, sizeof(buf))) > 0) {
+        content.append(buf, r);
+      }
+    });
+  }
+  // The sink closed the write end, so the consumer has read up to EOF.
+  consumer.join();
+
+  int written = 0;
+  uint64_t dropped = 0;
+  std::istringstream in(content);
+  for (std::string line; std::getline(in, line);) {
+    auto pos = line.find("log records dropped");
+    if (pos == std::string::npos) {
+      written++;
+      continue;
+    }
+    uint64_t n;
+    const char* count = line.c_str() + line.find("[WARN] ") + 7;
+    CHECK(std::sscanf(count, "%" SCNu64, &n) == 1);
+    dropped += n;
+  }
+  CHECK(dropped > 0);
+  CHECK(written + dropped == kRecords);
+}
+
+// Destroying the sink writes everything appended before.
+void TestFlushOnDestroy() {
+  File file = Temp();
+  {
+    AsyncLogSink sink(File(::dup(file.Descriptor())));
+    for (int i = 0; i < 1000; ++i) {
+      sink.Append("destroy", "WARN", "record {}", i);
+    }
+  }
+  auto lines = ReadLines(file);
+  CHECK(lines.size() == 1000);
+  CHECK(lines.back().find("[destroy] [WARN] record 999") != std::string::npos);
+}
+
+// Two runs append to one binary log, as a restarted process would, and the
+// decoder formats both. The second run reuses the name storage with other
+// content, which must not be confused with the first name.
+void TestBinaryRoundTrip() {
+  File log = Temp();
+  const char* sum = "{} + {} = {}";
+  std::string name = "first";
+  {
+    BinaryLogSink sink(File(::dup(log.Descriptor())));
+    sink.Append(name, "INFO", sum, 1, 2.5, 3.5);
+    sink.Append(name, "WARN", "{} {} {}", "str", std::string("string"), true);
+    name.assign("other");
+    sink.Append(name, "INFO", sum, -1, 0.5, -0.5);
+  }
+  {
+    BinaryLogSink sink(File(::dup(log.Descriptor())));
+    sink.Append(name, "ERROR", "second run {}", 7);
+  }
+
+  File text = Temp();
+  CHECK(::lseek(log.Descriptor(), 0, SEEK_SET) == 0);
+  BinaryLogDecoder decoder;
+  CHECK(decoder.Decode(&log, &text).Empty());
+
+  auto lines = ReadLines(text);
+  CHECK(lines.size() == 4);
+  const char* expected[] = {
+      "[first] [INFO] 1 + 2.5 = 3.5",
+      "[first] [WARN] str string true",
+      "[other] [INFO] -1 + 0.5 = -0.5",
+      "[other] [ERROR] second run 7",
+  };
+  for (size_t i = 0; i < lines.size(); ++i) {
+    CHECK(lines[i].size() > std::strlen(expected[i]));
+    CHECK(lines[i].compare(lines[i].size() - std::strlen(expected[i]),
+                           std::string::npos, expected[i]) == 0);
+  }
+}
+
+// Formats built at run time in one buffer are told apart by their text.
+void TestBinaryRuntimeFormat() {
+  File log = Temp();
+  {
+    BinaryLogSink sink(File(::dup(log.Descriptor())));
+    char fmt[32];
+    for (int i = 0; i < 3; ++i) {
+      std::snprintf(fmt, sizeof(fmt), "runtime %d", i);
+      sink.Append("runtime", "INFO", fmt);
+    }
+    std::snprintf(fmt, sizeof(fmt), "runtime {}");
+    sink.Append("runtime", "INFO", fmt, 3);
+  }
+
+  File text = Temp();
+  CHECK(::lseek(log.Descriptor(), 0, SEEK_SET) == 0);
+  BinaryLogDecoder decoder;
+  CHECK(decoder.Decode(&log, &text).Empty());
+
+  auto lines = ReadLines(text);
+  CHECK(lines.size() == 4);
+  for (size_t i = 0; i < lines.size(); ++i) {
+    auto expected = "[runtime] [INFO] runtime " + std::to_string(i);
+    CHECK(lines[i].size() > expected.size());
+    CHECK(lines[i].compare(lines[i].size() - expected.size(),
+                           std::string::npos, expected) == 0);
+  }
+}
+
+// A message that fails to format still fills its slot, so neither the
+// flusher nor Flush waits on it forever.
+void TestFormatFailure() {
+  File file = Temp();
+  {
+    AsyncLogSink::Options options;
+    options.capacity = 4;
+    AsyncLogSink sink(File(::dup(file.Descriptor())), options);
+    for (int i = 0; i < 8; ++i) {
+      sink.Append("format", "INFO", "{:d}", "not a number");
+      sink.Append("format", "INFO", "{}", Throwing{});
+      sink.Append("format", "INFO", "fine {}", i);
+    }
+    sink.Flush();
+  }
+
+  auto lines = ReadLines(file);
+  CHECK(lines.size() == 24);
+  CHECK(lines[0].find("{:d}>") != std::string::npos);
+  CHECK(lines[1].find("<throwing formatter: {}>") != std::string::npos);
+  CHECK(lines[23].find("fine 7") != std::string::npos);
+}
+
+// Sinks are swapped while another thread logs; every message lands in
+// exactly one of them.
+void TestSetSinkWhileLogging() {
+  File first = Temp();
+  File second = Temp();
+  constexpr int kMessages = 20000;
+  {
+    Logger logger("set-sink");
+    logger.SetLevel(Logger::Level::kInfo);
+    auto a = std::make_shared<AsyncLogSink>(File(::dup(first.Descriptor())));
+    auto b = std::make_shared<AsyncLogSink>(File(::dup(second.Descriptor())));
+    logger.SetSink(a);
+
+    std::thread producer([&] {
+      for (int i = 0; i < kMessages; ++i) {
+        logger.Info("message {}", i);
+      }
+    });
+    for (int i = 0; i < 1000; ++i) {
+      logger.SetSink(i % 2 == 0 ? b : a);
+    }
+    producer.join();
+    a->Flush();
+    b->Flush();
+  }
+
+  CHECK(ReadLines(first).size() + ReadLines(second).size() == kMessages);
+}
+
+int main() {
+  TestOrdering();
+  TestOverflow();
+  TestFlushOnDestroy();
+  TestFormatFailure();
+  TestSetSinkWhileLogging();
+  TestBinaryRoundTrip();
+  TestBinaryRuntimeFormat();
+  std::cout << "ok" << std::endl;
+  return 0;
+}
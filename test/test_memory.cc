@@ -0,0 +1,282 @@
+#include <pedrolib/memory/arena.h>
+#include <pedrolib/memory/epoch.h>
+#include <pedrolib/memory/hazard_pointer.h>
+#include "check.h"
+#include <cstring>
+#include <iostream>
+#include <optional>
+#include <thread>
+#include <utility>
+#include <vector>
+
+using pedrolib::Arena;
+using pedrolib::EpochDomain;
+using pedrolib::HazardPointer;
+using pedrolib::HazardPointerDomain;
+
+std::atomic_int live{};
+
+struct Node {
+  explicit Node(int value) : value(value) { live++; }
+  ~Node() { live--; }
+
+  int value;
+  Node* next{nullptr};
+};
+
+// A Treiber stack whose pop reclaims nodes through Reclaimer.
+template <typename Reclaimer>
+class Stack {
+  std::atomic<Node*> head_{nullptr};
+  Reclaimer& reclaimer_;
+
+ public:
+  explicit Stack(Reclaimer& reclaimer) : reclaimer_(reclaimer) {}
+
+  ~Stack() {
+    for (Node* n = head_.load(); n != nullptr;) {
+      delete std::exchange(n, n->next);
+    }
+  }
+
+  void Push(int value) {
+    auto node = new Node(value);
+    node->next = head_.load(std::memory_order_relaxed);
+    while (!head_.compare_exchange_weak(node->next, node,
+                                        std::memory_order_release)) {
+    }
+  }
+
+  bool Pop(int& value);
+};
+
+template <>
+bool Stack<EpochDomain>::Pop(int& value) {
+  EpochDomain::Guard guard(reclaimer_);
+  Node* node = head_.load(std::memory_order_acquire);
+  while (node != nullptr &&
+         !head_.compare_exchange_weak(node, node->next,
+                                      std::memory_order_acquire)) {
+  }
+  if (node == nullptr) {
+    return false;
+  }
+  value = node->value;
+  reclaimer_.Retire(node);
+  return true;
+}
+
+template <>
+bool Stack<HazardPointerDomain>::Pop(int& value) {
+  HazardPointer hp(reclaimer_);
+  Node* node;
+  for (;;) {
+    node = hp.Protect(head_);
+    if (node == nullptr) {
+      return false;
+    }
+    if (head_.compare_exchange_weak(node, node->next,
+                                    std::memory_order_acquire)) {
+      break;
+    }
+  }
+  hp.Reset();
+  value = node->value;
+  reclaimer_.Retire(node);
+  return true;
+}
+
+template <typename Reclaimer>
+void TestStack() {
+  const int kThreads = 4;
+  const int kItems = 20000;
+  {
+    Reclaimer reclaimer;
+    Stack<Reclaimer> stack(reclaimer);
+    std::atomic<int64_t> sum{};
+    std::vector<std::thread> threads;
+    for (int i = 0; i < kThreads; ++i) {
+      threads.emplace_back([&, i] {
+        int64_t local = 0;
+        for (int j = i; j < kItems; j += kThreads) {
+          stack.Push(j);
+          int value;
+          if (stack.Pop(value)) {
+            local += value;
+          }
+        }
+        int value;
+        while (stack.Pop(value)) {
+          local += value;
+        }
+        sum += local;
+      });
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+    CHECK(sum == int64_t{kItems} * (kItems - 1) / 2);
+    // Batched frees must have kept the garbage bounded.
+    CHECK(live < kItems / 2);
+  }
+  CHECK(live == 0);
+}
+
+void TestEpoch() {
+  EpochDomain domain;
+  auto node = new Node(1);
+  {
+    EpochDomain::Guard guard(domain);
+    uint64_t epoch = domain.Epoch();
+    domain.Retire(node);
+    // A pinned thread holds the epoch back.
+    std::thread other([&] {
+      for (int i = 0; i < 3; ++i) {
+        domain.TryAdvance();
+      }
+    });
+    other.join();
+    CHECK(domain.Epoch() <= epoch + 1);
+    CHECK(live == 1);
+  }
+  domain.Synchronize();
+  CHECK(live == 0);
+}
+
+void TestHazardPointer() {
+  HazardPointerDomain domain;
+  std::atomic<Node*> shared{new Node(1)};
+  {
+    HazardPointer hp(domain);
+    Node* node = hp.Protect(shared);
+    shared.store(nullptr);
+    domain.Retire(node);
+    domain.Reclaim();
+    CHECK(live == 1);
+    hp.Reset();
+    domain.Reclaim();
+    CHECK(live == 0);
+  }
+}
+
+// Constructed before the domain's per-thread records, so it is destroyed
+// after them when its thread exits.
+struct LateHazardPointer {
+  std::optional<HazardPointer> hp;
+};
+
+thread_local LateHazardPointer late_hazard_pointer;
+
+// Hazard pointers released from a thread_local destructor after the
+// thread's records are gone, while other threads adopt those records.
+void TestHazardPointerAtThreadExit() {
+  HazardPointerDomain domain;
+  std::atomic<Node*> shared{new Node(1)};
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 16; ++i) {
+    threads.emplace_back([&] {
+      auto& late = late_hazard_pointer;
+      late.hp.emplace(domain);
+      late.hp->Protect(shared);
+      HazardPointer hp(domain);
+      hp.Protect(shared);
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  domain.Retire(shared.exchange(nullptr));
+  domain.Reclaim();
+  CHECK(live == 0);
+}
+
+// Like LateHazardPointer, destroyed after the per-thread records; pins,
+// protects and retires from there.
+struct LateRetire {
+  EpochDomain* epoch{};
+  HazardPointerDomain* hazard{};
+
+  ~LateRetire() {
+    if (epoch != nullptr) {
+      EpochDomain::Guard guard(*epoch);
+      epoch->Retire(new Node(2));
+    }
+    if (hazard != nullptr) {
+      HazardPointer hp(*hazard);
+      hazard->Retire(new Node(3));
+    }
+  }
+};
+
+thread_local LateRetire late_retire;
+
+// Each thread uses a second domain last, so the late calls miss the record
+// cache as well as the records.
+void TestRetireAtThreadExit() {
+  EpochDomain epoch;
+  EpochDomain other_epoch;
+  HazardPointerDomain hazard;
+  HazardPointerDomain other_hazard;
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 16; ++i) {
+    threads.emplace_back([&] {
+      late_retire.epoch = &epoch;
+      late_retire.hazard = &hazard;
+      { EpochDomain::Guard guard(epoch); }
+      { EpochDomain::Guard guard(other_epoch); }
+      { HazardPointer hp(hazard); }
+      { HazardPointer hp(other_hazard); }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  epoch.Synchronize();
+  hazard.Reclaim();
+  CHECK(live == 0);
+}
+
+// Threads allocate concurrently; every block must be aligned, distinct and
+// fully writable.
+void TestArena() {
+  Arena arena(4096);
+  std::vector<std::vector<std::pair<char*, size_t>>> spans(4);
+  std::vector<std::thread> threads;
+  for (size_t t = 0; t < spans.size(); ++t) {
+    threads.emplace_back([&, t] {
+      for (size_t i = 0; i < 2000; ++i) {
+        size_t n = i % 100 == 0 ? 3000 : i % 200 + 1;
+        size_t align = size_t{8} << (i % 4);
+        auto p = static_cast<char*>(arena.Allocate(n, align));
+        CHECK(reinterpret_cast<uintptr_t>(p) % align == 0);
+        std::memset(p, static_cast<int>(t), n);
+        spans[t].emplace_back(p, n);
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  for (size_t t = 0; t < spans.size(); ++t) {
+    for (auto [p, n] : spans[t]) {
+      for (size_t i = 0; i < n; ++i) {
+        CHECK(p[i] == static_cast<char>(t));
+      }
+    }
+  }
+  CHECK(arena.MemoryUsage() >= 4 * 2000 * 8);
+}
+
+int main() {
+  TestArena();
+  TestEpoch();
+  TestHazardPointer();
+  TestHazardPointerAtThreadExit();
+  TestRetireAtThreadExit();
+  TestStack<EpochDomain>();
+  TestStack<HazardPointerDomain>();
+  std::cout << "ok" << std::endl;
+  return 0;
+}
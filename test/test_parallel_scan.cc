@@ -0,0 +1,132 @@
+#include <pedrolib/executor/thread_pool_executor.h>
+#include <pedrolib/file/parallel_scan.h>
+#include "check.h"
+#include <fcntl.h>
+#include <unistd.h>
+#include <algorithm>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <random>
+#include <string>
+
+using pedrolib::Executor;
+using pedrolib::File;
+using pedrolib::ScanChunk;
+using pedrolib::ScanOptions;
+using pedrolib::ThreadPoolExecutor;
+
+File Temp(const std::string& content) {
+  char name[] = "/tmp/pedrolib-test-XXXXXX";
+  File file(::mkstemp(name));
+  ::unlink(name);
+  CHECK(file.Write(content.data(), content.size()) ==
+        static_cast<ssize_t>(content.size()));
+  return file;
+}
+
+// Lines of random lengths, a few longer than the chunks, and no trailing
+// newline.
+std::string Lines() {
+  std::mt19937 rng(9);
+  std::string content;
+  for (int i = 0; i < 3000; ++i) {
+    size_t n = i % 500 == 0 ? 3000 : rng() % 80;
+    content += std::string(n, static_cast<char>('a' + i % 26));
+    content += '\n';
+  }
+  content += "last";
+  return content;
+}
+
+void TestRecords(Executor* executor, bool map) {
+  std::string content = Lines();
+  File file = Temp(content);
+  for (size_t chunk_size : {1, 7, 64, 1000, 4096, 1 << 20}) {
+    ScanOptions options;
+    options.chunk_size = chunk_size;
+    options.delimiter = '\n';
+    options.map = map;
+
+    std::mutex mu;
+    std::map<size_t, std::pair<uint64_t, std::string>> chunks;
+    auto error = pedrolib::ParallelScan(
+        file, executor, options, [&](const ScanChunk& chunk) {
+          std::lock_guard<std::mutex> lock(mu);
+          chunks[chunk.index] = {chunk.offset, std::string(chunk.data)};
+        });
+    CHECK(error.Empty());
+
+    // Whole records only, each in the chunk where it starts.
+    std::string joined;
+    for (auto& [index, chunk] : chunks) {
+      auto& [offset, data] = chunk;
+      CHECK(offset == joined.size());
+      CHECK(offset >= index * chunk_size);
+      CHECK(offset < (index + 1) * chunk_size);
+      CHECK(offset == 0 || content[offset - 1] == '\n');
+      CHECK(data.back() == '\n' || offset + data.size() == content.size());
+      joined += data;
+    }
+    CHECK(joined == content);
+
+    // Ordered reduce sees the chunks in file order.
+    size_t lines = 0;
+    uint64_t last = 0;
+    error = pedrolib::ParallelScan(
+        file, executor, options,
+        [](const ScanChunk& chunk) {
+          auto n = std::count(chunk.data.begin(), chunk.data.end(), '\n');
+          return std::make_pair(chunk.offset, static_cast<size_t>(n));
+        },
+        [&](std::pair<uint64_t, size_t> result) {
+          CHECK(result.first >= last);
+          last = result.first;
+          lines += result.second;
+        });
+    CHECK(error.Empty());
+    CHECK(lines == 3000);
+  }
+}
+
+void TestRaw(Executor* executor) {
+  std::string content = Lines();
+  File file = Temp(content);
+  std::string joined(content.size(), '\0');
+  auto error = pedrolib::ParallelScan(
+      file, executor, 1000, [&](const ScanChunk& chunk) {
+        CHECK(chunk.offset == chunk.index * 1000);
+        CHECK(chunk.data.size() == 1000 ||
+              chunk.offset + chunk.data.size() == content.size());
+        chunk.data.copy(joined.data() + chunk.offset, chunk.data.size());
+      });
+  CHECK(error.Empty());
+  CHECK(joined == content);
+
+  File empty = Temp("");
+  CHECK(pedrolib::ParallelScan(empty, executor, 1000, [](const ScanChunk&) {
+          CHECK(false);
+        }).Empty());
+
+  int fds[2];
+  CHECK(::pipe2(fds, O_CLOEXEC) == 0);
+  File reader(fds[0]);
+  File writer(fds[1]);
+  CHECK(!pedrolib::ParallelScan(reader, executor, 1000,
+                                [](const ScanChunk&) {})
+             .Empty());
+}
+
+int main() {
+  ThreadPoolExecutor executor(3);
+  for (Executor* e : {static_cast<Executor*>(&executor),
+                      static_cast<Executor*>(nullptr)}) {
+    TestRecords(e, false);
+    TestRecords(e, true);
+    TestRaw(e);
+  }
+  executor.Close();
+  executor.Join();
+  std::cout << "ok" << std::endl;
+  return 0;
+}
@@ -0,0 +1,120 @@
+#include <pedrolib/collection/blocking_queue.h>
+#include <pedrolib/collection/mpmc_queue.h>
+#include <pedrolib/collection/spsc_queue.h>
+#include "check.h"
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <vector>
+
+using pedrolib::BlockingQueue;
+using pedrolib::BoundedMPMCQueue;
+using pedrolib::Duration;
+using pedrolib::SPSCQueue;
+
+template <typename Queue>
+void TestSingleThread() {
+  Queue queue(5);
+  CHECK(queue.capacity() == 8);
+
+  for (int i = 0; i < 8; ++i) {
+    CHECK(queue.try_push(std::make_unique<int>(i)));
+  }
+  CHECK(!queue.try_push(std::make_unique<int>(8)));
+  CHECK(queue.size_approx() == 8);
+
+  std::unique_ptr<int> value;
+  CHECK(queue.try_pop(value) && *value == 0);
+
+  std::vector<std::unique_ptr<int>> out(8);
+  CHECK(queue.try_pop_n(out.begin(), 3) == 3);
+  CHECK(*out[0] == 1 && *out[2] == 3);
+
+  std::vector<std::unique_ptr<int>> in;
+  for (int i = 8; i < 14; ++i) {
+    in.push_back(std::make_unique<int>(i));
+  }
+  CHECK(queue.try_push_n(in.begin(), in.size()) == 4);
+  CHECK(queue.try_pop_n(out.begin(), 8) == 8);
+  for (int i = 0; i < 8; ++i) {
+    CHECK(*out[i] == i + 4);
+  }
+  CHECK(!queue.try_pop(value));
+  CHECK(queue.try_pop_n(out.begin(), 8) == 0);
+
+  // Leftovers are destroyed with the queue.
+  CHECK(queue.try_push(std::make_unique<int>(0)));
+}
+
+void TestMPMC() {
+  const int kThreads = 4;
+  const uint64_t kItems = 100000;
+
+  BlockingQueue<BoundedMPMCQueue<uint64_t>> queue(64);
+  std::atomic<uint64_t> sum{};
+  std::vector<std::thread> threads;
+  for (int i = 0; i < kThreads; ++i) {
+    threads.emplace_back([&, i] {
+      uint64_t batch[8];
+      for (uint64_t j = i; j < kItems; j += 2 * kThreads) {
+        if (j + kThreads < kItems) {
+          batch[0] = j;
+          batch[1] = j + kThreads;
+          queue.push_n(batch, 2);
+        } else {
+          queue.push(j);
+        }
+      }
+    });
+    threads.emplace_back([&] {
+      uint64_t batch[8];
+      uint64_t local = 0;
+      for (uint64_t n = 0; n < kItems / kThreads;) {
+        uint64_t want = std::min<uint64_t>(8, kItems / kThreads - n);
+        size_t k = queue.pop_n(batch, want);
+        for (size_t m = 0; m < k; ++m) {
+          local += batch[m];
+        }
+        n += k;
+      }
+      sum += local;
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  CHECK(sum == kItems * (kItems - 1) / 2);
+  CHECK(queue.size_approx() == 0);
+}
+
+void TestSPSC() {
+  const uint64_t kItems = 100000;
+
+  BlockingQueue<SPSCQueue<uint64_t>> queue(16);
+  std::thread producer([&] {
+    for (uint64_t i = 0; i < kItems; ++i) {
+      queue.push(i);
+    }
+  });
+  for (uint64_t i = 0; i < kItems; ++i) {
+    uint64_t value;
+    queue.pop(value);
+    CHECK(value == i);
+  }
+  producer.join();
+
+  uint64_t value;
+  CHECK(!queue.pop(value, Duration::Milliseconds(10)));
+  std::thread late([&] { queue.push(42); });
+  CHECK(queue.pop(value, Duration::Seconds(5)) && value == 42);
+  late.join();
+}
+
+int main() {
+  TestSingleThread<BoundedMPMCQueue<std::unique_ptr<int>>>();
+  TestSingleThread<SPSCQueue<std::unique_ptr<int>>>();
+  TestMPMC();
+  TestSPSC();
+  std::cout << "ok" << std::endl;
+  return 0;
+}
@@ -0,0 +1,99 @@
+#include <pedrolib/buffer/ring_buffer.h>
+#include "check.h"
+#include <fcntl.h>
+#include <unistd.h>
+#include <iostream>
+#include <random>
+#include <string>
+
+using pedrolib::File;
+using pedrolib::RingBuffer;
+
+// Pushes random-sized chunks through the buffer and checks the bytes come
+// out in order, wrapping many times and growing along the way.
+void TestStream() {
+  std::mt19937 rng(11);
+  RingBuffer buffer(1);
+  CHECK(buffer.Capacity() == static_cast<size_t>(::sysconf(_SC_PAGESIZE)));
+
+  std::string expected;
+  uint8_t next = 0;
+  char out[8192];
+  for (int round = 0; round < 10000; ++round) {
+    size_t n = rng() % (round < 5000 ? 1500 : 6000);
+    std::string chunk(n, '\0');
+    for (auto& c : chunk) {
+      c = static_cast<char>(next++);
+    }
+    buffer.Append(chunk.data(), n);
+    expected += chunk;
+
+    size_t m = buffer.Retrieve(out, rng() % sizeof(out));
+    CHECK(expected.compare(0, m, out, m) == 0);
+    expected.erase(0, m);
+    CHECK(buffer.ReadableBytes() == expected.size());
+    CHECK(std::string_view(buffer.ReadIndex(), buffer.ReadableBytes()) ==
+          expected);
+  }
+  CHECK(buffer.Capacity() > static_cast<size_t>(::sysconf(_SC_PAGESIZE)));
+}
+
+// A value written across the wrap point reads back as one span.
+void TestWrap() {
+  RingBuffer buffer(4096);
+  size_t capacity = buffer.Capacity();
+  std::string filler(capacity - 2, 'f');
+  buffer.Append(filler.data(), filler.size());
+  buffer.Retrieve(filler.size() - 1);
+
+  pedrolib::AppendInt(&buffer, uint32_t{0xdeadbeef});
+  buffer.Retrieve(1);
+  uint32_t value = 0;
+  CHECK(pedrolib::RetrieveInt(&buffer, &value));
+  CHECK(value == 0xdeadbeef);
+  CHECK(buffer.Capacity() == capacity);
+
+  buffer.Append("skip", 4);
+  RingBuffer moved(std::move(buffer));
+  CHECK(moved.ReadableBytes() == 4);
+  CHECK(std::string_view(moved.ReadIndex(), 4) == "skip");
+}
+
+void TestFile() {
+  int fds[2];
+  CHECK(::pipe2(fds, O_CLOEXEC) == 0);
+  File reader(fds[0]);
+  File writer(fds[1]);
+
+  RingBuffer buffer;
+  std::string data(buffer.Capacity() - 100, 'a');
+  buffer.Append(data.data(), data.size());
+  buffer.Retrieve(data.size() - 10);
+
+  // The writable span now crosses the wrap point.
+  std::string message = "hello, mirrored world: " + std::string(500, 'b');
+  CHECK(writer.Write(message.data(), message.size()) ==
+        static_cast<ssize_t>(message.size()));
+  CHECK(buffer.Append(&reader) == static_cast<ssize_t>(message.size()));
+  buffer.Retrieve(10);
+  CHECK(std::string_view(buffer.ReadIndex(), buffer.ReadableBytes()) ==
+        message);
+
+  CHECK(buffer.Retrieve(&writer) == static_cast<ssize_t>(message.size()));
+  CHECK(buffer.ReadableBytes() == 0);
+
+  RingBuffer copy;
+  CHECK(copy.Append(&reader) == static_cast<ssize_t>(message.size()));
+  RingBuffer target;
+  copy.Retrieve(&target);
+  CHECK(std::string_view(target.ReadIndex(), target.ReadableBytes()) ==
+        message);
+}
+
+int main() {
+  TestStream();
+  TestWrap();
+  TestFile();
+  std::cout << "ok" << std::endl;
+  return 0;
+}
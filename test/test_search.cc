@@ -0,0 +1,116 @@
+#include <pedrolib/buffer/record_reader.h>
+#include <pedrolib/buffer/search.h>
+#include "check.h"
+#include <unistd.h>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+using pedrolib::File;
+using pedrolib::RecordReader;
+using pedrolib::SearchIsa;
+
+// Compares every kernel set against std::string on random buffers, at all
+// alignments and lengths around the vector widths.
+void TestKernels() {
+  std::mt19937 rng(42);
+  std::string data(512, '\0');
+  for (SearchIsa isa : {SearchIsa::kScalar, SearchIsa::kSse2,
+                        SearchIsa::kAvx2}) {
+    if (!pedrolib::SetSearchIsa(isa)) {
+      continue;
+    }
+    for (int round = 0; round < 2000; ++round) {
+      // A small alphabet, so matches are neither everywhere nor absent.
+      for (auto& c : data) {
+        c = static_cast<char>('a' + rng() % 24);
+      }
+      size_t offset = rng() % 64;
+      size_t length = rng() % (data.size() - offset);
+      std::string_view view(data.data() + offset, length);
+      const char* begin = view.data();
+      const char* end = begin + view.size();
+
+      auto expect = [&](size_t pos) {
+        return pos == std::string_view::npos ? end : begin + pos;
+      };
+      CHECK(pedrolib::FindByte(begin, end, 'x') == expect(view.find('x')));
+      CHECK(pedrolib::FindAnyOf(begin, end, "xyw") ==
+            expect(view.find_first_of("xyw")));
+      CHECK(pedrolib::FindPair(begin, end, 'a', 'b') ==
+            expect(view.find("ab")));
+    }
+    CHECK(pedrolib::FindByte(data.data(), data.data(), 'a') == data.data());
+  }
+}
+
+File Temp(const std::string& content) {
+  char name[] = "/tmp/pedrolib-test-XXXXXX";
+  File file(::mkstemp(name));
+  ::unlink(name);
+  CHECK(file.Write(content.data(), content.size()) ==
+        static_cast<ssize_t>(content.size()));
+  file.Seek(0, File::Whence::kSeekSet);
+  return file;
+}
+
+std::vector<std::string> ReadAll(RecordReader& reader) {
+  std::vector<std::string> records;
+  while (auto record = reader.Next()) {
+    records.emplace_back(*record);
+  }
+  CHECK(reader.GetError().Empty());
+  CHECK(reader.Eof());
+  return records;
+}
+
+void TestRecordReader() {
+  // A tiny read size makes records span many refills.
+  RecordReader::Options options;
+  options.read_size = 7;
+
+  File lines = Temp("first\r\nsecond\n\nfourth line is longer\nlast");
+  RecordReader reader(&lines, options);
+  CHECK((ReadAll(reader) == std::vector<std::string>{
+             "first", "second", "", "fourth line is longer", "last"}));
+
+  options.delimiter = "||";
+  File pairs = Temp("a|b||cc||||d|");
+  RecordReader pair_reader(&pairs, options);
+  CHECK((ReadAll(pair_reader) ==
+         std::vector<std::string>{"a|b", "cc", "", "d|"}));
+
+  options.delimiter = "<END>";
+  File tags = Temp("x<EN<END>y<END>");
+  RecordReader tag_reader(&tags, options);
+  CHECK((ReadAll(tag_reader) == std::vector<std::string>{"x<EN", "y"}));
+
+  options.delimiter = "\n";
+  options.max_record = 16;
+  File big = Temp("small\n" + std::string(100, 'z') + "\nafter\n");
+  RecordReader big_reader(&big, options);
+  CHECK(*big_reader.Next() == "small");
+  CHECK(!big_reader.Next());
+  CHECK(big_reader.GetError() == pedrolib::Error(EMSGSIZE));
+  // The oversized record is skipped through its delimiter.
+  CHECK((ReadAll(big_reader) == std::vector<std::string>{"after"}));
+
+  options.delimiter = "<END>";
+  File big_tags = Temp(std::string(100, 'z') + "<END>after<END>" +
+                       std::string(100, 'z'));
+  RecordReader big_tag_reader(&big_tags, options);
+  CHECK(!big_tag_reader.Next());
+  CHECK(big_tag_reader.GetError() == pedrolib::Error(EMSGSIZE));
+  CHECK(*big_tag_reader.Next() == "after");
+  CHECK(!big_tag_reader.Next());
+  CHECK(big_tag_reader.GetError() == pedrolib::Error(EMSGSIZE));
+  CHECK(ReadAll(big_tag_reader).empty());
+}
+
+int main() {
+  TestKernels();
+  TestRecordReader();
+  std::cout << "ok" << std::endl;
+  return 0;
+}
@@ -0,0 +1,160 @@
+#include <pedrolib/executor/keyed_executor.h>
+#include <pedrolib/executor/serial_executor.h>
+#include <pedrolib/executor/thread_pool_executor.h>
+#include "check.h"
+#include <atomic>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+using pedrolib::Duration;
+using pedrolib::KeyedExecutor;
+using pedrolib::SerialExecutor;
+using pedrolib::ThreadPoolExecutor;
+
+void TestSerialExecutor() {
+  const int kProducers = 4;
+  const int kTasks = 10000;
+
+  ThreadPoolExecutor pool(4);
+  SerialExecutor strand(&pool);
+
+  // Plain ints: the strand must provide both ordering and exclusion.
+  int running = 0;
+  int overlaps = 0;
+  std::vector<int> last(kProducers, -1);
+  int out_of_order = 0;
+
+  std::vector<std::thread> producers;
+  for (int p = 0; p < kProducers; ++p) {
+    producers.emplace_back([&, p] {
+      for (int i = 0; i < kTasks; ++i) {
+        strand.Schedule([&, p, i] {
+          if (running++ != 0) {
+            overlaps++;
+          }
+          if (last[p] + 1 != i) {
+            out_of_order++;
+          }
+          last[p] = i;
+          running--;
+        });
+      }
+    });
+  }
+  for (auto& producer : producers) {
+    producer.join();
+  }
+  strand.Join();
+
+  CHECK(overlaps == 0);
+  CHECK(out_of_order == 0);
+  for (int p = 0; p < kProducers; ++p) {
+    CHECK(last[p] == kTasks - 1);
+  }
+}
+
+// A batch keeps its order relative to tasks scheduled around it.
+void TestSerialBatch() {
+  const int kBatches = 100;
+  const int kBatchSize = 10;
+
+  ThreadPoolExecutor pool(4);
+  SerialExecutor strand(&pool);
+  std::vector<int> order;
+  int next = 0;
+  for (int b = 0; b < kBatches; ++b) {
+    std::vector<pedrolib::Callback> batch;
+    for (int i = 0; i < kBatchSize; ++i) {
+      batch.emplace_back([&, n = next++] { order.push_back(n); });
+    }
+    strand.ScheduleBatch(batch.data(), batch.size());
+    strand.Schedule([&, n = next++] { order.push_back(n); });
+  }
+  strand.ScheduleBatch(nullptr, 0);
+  strand.Join();
+
+  CHECK(order.size() == static_cast<size_t>(next));
+  for (int i = 0; i < next; ++i) {
+    CHECK(order[i] == i);
+  }
+}
+
+void TestKeyedExecutor() {
+  const int kKeys = 16;
+  const int kTasks = 1000;
+
+  ThreadPoolExecutor pool(4);
+  std::vector<std::vector<int>> seen(kKeys);
+  {
+    KeyedExecutor<int> keyed(&pool);
+    for (int i = 0; i < kTasks; ++i) {
+      for (int key = 0; key < kKeys; ++key) {
+        keyed.Schedule(key, [&, key, i] { seen[key].push_back(i); });
+      }
+    }
+    keyed.Join();
+  }
+
+  for (auto& values : seen) {
+    CHECK(values.size() == kTasks);
+    for (int i = 0; i < kTasks; ++i) {
+      CHECK(values[i] == i);
+    }
+  }
+}
+
+// Timers run on the parent; once the strand is destroyed they neither
+// reach it nor keep firing.
+void TestTimersOutliveStrand() {
+  ThreadPoolExecutor pool(2);
+  std::atomic_int ticks{};
+  std::atomic_int fired{};
+  {
+    SerialExecutor strand(&pool);
+    strand.ScheduleEvery(Duration::Zero(), Duration::Milliseconds(1),
+                         [&] { ticks++; });
+    strand.ScheduleAfter(Duration::Milliseconds(30), [&] { fired++; });
+    uint64_t canceled = strand.ScheduleEvery(
+        Duration::Zero(), Duration::Milliseconds(1), [&] { fired++; });
+    strand.ScheduleCancel(canceled);
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  int seen = ticks;
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  CHECK(ticks == seen);
+  CHECK(fired <= 1);
+
+  // A parent that reports no workers still gets a strand.
+  KeyedExecutor<int> keyed(&pool, 0);
+  std::atomic_int ran{};
+  keyed.Schedule(1, [&] { ran++; });
+  keyed.Join();
+  CHECK(ran == 1);
+}
+
+// Destroying a KeyedExecutor destroys its strands, which stops their
+// periodic timers.
+void TestKeyedExecutorDestroysStrands() {
+  ThreadPoolExecutor pool(2);
+  std::atomic_int ticks{};
+  {
+    KeyedExecutor<int> keyed(&pool, 2);
+    keyed.Strand(1).ScheduleEvery(Duration::Zero(), Duration::Milliseconds(1),
+                                  [&] { ticks++; });
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  int seen = ticks;
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  CHECK(ticks == seen);
+}
+
+int main() {
+  TestSerialExecutor();
+  TestSerialBatch();
+  TestKeyedExecutor();
+  TestTimersOutliveStrand();
+  TestKeyedExecutorDestroysStrands();
+  std::cout << "ok" << std::endl;
+  return 0;
+}
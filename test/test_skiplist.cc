@@ -0,0 +1,157 @@
+#include <pedrolib/collection/concurrent_skiplist.h>
+#include "check.h"
+#include <algorithm>
+#include <atomic>
+#include <iostream>
+#include <random>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+using pedrolib::ConcurrentSkipListMap;
+using pedrolib::ConcurrentSkipListSet;
+
+// Compares every query against std::set.
+void TestSet() {
+  ConcurrentSkipListSet<uint64_t> set;
+  std::set<uint64_t> expected;
+  CHECK(set.empty());
+  CHECK(set.lower_bound(1) == set.end());
+
+  std::mt19937_64 rng(3);
+  for (int i = 0; i < 20000; ++i) {
+    uint64_t key = rng() % 50000 * 2;
+    CHECK(set.insert(key).second == expected.insert(key).second);
+  }
+  CHECK(set.size() == expected.size());
+  CHECK(std::equal(set.begin(), set.end(), expected.begin(), expected.end()));
+
+  for (int i = 0; i < 20000; ++i) {
+    uint64_t key = rng() % 100002;
+    auto lower = expected.lower_bound(key);
+    auto upper = expected.upper_bound(key);
+    auto it = set.lower_bound(key);
+    CHECK(lower == expected.end() ? it == set.end() : *it == *lower);
+    it = set.upper_bound(key);
+    CHECK(upper == expected.end() ? it == set.end() : *it == *upper);
+    CHECK(set.contains(key) == expected.count(key));
+    CHECK((set.find(key) != set.end()) == expected.count(key));
+  }
+}
+
+void TestMap() {
+  ConcurrentSkipListMap<std::string, std::string> map;
+  CHECK(map.insert("b", "2").second);
+  CHECK(map.insert({"a", "1"}).second);
+  CHECK(map.emplace("c", std::string(100, '3')).second);
+  auto [it, inserted] = map.insert("b", "other");
+  CHECK(!inserted);
+  CHECK(it->second == "2");
+  CHECK(!map.emplace("a", "other").second);
+
+  std::string keys;
+  for (auto& [key, value] : map) {
+    keys += key;
+  }
+  CHECK(keys == "abc");
+  CHECK(map.find("c")->second.size() == 100);
+  CHECK(map.size() == 3);
+}
+
+// Writers insert overlapping ranges while a reader scans; every scan must
+// be sorted and the final contents exact.
+void TestConcurrent() {
+  ConcurrentSkipListMap<uint64_t, uint64_t> map;
+  constexpr uint64_t kKeys = 40000;
+  std::atomic<int> writing{4};
+  std::atomic<int> wins{0};
+
+  std::thread reader([&] {
+    while (writing.load() > 0) {
+      uint64_t last = 0;
+      size_t n = 0;
+      for (auto it = map.lower_bound(kKeys / 2); it != map.end(); ++it) {
+        CHECK(n++ == 0 || it->first > last);
+        CHECK(it->second == it->first * 3);
+        last = it->first;
+      }
+    }
+  });
+  std::vector<std::thread> writers;
+  for (uint64_t t = 0; t < 4; ++t) {
+    writers.emplace_back([&, t] {
+      std::mt19937_64 rng(t);
+      std::vector<uint64_t> keys;
+      // Each key is inserted by two of the writers.
+      for (uint64_t k = 0; k < kKeys; ++k) {
+        if (k % 4 == t || k % 4 == (t + 1) % 4) {
+          keys.push_back(k);
+        }
+      }
+      std::shuffle(keys.begin(), keys.end(), rng);
+      for (uint64_t k : keys) {
+        auto [it, inserted] = map.insert(k, k * 3);
+        CHECK(it->first == k);
+        wins += inserted;
+      }
+      writing--;
+    });
+  }
+  for (auto& writer : writers) {
+    writer.join();
+  }
+  reader.join();
+
+  CHECK(wins == static_cast<int>(kKeys));
+  CHECK(map.size() == kKeys);
+  uint64_t expected = 0;
+  for (auto& [key, value] : map) {
+    CHECK(key == expected++);
+  }
+  CHECK(expected == kKeys);
+}
+
+// Yields on every comparison so that writers interleave inside their
+// searches even on a single core.
+struct YieldingLess {
+  bool operator()(uint64_t x, uint64_t y) const {
+    std::this_thread::yield();
+    return x < y;
+  }
+};
+
+// Fresh lists start at height one, so concurrent inserts keep raising it
+// while others are between their search and their links. Every level,
+// not just the bottom one, must stay sorted.
+void TestGrowingHeight() {
+  constexpr int kRounds = 200;
+  constexpr uint64_t kKeys = 400;
+  constexpr int kWriters = 4;
+
+  for (int round = 0; round < kRounds; ++round) {
+    ConcurrentSkipListSet<uint64_t, YieldingLess> set;
+    std::vector<std::thread> writers;
+    for (int t = 0; t < kWriters; ++t) {
+      writers.emplace_back([&, t] {
+        std::mt19937_64 rng(round * kWriters + t);
+        for (uint64_t k = t; k < kKeys; k += kWriters) {
+          set.insert(rng() % (kKeys * 4));
+        }
+      });
+    }
+    for (auto& writer : writers) {
+      writer.join();
+    }
+    CHECK(set.well_formed());
+  }
+}
+
+int main() {
+  TestSet();
+  TestMap();
+  TestConcurrent();
+  TestGrowingHeight();
+  std::cout << "ok" << std::endl;
+  return 0;
+}
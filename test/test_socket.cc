@@ -0,0 +1,160 @@
+#include <pedrolib/buffer/array_buffer.h>
+#include <pedrolib/net/socket.h>
+#include "check.h"
+#include <poll.h>
+#include <unistd.h>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using pedrolib::ArrayBuffer;
+using pedrolib::Socket;
+using pedrolib::SocketAddress;
+
+bool Wait(const Socket& socket, short events) {
+  struct pollfd pfd {
+    .fd = socket.Descriptor(), .events = events, .revents = 0,
+  };
+  return ::poll(&pfd, 1, 5000) == 1;
+}
+
+// Connects a client to listener and returns both ends.
+std::pair<Socket, Socket> Connect(Socket& listener) {
+  SocketAddress address = *listener.LocalAddress();
+  Socket client = Socket::Create(address.Family(), Socket::Type::kStream);
+  CHECK(client.Valid());
+  pedrolib::Error err = client.Connect(address);
+  CHECK(err.Empty() || err == pedrolib::Error(EINPROGRESS));
+  CHECK(Wait(client, POLLOUT));
+  CHECK(client.ConnectResult().Empty());
+
+  CHECK(Wait(listener, POLLIN));
+  SocketAddress peer;
+  Socket server = listener.Accept(&peer);
+  CHECK(server.Valid());
+  CHECK(peer.Port() == client.LocalAddress()->Port());
+  return {std::move(client), std::move(server)};
+}
+
+void TestTcp() {
+  Socket listener = Socket::CreateListener(SocketAddress::Loopback(),
+                                           Socket::Type::kStream);
+  CHECK(listener.Valid());
+  CHECK(listener.LocalAddress()->Port() != 0);
+  auto [client, server] = Connect(listener);
+  CHECK(client.SetNoDelay(true).Empty());
+
+  // ArrayBuffer works on sockets through the File interface.
+  ArrayBuffer out;
+  std::string message(4000, 'x');
+  out.Append(message.data(), message.size());
+  while (out.ReadableBytes() > 0) {
+    CHECK(out.Retrieve(&client) > 0);
+  }
+  ArrayBuffer in;
+  while (in.ReadableBytes() < message.size()) {
+    CHECK(Wait(server, POLLIN));
+    CHECK(in.Append(&server) > 0);
+  }
+  CHECK(std::string(in.ReadIndex(), in.ReadableBytes()) == message);
+
+  CHECK(client.ShutdownWrite().Empty());
+  CHECK(Wait(server, POLLIN));
+  char c;
+  CHECK(server.Read(&c, 1) == 0);
+
+  // Nothing left to accept.
+  CHECK(!listener.Accept().Valid());
+  CHECK(errno == EAGAIN);
+}
+
+void TestUdpBatch() {
+  const size_t kMessages = 16;
+
+  Socket receiver = Socket::CreateListener(SocketAddress::Loopback(),
+                                           Socket::Type::kDatagram);
+  Socket sender = Socket::CreateListener(SocketAddress::Loopback(),
+                                         Socket::Type::kDatagram);
+  CHECK(receiver.Valid() && sender.Valid());
+  SocketAddress to = *receiver.LocalAddress();
+
+  std::vector<std::string> payloads;
+  std::vector<Socket::Datagram> outgoing(kMessages);
+  for (size_t i = 0; i < kMessages; ++i) {
+    payloads.push_back("message " + std::to_string(i));
+  }
+  for (size_t i = 0; i < kMessages; ++i) {
+    outgoing[i] = {payloads[i].data(), payloads[i].size(), &to};
+  }
+  CHECK(sender.SendBatch(outgoing.data(), outgoing.size()) ==
+        static_cast<int>(kMessages));
+
+  std::vector<std::string> buffers(kMessages, std::string(64, '\0'));
+  std::vector<SocketAddress> from(kMessages);
+  std::vector<Socket::Datagram> incoming(kMessages);
+  for (size_t i = 0; i < kMessages; ++i) {
+    incoming[i] = {buffers[i].data(), buffers[i].size(), &from[i]};
+  }
+  size_t received = 0;
+  while (received < kMessages) {
+    CHECK(Wait(receiver, POLLIN));
+    int r = receiver.ReceiveBatch(incoming.data() + received,
+                                  kMessages - received);
+    CHECK(r > 0);
+    received += r;
+  }
+  for (size_t i = 0; i < kMessages; ++i) {
+    CHECK(buffers[i].substr(0, incoming[i].size) == payloads[i]);
+    CHECK(from[i].Port() == sender.LocalAddress()->Port());
+  }
+}
+
+void TestUnix() {
+  // An abstract name, so nothing is left behind on the filesystem.
+  std::string name = std::string(1, '\0') + "pedrolib-test-" +
+                     std::to_string(::getpid());
+  SocketAddress address = SocketAddress::Unix(name);
+  CHECK(address.String() == "unix:@" + name.substr(1));
+
+  Socket listener = Socket::CreateListener(address, Socket::Type::kStream);
+  CHECK(listener.Valid());
+  auto [client, server] = Connect(listener);
+  CHECK(client.Write("ping", 4) == 4);
+  CHECK(Wait(server, POLLIN));
+  char buf[4];
+  CHECK(server.Read(buf, sizeof(buf)) == 4);
+  CHECK(std::string(buf, 4) == "ping");
+}
+
+void TestZeroCopy() {
+  Socket listener = Socket::CreateListener(SocketAddress::Loopback(),
+                                           Socket::Type::kStream);
+  auto [client, server] = Connect(listener);
+  if (!client.EnableZeroCopy().Empty()) {
+    std::cout << "zero copy unsupported, skipped" << std::endl;
+    return;
+  }
+
+  std::string payload(1 << 16, 'z');
+  uint32_t id = 0;
+  CHECK(client.SendZeroCopy(payload.data(), payload.size(), &id) > 0);
+  CHECK(id == 0);
+
+  // Loopback completes the send once the receiver has the data.
+  std::vector<char> buf(payload.size());
+  while (!client.ZeroCopyCompleted(id)) {
+    server.Read(buf.data(), buf.size());
+    Wait(client, 0);
+    client.ReapZeroCopy();
+  }
+  CHECK(client.ReapZeroCopy().completed == 1);
+}
+
+int main() {
+  TestTcp();
+  TestUdpBatch();
+  TestUnix();
+  TestZeroCopy();
+  std::cout << "ok" << std::endl;
+  return 0;
+}
@@ -0,0 +1,135 @@
+#include <pedrolib/concurrent/mcs_spinlock.h>
+#include <pedrolib/concurrent/rw_spinlock.h>
+#include <pedrolib/concurrent/spinlock.h>
+#include <pedrolib/concurrent/ticket_spinlock.h>
+#include "check.h"
+#include <atomic>
+#include <iostream>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
+#include <vector>
+
+using pedrolib::MCSSpinLock;
+using pedrolib::RWSpinLock;
+using pedrolib::SpinLock;
+using pedrolib::TicketSpinLock;
+
+const int kThreads = 8;
+const int kIterations = 5000;
+
+// Runs body on kThreads threads at once.
+template <typename Body>
+void Contend(Body&& body) {
+  std::atomic_int ready{};
+  std::vector<std::thread> threads;
+  for (int i = 0; i < kThreads; ++i) {
+    threads.emplace_back([&, i] {
+      ready++;
+      while (ready.load() < kThreads) {
+        std::this_thread::yield();
+      }
+      body(i);
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+}
+
+// A plain counter updated in several steps exposes any overlap between two
+// holders, and the flag catches it directly.
+struct Protected {
+  std::atomic_bool inside{false};
+  int64_t counter{};
+
+  void Update() {
+    CHECK(!inside.exchange(true, std::memory_order_relaxed));
+    int64_t x = counter;
+    std::atomic_signal_fence(std::memory_order_seq_cst);
+    counter = x + 1;
+    inside.store(false, std::memory_order_relaxed);
+  }
+};
+
+template <typename Lock>
+void TestExclusive() {
+  Lock lock;
+  Protected data;
+  Contend([&](int i) {
+    for (int j = 0; j < kIterations; ++j) {
+      if (j % 4 == i % 4 && lock.try_lock()) {
+        data.Update();
+        lock.unlock();
+        continue;
+      }
+      std::lock_guard<Lock> guard(lock);
+      data.Update();
+    }
+  });
+  CHECK(data.counter == kThreads * kIterations);
+
+  CHECK(lock.try_lock());
+  CHECK(!lock.try_lock());
+  lock.unlock();
+}
+
+void TestMCS() {
+  MCSSpinLock lock;
+  Protected data;
+  Contend([&](int i) {
+    MCSSpinLock::Node node;
+    for (int j = 0; j < kIterations; ++j) {
+      if (j % 4 == i % 4 && lock.try_lock(&node)) {
+        data.Update();
+        lock.unlock(&node);
+        continue;
+      }
+      MCSSpinLock::Guard guard(lock);
+      data.Update();
+    }
+  });
+  CHECK(data.counter == kThreads * kIterations);
+}
+
+// Writers exclude everyone; readers only exclude writers and may share the
+// lock with each other.
+void TestReaderWriter() {
+  RWSpinLock lock;
+  std::atomic_int readers{};
+  Protected data;
+  Contend([&](int i) {
+    for (int j = 0; j < kIterations; ++j) {
+      if (i < 2 && j % 8 == 0) {
+        std::lock_guard<RWSpinLock> guard(lock);
+        CHECK(readers.load() == 0);
+        data.Update();
+        continue;
+      }
+
+      std::shared_lock<RWSpinLock> guard(lock);
+      ++readers;
+      CHECK(!data.inside.load());
+      --readers;
+    }
+  });
+  CHECK(data.counter == 2 * (kIterations / 8));
+
+  CHECK(lock.try_lock_shared());
+  CHECK(lock.try_lock_shared());
+  CHECK(!lock.try_lock());
+  lock.unlock_shared();
+  lock.unlock_shared();
+  CHECK(lock.try_lock());
+  CHECK(!lock.try_lock_shared());
+  lock.unlock();
+}
+
+int main() {
+  TestExclusive<SpinLock>();
+  TestExclusive<TicketSpinLock>();
+  TestMCS();
+  TestReaderWriter();
+  std::cout << "ok" << std::endl;
+  return 0;
+}
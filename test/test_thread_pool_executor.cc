@@ -1,23 +1,350 @@
+#include <pedrolib/concurrent/latch.h>
 #include <pedrolib/executor/thread_pool_executor.h>
+#include "check.h"
 #include <chrono>
 #include <iostream>
+#include <thread>
+#include <vector>
 
 using namespace std::chrono_literals;
+using pedrolib::Duration;
+using pedrolib::BlockingScope;
+using pedrolib::Latch;
+using pedrolib::Priority;
 using pedrolib::ThreadPoolExecutor;
 
-int main() {
+void TestScheduleEvery() {
   ThreadPoolExecutor executor(3);
 
   std::atomic_int counter{};
   uint64_t id;
-  id = executor.ScheduleEvery(0s, 1s, [&] {
+  id = executor.ScheduleEvery(0s, 100ms, [&] {
     std::cout << "hello world" << std::endl;
     if (counter++ == 3) {
       executor.ScheduleCancel(id);
-      executor.ScheduleAfter(2s, [&] { executor.Close(); });
+      executor.ScheduleAfter(200ms, [&] { executor.Close(); });
     }
   });
 
   executor.Join();
+  CHECK(counter == 4);
+}
+
+// A fired one-shot task frees its slot for the next timer. The stale id
+// still names the same slot but an older generation, so canceling it must
+// leave the new timer alone.
+void TestCancelReusedSlot() {
+  ThreadPoolExecutor executor(2);
+
+  Latch fired(1);
+  uint64_t stale = executor.ScheduleAfter(Duration::Zero(),
+                                          [&] { fired.CountDown(); });
+  fired.Await();
+  std::this_thread::sleep_for(10ms);
+
+  Latch reused(1);
+  uint64_t id = executor.ScheduleAfter(Duration::Milliseconds(20),
+                                       [&] { reused.CountDown(); });
+  CHECK(static_cast<uint32_t>(id) == static_cast<uint32_t>(stale));
+  CHECK(id != stale);
+  executor.ScheduleCancel(stale);
+  CHECK(reused.Await(Duration::Seconds(5)));
+
+  // Canceling a pending timer drops it, and canceling twice is harmless.
+  std::atomic_int runs{};
+  id = executor.ScheduleAfter(Duration::Milliseconds(50), [&] { runs++; });
+  executor.ScheduleCancel(id);
+  executor.ScheduleCancel(id);
+
+  // A periodic task canceled from its own callback stops after that run.
+  Latch periodic(1);
+  std::atomic_int ticks{};
+  std::atomic<uint64_t> every{};
+  every = executor.ScheduleEvery(Duration::Milliseconds(10),
+                                 Duration::Milliseconds(1),
+                                 [&] {
+                                   if (++ticks == 5) {
+                                     executor.ScheduleCancel(every);
+                                     periodic.CountDown();
+                                   }
+                                 });
+  periodic.Await();
+  std::this_thread::sleep_for(100ms);
+  CHECK(runs == 0);
+  CHECK(ticks == 5);
+}
+
+// Blocks the only worker of a fixed single-thread pool, queues the tasks
+// from fill and releases the worker. Returns the lane of every dispatch.
+template <typename Fill>
+std::vector<Priority> Dispatch(ThreadPoolExecutor& executor, size_t n,
+                               Fill&& fill) {
+  Latch started(1);
+  Latch gate(1);
+  executor.Schedule([&] {
+    started.CountDown();
+    gate.Await();
+  });
+  started.Await();
+
+  std::vector<Priority> order;
+  Latch done(n);
+  fill([&](Priority priority) {
+    executor.Schedule(
+        [&, priority] {
+          order.push_back(priority);
+          done.CountDown();
+        },
+        priority);
+  });
+  gate.CountDown();
+  done.Await();
+  CHECK(order.size() == n);
+  return order;
+}
+
+// While every lane is backlogged, each round of 16 + 4 + 1 dispatches gives
+// the lanes exactly their default weights.
+void TestLaneOrdering() {
+  const int kRounds = 10;
+
+  ThreadPoolExecutor executor(1);
+  auto order = Dispatch(executor, 21 * kRounds, [&](auto&& schedule) {
+    for (int i = 0; i < 16 * kRounds; ++i) {
+      schedule(Priority::kHigh);
+    }
+    for (int i = 0; i < 4 * kRounds; ++i) {
+      schedule(Priority::kNormal);
+    }
+    for (int i = 0; i < kRounds; ++i) {
+      schedule(Priority::kLow);
+    }
+  });
+
+  for (int round = 0; round < kRounds; ++round) {
+    int counts[3]{};
+    for (int i = 0; i < 21; ++i) {
+      counts[static_cast<int>(order[round * 21 + i])]++;
+    }
+    CHECK(counts[0] == 16);
+    CHECK(counts[1] == 4);
+    CHECK(counts[2] == 1);
+  }
+
+  auto high = executor.Stats(Priority::kHigh);
+  CHECK(high.weight == 16);
+  CHECK(high.scheduled == 16 * kRounds);
+  CHECK(high.executed == 16 * kRounds);
+  CHECK(high.pending == 0);
+  CHECK(high.queue_wait.Count() == 16 * kRounds);
+  // The blocking task went to the normal lane.
+  CHECK(executor.Stats(Priority::kNormal).executed == 4 * kRounds + 1);
+  CHECK(executor.Stats(Priority::kLow).executed == kRounds);
+}
+
+// A deep high lane with a large weight still lets a low task through once
+// per round of weights, and a lane that drains lets the others take its
+// share.
+void TestLaneStarvation() {
+  const int kHigh = 2000;
+  const int kLow = 10;
+  const uint32_t kWeight = 100;
+
+  ThreadPoolExecutor executor(1);
+  executor.SetPriorityWeight(Priority::kHigh, kWeight);
+  executor.SetPriorityWeight(Priority::kNormal, 0);
+  CHECK(executor.Stats(Priority::kHigh).weight == kWeight);
+  CHECK(executor.Stats(Priority::kNormal).weight == 1);
+
+  auto order = Dispatch(executor, kHigh + kLow, [&](auto&& schedule) {
+    for (int i = 0; i < kHigh; ++i) {
+      schedule(Priority::kHigh);
+    }
+    for (int i = 0; i < kLow; ++i) {
+      schedule(Priority::kLow);
+    }
+  });
+
+  size_t last = 0;
+  int lows = 0;
+  for (size_t i = 0; i < order.size(); ++i) {
+    if (order[i] == Priority::kLow) {
+      CHECK(i - last <= kWeight + 1);
+      last = i;
+      lows++;
+    }
+  }
+  CHECK(lows == kLow);
+  // Every low task ran long before the high backlog drained.
+  CHECK(last < (kWeight + 1) * kLow);
+}
+
+// Polls until the pool has the given number of workers.
+bool WaitForSize(ThreadPoolExecutor& executor, size_t size) {
+  for (int i = 0; i < 5000; ++i) {
+    if (executor.Size() == size) {
+      return true;
+    }
+    std::this_thread::sleep_for(1ms);
+  }
+  return false;
+}
+
+// Tasks that wait longer than max_queue_delay add workers up to
+// max_threads, and the extra workers retire after keep_alive.
+void TestElastic() {
+  const int kTasks = 8;
+
+  ThreadPoolExecutor::Options options;
+  options.min_threads = 1;
+  options.max_threads = 4;
+  options.keep_alive = Duration::Milliseconds(20);
+  options.max_queue_delay = Duration::Milliseconds(1);
+  ThreadPoolExecutor executor(options);
+  CHECK(executor.Size() == 1);
+
+  Latch started(4);
+  Latch gate(1);
+  Latch done(kTasks);
+  for (int i = 0; i < kTasks; ++i) {
+    executor.Schedule([&] {
+      started.CountDown();
+      gate.Await();
+      done.CountDown();
+    });
+    std::this_thread::sleep_for(3ms);
+  }
+  CHECK(started.Await(Duration::Seconds(5)));
+  CHECK(executor.Size() == 4);
+
+  gate.CountDown();
+  done.Await();
+  CHECK(WaitForSize(executor, 1));
+}
+
+// Nested scopes mark the worker once, so one replacement is spawned and
+// the pool shrinks back once the scopes end.
+void TestBlockingScope() {
+  {
+    // Outside a pool it does nothing.
+    BlockingScope outer;
+    BlockingScope inner;
+  }
+
+  ThreadPoolExecutor::Options options;
+  options.min_threads = 2;
+  options.max_threads = 4;
+  options.keep_alive = Duration::Milliseconds(20);
+  ThreadPoolExecutor executor(options);
+
+  Latch blocked(1);
+  Latch gate(1);
+  Latch done(1);
+  executor.Schedule([&] {
+    {
+      BlockingScope outer;
+      BlockingScope inner;
+      {
+        BlockingScope innermost;
+      }
+      blocked.CountDown();
+      gate.Await();
+    }
+    done.CountDown();
+  });
+  blocked.Await();
+  CHECK(executor.Size() == 3);
+
+  gate.CountDown();
+  done.Await();
+  CHECK(WaitForSize(executor, 2));
+}
+
+// Workers retire while the pool shuts down; Join must not lose track of
+// them or join a thread twice.
+void TestCloseWhileRetiring() {
+  const int kTasks = 2000;
+
+  for (int round = 0; round < 5; ++round) {
+    ThreadPoolExecutor::Options options;
+    options.min_threads = 1;
+    options.max_threads = 16;
+    options.keep_alive = Duration::Milliseconds(1);
+    ThreadPoolExecutor executor(options);
+
+    std::atomic_int runs{};
+    for (int i = 0; i < kTasks; ++i) {
+      executor.Schedule([&, i] {
+        if (i % 64 == 0) {
+          std::this_thread::sleep_for(1ms);
+        }
+        runs++;
+      });
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(round));
+    executor.Close();
+    executor.Join();
+    CHECK(executor.Size() == 0);
+    CHECK(runs <= kTasks);
+  }
+}
+
+// A batch lands in the requested lane and runs every callback once. A batch
+// smaller than the idle pool wakes one worker per callback.
+void TestScheduleBatch() {
+  const int kTasks = 1000;
+
+  ThreadPoolExecutor executor(4);
+  executor.ScheduleBatch(nullptr, 0, Priority::kHigh);
+  CHECK(executor.Stats(Priority::kHigh).scheduled == 0);
+
+  std::vector<std::atomic_int> runs(kTasks);
+  Latch done(kTasks);
+  std::vector<pedrolib::Callback> callbacks;
+  for (int i = 0; i < kTasks; ++i) {
+    callbacks.emplace_back([&, i] {
+      runs[i]++;
+      done.CountDown();
+    });
+  }
+  executor.ScheduleBatch(callbacks.data(), callbacks.size(), Priority::kLow);
+  for (auto& callback : callbacks) {
+    CHECK(!callback);
+  }
+  done.Await();
+  for (auto& n : runs) {
+    CHECK(n == 1);
+  }
+  auto low = executor.Stats(Priority::kLow);
+  CHECK(low.scheduled == kTasks);
+  CHECK(low.executed == kTasks);
+  CHECK(executor.Stats(Priority::kNormal).scheduled == 0);
+
+  // Each task waits for the other, so both must run at once.
+  std::this_thread::sleep_for(10ms);
+  Latch both(2);
+  Latch rendezvous(1);
+  pedrolib::Callback pair[2];
+  for (auto& callback : pair) {
+    callback = [&] {
+      both.CountDown();
+      both.Await();
+      rendezvous.CountDown();
+    };
+  }
+  executor.ScheduleBatch(pair, 2);
+  CHECK(rendezvous.Await(Duration::Seconds(5)));
+  CHECK(executor.Stats(Priority::kNormal).executed == 2);
+}
+
+int main() {
+  TestScheduleEvery();
+  TestCancelReusedSlot();
+  TestLaneOrdering();
+  TestLaneStarvation();
+  TestScheduleBatch();
+  TestElastic();
+  TestBlockingScope();
+  TestCloseWhileRetiring();
   return 0;
-}
\ No newline at end of file
+}
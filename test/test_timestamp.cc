@@ -0,0 +1,90 @@
+#include <pedrolib/timestamp.h>
+#include "check.h"
+#include <fmt/chrono.h>
+#include <cstdlib>
+#include <ctime>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using pedrolib::Duration;
+using pedrolib::Timestamp;
+
+// The formatting String() used before FormatTo cached the date per second.
+std::string Reference(const Timestamp& ts) {
+  time_t t = ts.usecs / Duration::kMicroseconds;
+  int64_t us = ts.usecs % Duration::kMicroseconds;
+  return fmt::format("{:%Y-%m-%d-%H:%M:%S}:{:06}", fmt::localtime(t), us);
+}
+
+std::string Format(const Timestamp& ts) {
+  char buf[Timestamp::kFormatSize];
+  return std::string(buf, ts.FormatTo(buf));
+}
+
+void Expect(const Timestamp& ts) {
+  std::string expected = Reference(ts);
+  CHECK(Format(ts) == expected);
+  CHECK(ts.String() == expected);
+  CHECK(fmt::format("{}", ts) == expected);
+}
+
+// Steps forward and backward across second, minute, day and DST boundaries
+// so the per-thread cache is both reused and invalidated.
+void TestFormatTo() {
+  const int64_t kSecond = Duration::kMicroseconds;
+  const int64_t kStarts[] = {
+      0,
+      1700000000 * kSecond,
+      1710054000 * kSecond,  // 2024-03-10, a DST change in America/New_York
+      1735689599 * kSecond,  // the last second of 2024 in UTC
+  };
+
+  for (int64_t start : kStarts) {
+    for (int64_t offset = -3 * kSecond; offset <= 3 * kSecond;
+         offset += 250000 - 1) {
+      if (start + offset >= 0) {
+        Expect(Timestamp{start + offset});
+      }
+    }
+    for (int64_t offset = 3 * kSecond; offset >= -3 * kSecond;
+         offset -= 333333) {
+      if (start + offset >= 0) {
+        Expect(Timestamp{start + offset});
+      }
+    }
+    Expect(Timestamp{start + 7200 * kSecond});
+    Expect(Timestamp{start});
+  }
+
+  Timestamp now = Timestamp::Now();
+  Expect(now);
+  Expect(now + Duration::Seconds(86400));
+  Expect(now);
+}
+
+// Threads keep their own caches, each on a different second.
+void TestThreads() {
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 4; ++i) {
+    threads.emplace_back([i] {
+      int64_t base = (1600000000 + i * 100000) * Duration::kMicroseconds;
+      for (int j = 0; j < 20000; ++j) {
+        Expect(Timestamp{base + j * 1000 * (j % 3 == 0 ? 1000 : 1)});
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+}
+
+int main() {
+  setenv("TZ", "America/New_York", 1);
+  tzset();
+  TestFormatTo();
+  TestThreads();
+  std::cout << "ok" << std::endl;
+  return 0;
+}
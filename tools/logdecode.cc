@@ -0,0 +1,38 @@
+#include <pedrolib/logger/binary_sink.h>
+#include <unistd.h>
+
+using pedrolib::BinaryLogDecoder;
+using pedrolib::File;
+
+int main(int argc, char* argv[]) {
+  if (argc < 2 || argc > 3) {
+    fmt::print(stderr, "usage: {} <binary-log> [output]\n", argv[0]);
+    return 1;
+  }
+
+  File input = File::Open(argv[1], {.mode = File::OpenMode::kRead});
+  if (!input.Valid()) {
+    fmt::print(stderr, "open {}: {}\n", argv[1], input.GetError());
+    return 1;
+  }
+
+  File output{::dup(STDOUT_FILENO)};
+  if (argc == 3) {
+    output = File::Open(argv[2], {
+                                     .mode = File::OpenMode::kWrite,
+                                     .create = 0644,
+                                 });
+    if (!output.Valid()) {
+      fmt::print(stderr, "open {}: {}\n", argv[2], output.GetError());
+      return 1;
+    }
+  }
+
+  BinaryLogDecoder decoder;
+  auto err = decoder.Decode(&input, &output);
+  if (!err.Empty()) {
+    fmt::print(stderr, "decode {}: {}\n", argv[1], err);
+    return 1;
+  }
+  return 0;
+}